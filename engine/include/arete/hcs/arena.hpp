@@ -2,35 +2,68 @@
 #define ARENA_HPP
 
 #include "arete/core.hpp"
+#include "arete/hcs/paged_array.hpp"
+#include "arete/hcs/snapshot.hpp"
+#include "arete/hcs/sparse_index.hpp"
 
+#include <bit>
 #include <atomic>
+#include <span>
+#include <vector>
 #include <cstdint>
 #include <utility>
 #include <optional>
+#include <concepts>
+#include <stdexcept>
 #include <functional>
-#include <unordered_map>
+#include <memory_resource>
+#include <type_traits>
 
 namespace arete::hcs
 {
 
 //! Arena.
-template<class ObjectHandleType, class ObjectType>
+//! Objects are addressed by generational handles which pack the slot index
+//! together with the slot generation. Destroying an object bumps the slot generation,
+//! so stale handles are detected instead of resolving to an object which re-used the slot.
+//!
+//! Objects are stored as a sparse set. Slots map handles to the dense array of objects
+//! and destroying an object moves the last object into the hole, so the dense array
+//! holds only live objects and can be iterated linearly without liveness checks.
+//!
+//! The dense array is paged, growing it never moves existing objects.
+//! References to objects stay valid across creation of other objects,
+//! only destroying an object relocates the last object in the array.
+//!
+//! Arena optionally tracks changed objects in a bitset co-indexed with the objects.
+//! Creating an object and mutable access through getObject mark the object as changed,
+//! direct writes through objects() must be marked with markChanged.
+//!
+//! Arena of trivially copyable objects can be captured into a snapshot and restored from it.
+//!
+//! All storage of the arena is allocated from its memory resource. Once the storage grew
+//! to the peak count of objects, creating and destroying objects does not allocate.
+template<std::unsigned_integral ObjectHandleType, class ObjectType>
 class Arena
 {
 public:
-  //! Contiguous array of objects.
-  using ObjectArray = std::vector<ObjectType>;
+  //! Sparse index of the object handles.
+  using ObjectHandleIndex = SparseIndex<ObjectHandleType>;
+  //! Layout of the object handles.
+  using Handle = typename ObjectHandleIndex::Handle;
   //! Represents index of an object in the array of objects.
-  using ObjectIndex = int64_t;
-  //! Represents index of all object handles to object indexes.
-  using ObjectIndexMap = std::unordered_map<ObjectHandleType, ObjectIndex>;
-  //! Represents array of freed objects of which space can be re-used.
-  using ObjectIndexFreeList = std::vector<ObjectIndex>;
-  //! Atomic counter of unique objects created in this component arena.
-  using ObjectCounter = std::atomic<ObjectHandleType>;
+  using ObjectIndex = typename ObjectHandleIndex::ObjectIndex;
+  //! Paged array of live objects.
+  using ObjectArray = PagedArray<ObjectType>;
 
-  //! Default constructor.
-  Arena() = default;
+  //! Constructs empty arena.
+  //! @param resource Memory resource of the arena storage, must outlive the arena.
+  explicit Arena(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+    : _objects(resource)
+    , _objectIndex(resource)
+    , _changed(resource)
+    , _pending(resource)
+  {}
 
   //! Deleted copy constructor.
   Arena(const Arena& rhs) = delete;
@@ -41,80 +74,311 @@ public:
   template<typename... _Args>
   //! Creates new object in the arena.
   //! @returns Pair of object handle and object reference.
+  //! @throws std::length_error if the arena ran out of addressable slots.
   [[nodiscard]] std::pair<ObjectHandleType, ObjectType&> createObject(_Args&&... args) {
-    const ObjectHandleType componentHandle = _objectCounter++;
-
-    // Find an empty space for this object.
-    // Try to get last element from the free list if available,
-    // otherwise continue in contiguous allocations.
-    ObjectIndex index = -1;
-    if (!_objectFreelist.empty())
+    // Objects are always appended to the end of the dense array.
+    const ObjectHandleType objectHandle = _objectIndex.insert();
+    try
     {
-      index = _objectFreelist.back();
-      _objectFreelist.pop_back();
-      _objects[index] = std::move(ObjectType{std::forward<_Args>(args)...});
-    } else
+      auto& object = _objects.emplace_back(std::forward<_Args>(args)...);
+      if (_trackChanges)
+      {
+        const size_t index = _objects.size() - 1;
+        if (index / 64 == _changed.size())
+          _changed.emplace_back(0);
+        markChangedAt(index);
+      }
+      return {objectHandle, object};
+    } catch (...)
     {
-      index = _objects.size();
-      _objects.emplace_back(std::forward<_Args>(args)...);
+      [[maybe_unused]] const auto index = _objectIndex.erase(objectHandle);
+      throw;
     }
-
-    auto& object = _objects[index];
-
-
-    // Index the object handle to the index.
-    _objectIndex[componentHandle] = index;
-
-    return {componentHandle, object};
   }
 
   //! Destroys object in the arena.
+  //! Last object in the array of objects is moved to the place of the destroyed object.
   //! @param objectHandle Object handle.
+  //! @returns True if the object was destroyed, false if the handle is stale.
   [[maybe_unused]] bool destroyObject(const ObjectHandleType objectHandle)
   {
-    auto indexIterator = _objectIndex.find(objectHandle);
-    if (indexIterator == _objectIndex.end())
+    const auto index = _objectIndex.erase(objectHandle);
+    if (!index)
       return false;
 
-    // Get the index assigned to the object handle.
-    ObjectIndex index = indexIterator->first;
+    // Fill the hole with the last object.
+    const ObjectIndex lastIndex = static_cast<ObjectIndex>(_objects.size() - 1);
+    if (*index != lastIndex)
+      _objects[*index] = std::move(_objects[lastIndex]);
+    _objects.pop_back();
+
+    // Move the change bit along with the object.
+    if (_trackChanges)
+    {
+      const uint64_t lastBit = uint64_t{1} << (lastIndex % 64);
+      const bool lastChanged = _changed[lastIndex / 64] & lastBit;
+      _changed[lastIndex / 64] &= ~lastBit;
+
+      const uint64_t bit = uint64_t{1} << (*index % 64);
+      if (lastChanged)
+        _changed[*index / 64] |= bit;
+      else
+        _changed[*index / 64] &= ~bit;
+    }
+
+    return true;
+  }
+
+  template<typename InitCallable>
+  //! Creates objects in bulk.
+  //! Storage is reserved once and objects are constructed in a single pass.
+  //! @param count Count of objects.
+  //! @param init Callable accepting index of the object in the batch and returning the object.
+  //! @returns Span of handles of the created objects, valid until the next structural change.
+  //! @throws std::length_error if the arena can not address that many objects.
+  std::span<const ObjectHandleType> createObjects(const size_t count, InitCallable&& init)
+  {
+    _objectIndex.reserve(count);
+    _objects.reserve(_objects.size() + count);
 
-    // Erase the object index to object handle index entry
-    // and mark this component index as free.
-    _objectIndex.erase(indexIterator);
-    _objectFreelist.push_back(index);
+    const size_t first = _objects.size();
+    for (size_t index = 0; index < count; ++index)
+    {
+      [[maybe_unused]] const auto created = createObject(init(index));
+    }
 
-    return _objectIndex.erase(objectHandle);
+    return handles().subspan(first, count);
   }
 
-  //! Gets object by its handle.
-  //! @returns Optional object reference.
+  //! Creates value-initialized objects in bulk.
+  //! @param count Count of objects.
+  //! @returns Span of handles of the created objects, valid until the next structural change.
+  //! @throws std::length_error if the arena can not address that many objects.
+  std::span<const ObjectHandleType> createObjects(const size_t count)
+  {
+    return createObjects(count, [](size_t) { return ObjectType{}; });
+  }
+
+  //! Destroys objects in bulk.
+  //! Objects are destroyed from the back of the array of objects,
+  //! so objects moved into the holes are never ones pending destruction.
+  //! @param objectHandles Handles of objects, stale and duplicate handles are skipped.
+  //! @returns Count of destroyed objects.
+  size_t destroyObjects(const std::span<const ObjectHandleType> objectHandles)
+  {
+    // Mark dense indexes of the objects pending destruction.
+    _pending.assign((_objects.size() + 63) / 64, 0);
+    for (const auto objectHandle: objectHandles)
+    {
+      if (const auto index = _objectIndex.find(objectHandle))
+        _pending[*index / 64] |= uint64_t{1} << (*index % 64);
+    }
+
+    // Walk the marks from the highest index down.
+    size_t destroyed = 0;
+    for (size_t word = _pending.size(); word-- > 0;)
+    {
+      for (uint64_t bits = _pending[word]; bits != 0; ++destroyed)
+      {
+        const int bit = 63 - std::countl_zero(bits);
+        bits &= ~(uint64_t{1} << bit);
+        destroyObject(_objectIndex.handles()[word * 64 + bit]);
+      }
+    }
+
+    _objectIndex.sortFreeList();
+    return destroyed;
+  }
+
+  //! @returns True if the handle refers to a live object.
+  [[nodiscard]] bool contains(const ObjectHandleType objectHandle) const noexcept
+  {
+    return _objectIndex.contains(objectHandle);
+  }
+
+  //! Gets object by its handle and marks it as changed.
+  //! @returns Optional object reference, empty if the handle is stale.
   [[nodiscard]] std::optional<Ref<ObjectType>> getObject(const ObjectHandleType objectHandle)
   {
-    auto indexIterator = _objectIndex.find(objectHandle);
-    if (indexIterator == _objectIndex.end())
+    const auto index = _objectIndex.find(objectHandle);
+    if (!index)
       return std::nullopt;
-    return _objects[indexIterator->second];
+    markChangedAt(*index);
+    return _objects[*index];
   }
 
-  //! @returns Reference to contiguous array of objects.
+  //! Gets immutable object by its handle.
+  //! @returns Optional object reference, empty if the handle is stale.
+  [[nodiscard]] std::optional<Ref<const ObjectType>> getObject(const ObjectHandleType objectHandle) const
+  {
+    const auto index = _objectIndex.find(objectHandle);
+    if (!index)
+      return std::nullopt;
+    return _objects[*index];
+  }
+
+  //! Enables or disables tracking of changed objects.
+  //! Enabling the tracking marks all objects as unchanged.
+  void trackChanges(const bool enabled)
+  {
+    _trackChanges = enabled;
+    _changed.assign(enabled ? (_objects.size() + 63) / 64 : 0, 0);
+  }
+
+  //! @returns True if the arena tracks changed objects.
+  [[nodiscard]] bool tracksChanges() const noexcept
+  {
+    return _trackChanges;
+  }
+
+  //! Marks object as changed.
+  //! @param objectHandle Object handle.
+  void markChanged(const ObjectHandleType objectHandle) noexcept
+  {
+    if (const auto index = _objectIndex.find(objectHandle))
+      markChangedAt(*index);
+  }
+
+  //! Marks object at the index in the array of objects as changed.
+  //! Safe to call concurrently for different objects.
+  //! @param index Index of the object.
+  void markChangedAt(const size_t index) noexcept
+  {
+    if (!_trackChanges)
+      return;
+
+    std::atomic_ref<uint64_t> word(_changed[index / 64]);
+    const uint64_t bit = uint64_t{1} << (index % 64);
+    if (!(word.load(std::memory_order_relaxed) & bit))
+      word.fetch_or(bit, std::memory_order_relaxed);
+  }
+
+  template<typename Callable>
+  //! Invokes the callable for every object changed since the last clearChanges.
+  //! Objects are visited in the order of the array of objects, a word of 64 objects at a time.
+  //! Callable must not create or destroy objects.
+  //! @param callable Callable accepting object handle and object reference.
+  void forEachChanged(Callable&& callable)
+  {
+    const auto objectHandles = handles();
+    for (size_t word = 0; word < _changed.size(); ++word)
+    {
+      for (uint64_t bits = _changed[word]; bits != 0; bits &= bits - 1)
+      {
+        const size_t index = word * 64 + std::countr_zero(bits);
+        callable(objectHandles[index], _objects[index]);
+      }
+    }
+  }
+
+  //! Marks all objects as unchanged.
+  void clearChanges() noexcept
+  {
+    std::fill(_changed.begin(), _changed.end(), 0);
+  }
+
+  //! @returns Count of changed objects.
+  [[nodiscard]] size_t changedCount() const noexcept
+  {
+    size_t count = 0;
+    for (const auto word: _changed)
+      count += std::popcount(word);
+    return count;
+  }
+
+  //! Captures the objects, the handle index and the free list into a single contiguous buffer.
+  //! Objects are copied page by page, so the snapshot scales with the count of live objects.
+  //! @returns Snapshot.
+  [[nodiscard]] Snapshot snapshot() const requires std::is_trivially_copyable_v<ObjectType>
+  {
+    Snapshot snapshot;
+    SnapshotWriter writer(snapshot);
+
+    const uint64_t header[] {sizeof(ObjectType), _objects.size()};
+    writer.write(header, sizeof(header));
+    _objectIndex.snapshot(writer);
+
+    snapshot.data.reserve(snapshot.data.size() + _objects.size() * sizeof(ObjectType));
+    for (size_t pageIndex = 0; pageIndex < _objects.pageCount(); ++pageIndex)
+      writer.write(_objects.page(pageIndex));
+
+    return snapshot;
+  }
+
+  //! Restores the arena to the state captured by the snapshot.
+  //! Handles valid at the time of the snapshot become valid again.
+  //! If the arena tracks changes, all restored objects are marked as changed.
+  //! @param snapshot Snapshot captured by an arena of the same object type.
+  //! @throws std::invalid_argument if the snapshot does not match the object type or its index is corrupt.
+  //! @throws std::out_of_range if the snapshot is truncated.
+  void restore(const Snapshot& snapshot) requires std::is_trivially_copyable_v<ObjectType>
+  {
+    SnapshotReader reader(snapshot);
+
+    uint64_t header[2] {};
+    reader.read(header, sizeof(header));
+
+    // Restore into a separate index, so the arena is left intact if the snapshot is invalid.
+    ObjectHandleIndex objectIndex(resource());
+    objectIndex.restore(reader);
+    if (header[0] != sizeof(ObjectType)
+        || header[1] != objectIndex.size()
+        || reader.remaining() != header[1] * sizeof(ObjectType))
+    {
+      throw std::invalid_argument("Snapshot does not match the arena object type.");
+    }
+
+    _objectIndex = std::move(objectIndex);
+    _objects.resizeForOverwrite(header[1]);
+    for (size_t pageIndex = 0; pageIndex < _objects.pageCount(); ++pageIndex)
+      reader.read(_objects.page(pageIndex));
+
+    if (_trackChanges)
+    {
+      _changed.assign((_objects.size() + 63) / 64, ~uint64_t{0});
+      if (_objects.size() % 64 != 0)
+        _changed.back() = (uint64_t{1} << (_objects.size() % 64)) - 1;
+    }
+  }
+
+  //! @returns Count of live objects.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _objects.size();
+  }
+
+  //! @returns Memory resource of the arena storage.
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept
+  {
+    return _objects.resource();
+  }
+
+  //! @returns Reference to packed array of live objects.
   [[nodiscard]] ObjectArray& objects() noexcept
   {
     return _objects;
   }
 
-  //! @returns Reference to immutable contiguous array of objects.
+  //! @returns Reference to packed array of immutable live objects.
   [[nodiscard]] const ObjectArray& objects() const noexcept
   {
     return _objects;
   }
 
+  //! @returns Packed span of live object handles, co-indexed with objects.
+  [[nodiscard]] std::span<const ObjectHandleType> handles() const noexcept
+  {
+    return _objectIndex.handles();
+  }
+
 private:
   ObjectArray _objects;
-  ObjectIndexMap _objectIndex;
-  ObjectIndexFreeList _objectFreelist;
+  ObjectHandleIndex _objectIndex;
 
-  ObjectCounter _objectCounter{ 0 };
+  bool _trackChanges = false;
+  std::pmr::vector<uint64_t> _changed;
+  //! Scratch bitmap of bulk destruction, kept to avoid allocating per call.
+  std::pmr::vector<uint64_t> _pending;
 };
 
 } // namespace arete::hcs
@@ -0,0 +1,209 @@
+#ifndef ARETE_BOUNDS_HPP
+#define ARETE_BOUNDS_HPP
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace arete::hcs
+{
+
+//! Axis-aligned bounding box.
+struct Aabb
+{
+  glm::vec3 min {0.0f};
+  glm::vec3 max {0.0f};
+
+  //! @returns Box of the center and the half extents.
+  [[nodiscard]] static Aabb fromCenter(const glm::vec3& center, const glm::vec3& extents) noexcept
+  {
+    return {center - extents, center + extents};
+  }
+
+  [[nodiscard]] glm::vec3 center() const noexcept
+  {
+    return (min + max) * 0.5f;
+  }
+
+  //! @returns Half extents.
+  [[nodiscard]] glm::vec3 extents() const noexcept
+  {
+    return (max - min) * 0.5f;
+  }
+
+  //! @returns True if the box overlaps the other box.
+  [[nodiscard]] bool intersects(const Aabb& other) const noexcept
+  {
+    return min.x <= other.max.x && max.x >= other.min.x
+      && min.y <= other.max.y && max.y >= other.min.y
+      && min.z <= other.max.z && max.z >= other.min.z;
+  }
+
+  //! @returns True if the box contains the other box.
+  [[nodiscard]] bool contains(const Aabb& other) const noexcept
+  {
+    return min.x <= other.min.x && max.x >= other.max.x
+      && min.y <= other.min.y && max.y >= other.max.y
+      && min.z <= other.min.z && max.z >= other.max.z;
+  }
+
+  //! @returns Box enclosing the box transformed by the matrix.
+  [[nodiscard]] Aabb transformed(const glm::mat4& matrix) const noexcept
+  {
+    const glm::vec3 boxCenter = center();
+    const glm::vec3 boxExtents = extents();
+    const glm::vec3 transformedCenter = glm::vec3(matrix * glm::vec4(boxCenter, 1.0f));
+    const glm::vec3 transformedExtents =
+      glm::abs(glm::vec3(matrix[0])) * boxExtents.x
+      + glm::abs(glm::vec3(matrix[1])) * boxExtents.y
+      + glm::abs(glm::vec3(matrix[2])) * boxExtents.z;
+    return fromCenter(transformedCenter, transformedExtents);
+  }
+};
+
+//! Bounding sphere.
+struct Sphere
+{
+  glm::vec3 center {0.0f};
+  float radius = 0.0f;
+
+  //! @returns Squared distance of the point of the box closest to the center of the sphere.
+  [[nodiscard]] float distanceSquared(const Aabb& box) const noexcept
+  {
+    const glm::vec3 offset = center - glm::clamp(center, box.min, box.max);
+    return glm::dot(offset, offset);
+  }
+
+  //! @returns True if the sphere overlaps the box.
+  [[nodiscard]] bool intersects(const Aabb& box) const noexcept
+  {
+    return distanceSquared(box) <= radius * radius;
+  }
+
+  //! @returns True if the sphere contains the box.
+  [[nodiscard]] bool contains(const Aabb& box) const noexcept
+  {
+    const glm::vec3 farthest = glm::max(glm::abs(center - box.min), glm::abs(center - box.max));
+    return glm::dot(farthest, farthest) <= radius * radius;
+  }
+};
+
+//! Ray, distances along the ray are in multiples of its direction.
+struct Ray
+{
+  glm::vec3 origin {0.0f};
+  glm::vec3 direction {0.0f, 0.0f, 1.0f};
+
+  //! Intersects the box with the slab test.
+  //! @param inverseDirection Reciprocal of the direction of the ray.
+  //! @param maxDistance Length of the ray.
+  //! @returns Distance at which the ray enters the box, zero if it starts inside,
+  //!          or nothing if the ray misses the box.
+  [[nodiscard]] std::optional<float> intersect(
+    const Aabb& box,
+    const glm::vec3& inverseDirection,
+    const float maxDistance) const noexcept
+  {
+    const glm::vec3 near = (box.min - origin) * inverseDirection;
+    const glm::vec3 far = (box.max - origin) * inverseDirection;
+    const glm::vec3 entry = glm::min(near, far);
+    const glm::vec3 exit = glm::max(near, far);
+
+    const float enter = std::max({entry.x, entry.y, entry.z, 0.0f});
+    const float leave = std::min({exit.x, exit.y, exit.z, maxDistance});
+    if (enter > leave)
+      return std::nullopt;
+    return enter;
+  }
+};
+
+//! Result of testing a volume against a bounding volume.
+enum class Containment : uint8_t
+{
+  //! The volumes do not overlap.
+  Outside,
+  //! The volumes overlap partially.
+  Intersecting,
+  //! The volume is entirely inside the bounding volume.
+  Inside
+};
+
+//! View frustum as six planes whose normals point inside.
+struct Frustum
+{
+  //! Planes in the order left, right, bottom, top, near and far.
+  //! Normal in xyz and distance from the origin in w, normals have unit length.
+  std::array<glm::vec4, 6> planes;
+
+  //! Extracts the planes of the clip volume of the matrix.
+  //! @param clip Matrix transforming to Vulkan clip space, where depth ranges from 0 to 1.
+  //!             World planes are extracted from the projection * view matrix,
+  //!             local planes of a model from the model-view-projection matrix.
+  [[nodiscard]] static Frustum fromMatrix(const glm::mat4& clip) noexcept
+  {
+    const auto row = [&clip](const int index) {
+      return glm::vec4(clip[0][index], clip[1][index], clip[2][index], clip[3][index]);
+    };
+
+    Frustum frustum {};
+    frustum.planes = {
+      row(3) + row(0),
+      row(3) - row(0),
+      row(3) + row(1),
+      row(3) - row(1),
+      row(2),
+      row(3) - row(2)};
+    for (auto& plane: frustum.planes)
+      plane = plane * (1.0f / glm::length(glm::vec3(plane)));
+    return frustum;
+  }
+
+  //! @returns Whether the box is outside, intersecting or inside the frustum.
+  [[nodiscard]] Containment classify(const Aabb& box) const noexcept
+  {
+    const glm::vec3 center = box.center();
+    const glm::vec3 extents = box.extents();
+
+    Containment containment = Containment::Inside;
+    for (const auto& plane: planes)
+    {
+      const glm::vec3 normal(plane);
+      const float distance = glm::dot(normal, center) + plane.w;
+      const float radius = glm::dot(glm::abs(normal), extents);
+      if (distance < -radius)
+        return Containment::Outside;
+      if (distance < radius)
+        containment = Containment::Intersecting;
+    }
+    return containment;
+  }
+
+  //! @returns True if the box overlaps the frustum, or lies near its corner.
+  [[nodiscard]] bool intersects(const Aabb& box) const noexcept
+  {
+    return classify(box) != Containment::Outside;
+  }
+
+  //! @returns True if the sphere overlaps the frustum, or lies near its corner.
+  [[nodiscard]] bool intersects(const Sphere& sphere) const noexcept
+  {
+    for (const auto& plane: planes)
+    {
+      if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+        return false;
+    }
+    return true;
+  }
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_BOUNDS_HPP
@@ -0,0 +1,510 @@
+#ifndef ARETE_COMMAND_BUFFER_HPP
+#define ARETE_COMMAND_BUFFER_HPP
+
+#include "arete/hcs/arena.hpp"
+#include "arete/hcs/world.hpp"
+#include "arete/threading/job_system.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Buffer of deferred structural changes.
+//! Commands are recorded while systems iterate the storage
+//! and applied in the recording order once the buffer is flushed.
+//! Commands are stored in-place in reusable blocks, so recording does not allocate
+//! once the blocks grew to the size of a typical frame.
+//!
+//! Recording a creation returns a pending handle, which later commands use to destroy
+//! or modify the object or actor created in the same phase. The handle is assigned when
+//! the creation is applied, so pending handles resolve only in commands applied after it.
+class CommandBuffer
+{
+public:
+  //! Size of a single block of commands.
+  static constexpr size_t BlockSize = 64 * 1024;
+
+  template<std::unsigned_integral HandleType>
+  //! Handle of an object or actor whose creation is recorded in a command buffer.
+  struct Pending
+  {
+    //! Buffer which recorded the creation.
+    const CommandBuffer* buffer;
+    //! Index of the creation within the buffer.
+    size_t index;
+
+    //! @returns Handle assigned by the creation.
+    //!          Valid once the creation was applied, until the buffer which recorded it is flushed again.
+    [[nodiscard]] HandleType resolve() const noexcept
+    {
+      return static_cast<HandleType>(buffer->_created[index]);
+    }
+  };
+
+  //! Default constructor.
+  CommandBuffer() = default;
+
+  //! Deleted copy constructor.
+  CommandBuffer(const CommandBuffer& rhs) = delete;
+
+  //! Move constructor.
+  CommandBuffer(CommandBuffer&& rhs) noexcept
+    : _blocks(std::move(rhs._blocks))
+    , _currentBlock(std::exchange(rhs._currentBlock, 0))
+    , _commandCount(std::exchange(rhs._commandCount, 0))
+    , _created(std::move(rhs._created))
+    , _pendingCount(std::exchange(rhs._pendingCount, 0))
+    , _sortKey(std::exchange(rhs._sortKey, 0))
+  {}
+
+  //! Destroys pending commands and releases the blocks.
+  ~CommandBuffer()
+  {
+    clear();
+    for (auto& block: _blocks)
+      ::operator delete(block.data, std::align_val_t{CommandAlignment});
+  }
+
+  template<typename Callable>
+  //! Records command.
+  //! @param callable Callable without arguments, invoked when the buffer is flushed.
+  void record(Callable&& callable)
+  {
+    using CommandType = std::decay_t<Callable>;
+    static_assert(alignof(CommandType) <= CommandAlignment, "Command is over-aligned.");
+
+    auto* header = static_cast<CommandHeader*>(allocate(sizeof(CommandHeader) + sizeof(CommandType)));
+    try
+    {
+      std::construct_at(reinterpret_cast<CommandType*>(header + 1), std::forward<Callable>(callable));
+    } catch (...)
+    {
+      _blocks[_currentBlock].used -= header->stride;
+      throw;
+    }
+    header->apply = [](void* command) {
+      auto* typedCommand = static_cast<CommandType*>(command);
+      (*typedCommand)();
+      std::destroy_at(typedCommand);
+    };
+    header->destroy = [](void* command) {
+      std::destroy_at(static_cast<CommandType*>(command));
+    };
+    header->sortKey = _sortKey;
+    ++_commandCount;
+  }
+
+  template<std::unsigned_integral ObjectHandleType, class ObjectType>
+  //! Records creation of object in the arena.
+  //! @returns Pending handle of the object.
+  Pending<ObjectHandleType> createObject(Arena<ObjectHandleType, ObjectType>& arena, ObjectType object)
+  {
+    const Pending<ObjectHandleType> pending {this, _pendingCount};
+    record([this, &arena, index = pending.index, object = std::move(object)]() mutable {
+      _created[index] = arena.createObject(std::move(object)).first;
+    });
+    ++_pendingCount;
+    return pending;
+  }
+
+  template<std::unsigned_integral ObjectHandleType, class ObjectType>
+  //! Records destruction of object in the arena.
+  void destroyObject(Arena<ObjectHandleType, ObjectType>& arena, const ObjectHandleType objectHandle)
+  {
+    record([&arena, objectHandle]() {
+      arena.destroyObject(objectHandle);
+    });
+  }
+
+  template<std::unsigned_integral ObjectHandleType, class ObjectType>
+  //! Records destruction of object whose creation is pending.
+  void destroyObject(Arena<ObjectHandleType, ObjectType>& arena, const Pending<ObjectHandleType> object)
+  {
+    record([&arena, object]() {
+      arena.destroyObject(object.resolve());
+    });
+  }
+
+  template<class... Components>
+  //! Records creation of actor with the components in the world.
+  //! @returns Pending handle of the actor.
+  Pending<ActorHandle> createActor(World& world, Components... components)
+  {
+    const Pending<ActorHandle> pending {this, _pendingCount};
+    record([this, &world, index = pending.index, ... components = std::move(components)]() mutable {
+      _created[index] = world.createActor(std::move(components)...);
+    });
+    ++_pendingCount;
+    return pending;
+  }
+
+  //! Records destruction of actor in the world.
+  void destroyActor(World& world, const ActorHandle actor)
+  {
+    record([&world, actor]() {
+      world.destroyActor(actor);
+    });
+  }
+
+  //! Records destruction of actor whose creation is pending.
+  void destroyActor(World& world, const Pending<ActorHandle> actor)
+  {
+    record([&world, actor]() {
+      world.destroyActor(actor.resolve());
+    });
+  }
+
+  template<class Component>
+  //! Records addition of component to the actor.
+  //! Command is skipped if the actor is destroyed before the buffer is flushed.
+  void addComponent(World& world, const ActorHandle actor, Component component)
+  {
+    record([&world, actor, component = std::move(component)]() mutable {
+      if (world.contains(actor))
+        world.addComponent<Component>(actor, std::move(component));
+    });
+  }
+
+  template<class Component>
+  //! Records addition of component to the actor whose creation is pending.
+  //! Command is skipped if the actor is destroyed before the buffer is flushed.
+  void addComponent(World& world, const Pending<ActorHandle> actor, Component component)
+  {
+    record([&world, actor, component = std::move(component)]() mutable {
+      if (world.contains(actor.resolve()))
+        world.addComponent<Component>(actor.resolve(), std::move(component));
+    });
+  }
+
+  template<class Component>
+  //! Records removal of component from the actor.
+  //! Command is skipped if the actor is destroyed before the buffer is flushed.
+  void removeComponent(World& world, const ActorHandle actor)
+  {
+    record([&world, actor]() {
+      if (world.contains(actor))
+        world.removeComponent<Component>(actor);
+    });
+  }
+
+  template<class Component>
+  //! Records removal of component from the actor whose creation is pending.
+  //! Command is skipped if the actor is destroyed before the buffer is flushed.
+  void removeComponent(World& world, const Pending<ActorHandle> actor)
+  {
+    record([&world, actor]() {
+      if (world.contains(actor.resolve()))
+        world.removeComponent<Component>(actor.resolve());
+    });
+  }
+
+  //! Applies all recorded commands in the recording order.
+  //! Blocks are kept for re-use.
+  //! If a command throws, it and the commands not applied yet are destroyed and the buffer is left empty.
+  void flush()
+  {
+    beginFlush();
+
+    // Blocks may be skipped while recording, but never revisited,
+    // so commands in the block order are in the recording order.
+    size_t blockIndex = 0;
+    size_t offset = 0;
+    try
+    {
+      for (; blockIndex < _blocks.size(); ++blockIndex, offset = 0)
+      {
+        auto& block = _blocks[blockIndex];
+        while (offset < block.used)
+        {
+          auto* header = reinterpret_cast<CommandHeader*>(block.data + offset);
+          header->apply(header + 1);
+          offset += header->stride;
+        }
+      }
+    } catch (...)
+    {
+      destroyFrom(blockIndex, offset);
+      reset();
+      throw;
+    }
+    reset();
+  }
+
+  //! Destroys all recorded commands without applying them.
+  void clear() noexcept
+  {
+    destroyFrom(0, 0);
+    reset();
+  }
+
+  //! @returns Count of recorded commands.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _commandCount;
+  }
+
+private:
+  friend class CommandQueue;
+
+  //! Alignment of every command in the block.
+  static constexpr size_t CommandAlignment = alignof(std::max_align_t);
+
+  //! Header preceding every command.
+  struct alignas(CommandAlignment) CommandHeader
+  {
+    //! Applies and destroys the command.
+    void (*apply)(void* command);
+    //! Destroys the command.
+    void (*destroy)(void* command);
+    //! Size of the header and the command, aligned.
+    size_t stride;
+    //! Key ordering the command across the buffers of a queue.
+    uint64_t sortKey;
+  };
+
+  //! Block of commands.
+  struct Block
+  {
+    std::byte* data;
+    size_t capacity;
+    size_t used;
+  };
+
+  //! Allocates aligned space for command with header.
+  //! @returns Pointer to the header.
+  void* allocate(const size_t size)
+  {
+    const size_t stride = (size + CommandAlignment - 1) / CommandAlignment * CommandAlignment;
+
+    // Advance to the next block with enough space, allocating one if needed.
+    while (_currentBlock < _blocks.size()
+           && _blocks[_currentBlock].capacity - _blocks[_currentBlock].used < stride)
+    {
+      ++_currentBlock;
+    }
+
+    if (_currentBlock == _blocks.size())
+    {
+      const size_t capacity = std::max(BlockSize, stride);
+      _blocks.push_back({
+        static_cast<std::byte*>(::operator new(capacity, std::align_val_t{CommandAlignment})),
+        capacity,
+        0});
+    }
+
+    auto& block = _blocks[_currentBlock];
+    auto* header = reinterpret_cast<CommandHeader*>(block.data + block.used);
+    header->stride = stride;
+    block.used += stride;
+    return header;
+  }
+
+  //! Destroys the recorded commands starting at the offset of the block, without applying them.
+  void destroyFrom(size_t blockIndex, size_t offset) noexcept
+  {
+    for (; blockIndex < _blocks.size(); ++blockIndex, offset = 0)
+    {
+      auto& block = _blocks[blockIndex];
+      while (offset < block.used)
+      {
+        auto* header = reinterpret_cast<CommandHeader*>(block.data + offset);
+        offset += header->stride;
+        header->destroy(header + 1);
+      }
+    }
+  }
+
+  //! Makes room for the handles of the recorded creations.
+  void beginFlush()
+  {
+    _created.resize(_pendingCount);
+  }
+
+  template<typename Callable>
+  //! Invokes the callable with the header of every recorded command, in the recording order.
+  void forEachCommand(Callable&& callable)
+  {
+    for (auto& block: _blocks)
+    {
+      for (size_t offset = 0; offset < block.used;)
+      {
+        auto* header = reinterpret_cast<CommandHeader*>(block.data + offset);
+        offset += header->stride;
+        callable(header);
+      }
+    }
+  }
+
+  //! Marks all blocks as empty.
+  //! Handles of the applied creations stay resolvable until the next flush.
+  void reset() noexcept
+  {
+    for (auto& block: _blocks)
+      block.used = 0;
+    _currentBlock = 0;
+    _commandCount = 0;
+    _pendingCount = 0;
+  }
+
+private:
+  std::vector<Block> _blocks;
+  size_t _currentBlock = 0;
+  size_t _commandCount = 0;
+
+  //! Handles assigned by the applied creations, indexed by the pending handles.
+  std::vector<uint64_t> _created;
+  //! Count of the creations recorded since the last flush.
+  size_t _pendingCount = 0;
+  //! Key of the commands being recorded.
+  uint64_t _sortKey = 0;
+};
+
+//! Set of command buffers, one per thread of a job system.
+//! Threads of the job system record into their own buffer without any locking,
+//! threads outside of the job system share a buffer guarded by a mutex.
+//! Buffers are applied at a single-threaded sync point.
+//!
+//! Work stealing decides which thread runs a task, so the buffer a command lands in varies
+//! from run to run. Commands are therefore applied ordered by the sort key they were recorded with,
+//! typically the index of the recording task, which keeps the order of creations and the assigned handles
+//! reproducible. Commands of the same key keep their recording order within a buffer,
+//! the order of commands of the same key recorded by different threads is unspecified.
+class CommandQueue
+{
+public:
+  //! Command buffer of the current thread.
+  //! Holds the lock of the shared buffer of the threads outside of the job system,
+  //! so it is kept only while recording.
+  class LocalBuffer
+  {
+  public:
+    //! Deleted move constructor.
+    LocalBuffer(LocalBuffer&& rhs) = delete;
+
+    //! Restores the sort key of the buffer, so buffers acquired by nested jobs do not leak their key.
+    ~LocalBuffer()
+    {
+      _buffer->_sortKey = _previousSortKey;
+    }
+
+    CommandBuffer* operator->() const noexcept
+    {
+      return _buffer;
+    }
+
+    CommandBuffer& operator*() const noexcept
+    {
+      return *_buffer;
+    }
+
+  private:
+    friend class CommandQueue;
+
+    LocalBuffer(CommandBuffer& buffer, std::unique_lock<std::mutex> lock, const uint64_t sortKey) noexcept
+      : _buffer(&buffer)
+      , _lock(std::move(lock))
+      , _previousSortKey(std::exchange(buffer._sortKey, sortKey))
+    {}
+
+    CommandBuffer* _buffer;
+    std::unique_lock<std::mutex> _lock;
+    uint64_t _previousSortKey;
+  };
+
+  //! Constructs queue.
+  //! @param jobs Job system whose threads record commands, must outlive the queue.
+  explicit CommandQueue(const threading::JobSystem& jobs = threading::JobSystem::shared())
+    : _jobs(&jobs)
+    , _buffers(jobs.threadCount())
+  {}
+
+  //! Deleted copy constructor.
+  CommandQueue(const CommandQueue& rhs) = delete;
+
+  //! @returns Command buffer of the current thread.
+  //!          Threads outside of the job system get the shared buffer, locked until it is released.
+  //! @param sortKey Key ordering the commands recorded through the buffer across all buffers.
+  [[nodiscard]] LocalBuffer local(const uint64_t sortKey = 0)
+  {
+    const size_t thread = _jobs->localThreadIndex();
+    if (thread == 0)
+      return LocalBuffer(_buffers.front(), std::unique_lock(_externalMutex), sortKey);
+    return LocalBuffer(_buffers[thread], {}, sortKey);
+  }
+
+  //! Applies commands of all buffers, ordered by their sort key.
+  //! Must not be called while any thread records commands.
+  //! If a command throws, it and the commands not applied yet are destroyed and the queue is left empty.
+  void flush()
+  {
+    // Gather the commands of all buffers and order them by the key, the sort is stable,
+    // so commands of the same key keep the recording order of their buffer.
+    _order.clear();
+    for (auto& buffer: _buffers)
+    {
+      buffer.beginFlush();
+      buffer.forEachCommand([this](CommandBuffer::CommandHeader* header) {
+        _order.push_back(header);
+      });
+    }
+    std::stable_sort(_order.begin(), _order.end(), [](const auto* lhs, const auto* rhs) {
+      return lhs->sortKey < rhs->sortKey;
+    });
+
+    size_t applied = 0;
+    try
+    {
+      for (; applied < _order.size(); ++applied)
+        _order[applied]->apply(_order[applied] + 1);
+    } catch (...)
+    {
+      for (; applied < _order.size(); ++applied)
+        _order[applied]->destroy(_order[applied] + 1);
+      reset();
+      throw;
+    }
+    reset();
+  }
+
+  //! @returns Count of recorded commands across all buffers.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    size_t count = 0;
+    for (const auto& buffer: _buffers)
+      count += buffer.size();
+    return count;
+  }
+
+private:
+  //! Marks all buffers as empty.
+  void reset() noexcept
+  {
+    for (auto& buffer: _buffers)
+      buffer.reset();
+    _order.clear();
+  }
+
+private:
+  const threading::JobSystem* _jobs;
+  std::vector<CommandBuffer> _buffers;
+  //! Commands of all buffers in the order of application, kept to reuse its capacity.
+  std::vector<CommandBuffer::CommandHeader*> _order;
+
+  //! Guards the buffer shared by the threads outside of the job system.
+  std::mutex _externalMutex;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_COMMAND_BUFFER_HPP
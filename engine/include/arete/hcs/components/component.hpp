@@ -7,8 +7,11 @@ namespace arete {
 class Component
 {
 public:
-  virtual void onCreate();
-  virtual void onDelete();
+  virtual ~Component() = default;
+
+public:
+  virtual void onCreate() {}
+  virtual void onDelete() {}
 };
 
 } // arete
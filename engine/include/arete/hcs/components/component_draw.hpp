@@ -12,7 +12,9 @@ public:
   virtual ~ComponentDraw() = default;
   
 public:
-  virtual void onDraw();
+  //! Draws the component.
+  //! Prefer a static batched draw, see arete/hcs/update.hpp.
+  virtual void onDraw() {}
 };
 
 }
@@ -12,7 +12,10 @@ public:
   virtual ~ComponentPhysTick() = default;
   
 public:
-  virtual void onPhysTick();
+  //! Ticks the component physics.
+  //! Prefer a static batched update, see arete/hcs/update.hpp.
+  //! @param deltaTime Time delta in seconds.
+  virtual void onPhysTick([[maybe_unused]] float deltaTime) {}
 };
 
 } // arete
@@ -12,7 +12,10 @@ public:
   virtual ~ComponentTick() = default;
   
 public:
-  virtual void onTick();
+  //! Ticks the component.
+  //! Prefer a static batched update, see arete/hcs/update.hpp.
+  //! @param deltaTime Time delta in seconds.
+  virtual void onTick([[maybe_unused]] float deltaTime) {}
 };
 
 } // arete
@@ -1,30 +1,85 @@
-#ifndef SPATIAL_HPP
-#define SPATIAL_HPP
-
-#include "component_data.hpp"
+#ifndef ARETE_SPATIAL_HPP
+#define ARETE_SPATIAL_HPP
 
 #include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
 #include <glm/gtx/quaternion.hpp>
 
 namespace arete::hcs
 {
 
 //! Spatial component.
+//! Position, rotation and scale relative to the parent transform.
 class SpatialComponent
-  : public ComponentDataBase {
-
+{
 public:
-  SpatialComponent& translate();
-  SpatialComponent& rotate();
+  //! Translates by the offset.
+  SpatialComponent& translate(const glm::vec3& offset) noexcept
+  {
+    _position += offset;
+    return *this;
+  }
+
+  //! Rotates by the rotation, applied after the current rotation.
+  SpatialComponent& rotate(const glm::quat& rotation) noexcept
+  {
+    _rotation = glm::normalize(rotation * _rotation);
+    return *this;
+  }
+
+  //! Sets the position.
+  SpatialComponent& position(const glm::vec3& position) noexcept
+  {
+    _position = position;
+    return *this;
+  }
+
+  //! Sets the rotation.
+  SpatialComponent& rotation(const glm::quat& rotation) noexcept
+  {
+    _rotation = rotation;
+    return *this;
+  }
+
+  //! Sets the scale.
+  SpatialComponent& scale(const glm::vec3& scale) noexcept
+  {
+    _scale = scale;
+    return *this;
+  }
+
+  [[nodiscard]] const glm::vec3& position() const noexcept
+  {
+    return _position;
+  }
+
+  [[nodiscard]] const glm::quat& rotation() const noexcept
+  {
+    return _rotation;
+  }
+
+  [[nodiscard]] const glm::vec3& scale() const noexcept
+  {
+    return _scale;
+  }
+
+  //! @returns Matrix transforming from the local space to the parent space.
+  [[nodiscard]] glm::mat4 localMatrix() const noexcept
+  {
+    glm::mat4 matrix = glm::mat4_cast(_rotation);
+    matrix[0] *= _scale.x;
+    matrix[1] *= _scale.y;
+    matrix[2] *= _scale.z;
+    matrix[3] = glm::vec4(_position, 1.0f);
+    return matrix;
+  }
 
 private:
-  glm::vec3 _position;
-  glm::quat _rotation;
-  glm::vec3 _scale;
+  glm::vec3 _position {0.0f};
+  glm::quat _rotation {1.0f, 0.0f, 0.0f, 0.0f};
+  glm::vec3 _scale {1.0f};
 };
 
 } // namespace arete::hcs
 
-
-
-#endif //SPATIAL_HPP
+#endif // ARETE_SPATIAL_HPP
@@ -0,0 +1,112 @@
+#ifndef ARETE_CULLING_HPP
+#define ARETE_CULLING_HPP
+
+#include "arete/hcs/bounds.hpp"
+#include "arete/hcs/simd.hpp"
+#include "arete/threading/job_system.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Bounding spheres as structure of arrays.
+//! All arrays hold a value per sphere.
+struct BoundingSpheres
+{
+  std::span<const float> centerX;
+  std::span<const float> centerY;
+  std::span<const float> centerZ;
+  std::span<const float> radius;
+
+  //! @returns Count of spheres.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return centerX.size();
+  }
+};
+
+//! Statistics of a culling pass.
+struct CullingStats
+{
+  size_t visibleCount = 0;
+  size_t culledCount = 0;
+  //! Duration of the pass.
+  std::chrono::nanoseconds duration {0};
+};
+
+//! Culls bounding spheres against a view frustum.
+//! Spheres are tested in batches of 8 with AVX2, or 4 with SSE4.1, against all six planes at once.
+//! Large sets are split into chunks culled in parallel, every chunk writes the visible spheres
+//! into its own range of the visible list, which is compacted afterwards.
+//! The visible list keeps its capacity, culling does not allocate once it grew to the peak count.
+class FrustumCuller
+{
+public:
+  //! Count of spheres culled by a single job.
+  static constexpr size_t ChunkSize = 8192;
+
+  //! Constructs culler.
+  //! @param resource Memory resource of the visible list, must outlive the culler.
+  explicit FrustumCuller(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  //! Culls the spheres.
+  //! @param frustum View frustum.
+  //! @param spheres Bounding spheres.
+  //! @param level Instruction set, clamped to the one supported by the processor.
+  //! @returns Indices of the visible spheres in ascending order, valid until the next cull.
+  //! @throws std::invalid_argument if the sizes of the arrays differ.
+  std::span<const uint32_t> cull(
+    const Frustum& frustum,
+    const BoundingSpheres& spheres,
+    SimdLevel level = detectSimdLevel());
+
+  //! Culls the spheres, splitting them into chunks across the job system.
+  //! @param frustum View frustum.
+  //! @param spheres Bounding spheres.
+  //! @param jobs Job system.
+  //! @param level Instruction set, clamped to the one supported by the processor.
+  //! @returns Indices of the visible spheres in ascending order, valid until the next cull.
+  //! @throws std::invalid_argument if the sizes of the arrays differ.
+  std::span<const uint32_t> cull(
+    const Frustum& frustum,
+    const BoundingSpheres& spheres,
+    threading::JobSystem& jobs,
+    SimdLevel level = detectSimdLevel());
+
+  //! @returns Indices of the spheres visible in the last cull.
+  [[nodiscard]] std::span<const uint32_t> visible() const noexcept
+  {
+    return std::span<const uint32_t>(_visible).first(_stats.visibleCount);
+  }
+
+  //! @returns Statistics of the last cull.
+  [[nodiscard]] const CullingStats& stats() const noexcept
+  {
+    return _stats;
+  }
+
+private:
+  //! Culls the spheres chunk by chunk.
+  std::span<const uint32_t> cull(
+    const Frustum& frustum,
+    const BoundingSpheres& spheres,
+    threading::JobSystem* jobs,
+    SimdLevel level);
+
+private:
+  //! Visible spheres followed by unused space, sized to the largest count of culled spheres.
+  std::pmr::vector<uint32_t> _visible;
+  //! Count of visible spheres of every chunk.
+  std::pmr::vector<uint32_t> _chunkCounts;
+  CullingStats _stats;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_CULLING_HPP
@@ -0,0 +1,155 @@
+#ifndef ARETE_EVENT_QUEUE_HPP
+#define ARETE_EVENT_QUEUE_HPP
+
+#include "arete/threading/job_system.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace arete::hcs
+{
+
+template<class Event>
+  requires std::is_trivially_copyable_v<Event>
+//! Queue of events of a single type.
+//! Every thread of the job system posts to its own buffer, so posting does not synchronize.
+//! Events posted during a frame are read after the queue is flipped at a phase boundary,
+//! while the events of the next frame are posted to the other buffers.
+//!
+//! Buffers keep their capacity, once they grew to the peak event count posting does not allocate.
+//! Threads outside of the job system, including the threads of other job systems,
+//! share a buffer guarded by a mutex.
+class EventQueue
+{
+public:
+  //! Constructs event queue.
+  //! @param jobs Job system whose threads post events, must outlive the queue.
+  //! @param capacity Initial capacity of every thread buffer in events.
+  //! @param resource Memory resource of the buffers.
+  explicit EventQueue(
+    const threading::JobSystem& jobs = threading::JobSystem::shared(),
+    const size_t capacity = 1024,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : _jobs(&jobs)
+  {
+    _producers.reserve(jobs.threadCount());
+    for (size_t thread = 0; thread < jobs.threadCount(); ++thread)
+    {
+      auto& producer = _producers.emplace_back(std::make_unique<Producer>(resource));
+      producer->posted.reserve(capacity);
+      producer->readable.reserve(capacity);
+    }
+  }
+
+  //! Deleted copy constructor.
+  EventQueue(const EventQueue& rhs) = delete;
+
+  //! Posts event.
+  //! May be called from any thread.
+  //! @param event Event, readable after the next flip.
+  void post(const Event& event)
+  {
+    const size_t thread = _jobs->localThreadIndex();
+    if (thread == 0)
+    {
+      std::scoped_lock lock(_externalMutex);
+      _producers.front()->posted.push_back(event);
+      return;
+    }
+    _producers[thread]->posted.push_back(event);
+  }
+
+  //! Posts events at once, locking at most once for threads outside of the job system.
+  //! @param events Events, readable after the next flip.
+  void post(const std::span<const Event> events)
+  {
+    const size_t thread = _jobs->localThreadIndex();
+    if (thread == 0)
+    {
+      std::scoped_lock lock(_externalMutex);
+      auto& posted = _producers.front()->posted;
+      posted.insert(posted.end(), events.begin(), events.end());
+      return;
+    }
+    auto& posted = _producers[thread]->posted;
+    posted.insert(posted.end(), events.begin(), events.end());
+  }
+
+  template<class... Args>
+  //! Constructs and posts event.
+  //! @param args Arguments of the event constructor.
+  void emplace(Args&&... args)
+  {
+    post(Event{std::forward<Args>(args)...});
+  }
+
+  //! Makes the events posted since the last flip readable and drops the events read so far.
+  //! Must be called at a phase boundary, while no thread posts or reads.
+  void flip() noexcept
+  {
+    for (auto& producer: _producers)
+    {
+      producer->readable.clear();
+      std::swap(producer->posted, producer->readable);
+    }
+  }
+
+  template<typename Callable>
+  //! Invokes the callable for every non-empty batch of readable events.
+  //! Events of a thread are in the order they were posted, the order between threads is unspecified.
+  //! @param callable Callable accepting `std::span<const Event>`.
+  void forEachBatch(Callable&& callable) const
+  {
+    for (const auto& producer: _producers)
+    {
+      if (!producer->readable.empty())
+        callable(std::span<const Event>(producer->readable));
+    }
+  }
+
+  //! @returns Count of readable events.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    size_t size = 0;
+    for (const auto& producer: _producers)
+      size += producer->readable.size();
+    return size;
+  }
+
+  //! @returns True if there are no readable events.
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+private:
+  //! Buffers of a thread on their own cache lines, so posting threads do not share one.
+  struct alignas(64) Producer
+  {
+    explicit Producer(std::pmr::memory_resource* resource)
+      : posted(resource)
+      , readable(resource)
+    {}
+
+    //! Events posted since the last flip.
+    std::pmr::vector<Event> posted;
+    //! Events readable until the next flip.
+    std::pmr::vector<Event> readable;
+  };
+
+  const threading::JobSystem* _jobs;
+  std::vector<std::unique_ptr<Producer>> _producers;
+
+  //! Guards the buffer shared by the threads outside of the job system.
+  std::mutex _externalMutex;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_EVENT_QUEUE_HPP
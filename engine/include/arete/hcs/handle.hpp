@@ -0,0 +1,67 @@
+#ifndef ARETE_HANDLE_HPP
+#define ARETE_HANDLE_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+namespace arete::hcs
+{
+
+//! Generational handle layout.
+//! Packs slot index into the low bits and generation counter into the high bits of the handle.
+//! Quarter of the handle bits is reserved for the generation,
+//! so 32-bit handles address 16M slots with 256 generations per slot.
+//! Generations wrap around, SparseIndex delays reuse of freed slots
+//! so a slot cycles through its generations only after many other handles were erased.
+template<std::unsigned_integral HandleType>
+struct HandleTraits
+{
+  //! Total amount of bits in the handle.
+  static constexpr int Bits = std::numeric_limits<HandleType>::digits;
+  //! Amount of bits reserved for the generation counter.
+  static constexpr int GenerationBits = Bits / 4;
+  //! Amount of bits reserved for the slot index.
+  static constexpr int IndexBits = Bits - GenerationBits;
+
+  //! Mask of the slot index bits.
+  static constexpr HandleType IndexMask = (HandleType{1} << IndexBits) - 1;
+  //! Mask of the generation bits (after shifting).
+  static constexpr HandleType GenerationMask = (HandleType{1} << GenerationBits) - 1;
+
+  //! Maximum amount of addressable slots.
+  static constexpr HandleType MaxSlots = IndexMask + 1;
+
+  //! Packs slot index and generation into a handle.
+  //! @param index Slot index.
+  //! @param generation Slot generation.
+  //! @returns Handle.
+  [[nodiscard]] static constexpr HandleType make(
+    const HandleType index,
+    const HandleType generation) noexcept
+  {
+    return (index & IndexMask) | ((generation & GenerationMask) << IndexBits);
+  }
+
+  //! @returns Slot index of the handle.
+  [[nodiscard]] static constexpr HandleType index(const HandleType handle) noexcept
+  {
+    return handle & IndexMask;
+  }
+
+  //! @returns Generation of the handle.
+  [[nodiscard]] static constexpr HandleType generation(const HandleType handle) noexcept
+  {
+    return (handle >> IndexBits) & GenerationMask;
+  }
+
+  //! @returns Generation following the specified one, wraps around.
+  [[nodiscard]] static constexpr HandleType nextGeneration(const HandleType generation) noexcept
+  {
+    return (generation + 1) & GenerationMask;
+  }
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_HANDLE_HPP
@@ -10,6 +10,7 @@
 
 #include <cstdint>
 #include <atomic>
+#include <memory_resource>
 #include <vector>
 #include <unordered_map>
 
@@ -33,18 +34,28 @@ concept Componentable = requires(T a)
 };
 
 //! System base.
+//! Components are stored in an arena allocated from the memory resource of the system,
+//! so components of a level can be backed by a resource released with the level.
 template<Componentable Component>
 class SystemBase
 {
 protected:
-  ComponentArena<ComponentHandle, Component> _arena;
+  Arena<ComponentHandle, Component> _arena;
 
 public:
+  //! Constructs system.
+  //! @param resource Memory resource of the component storage, must outlive the system.
+  explicit SystemBase(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+    : _arena(resource)
+  {}
+
+  virtual ~SystemBase() = default;
+
   //! Creates a component.
   //! @returns Handle of that component.
-  [[nodsicard]] ComponentHandle createComponent()
+  [[nodiscard]] ComponentHandle createComponent()
   {
-    const auto& [handle, ref] = _arena.createComponent();
+    const auto& [handle, ref] = _arena.createObject();
     return handle;
   }
 
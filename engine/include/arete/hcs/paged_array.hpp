@@ -0,0 +1,260 @@
+#ifndef ARETE_PAGED_ARRAY_HPP
+#define ARETE_PAGED_ARRAY_HPP
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Array of objects stored in fixed-size pages.
+//! Growing the array allocates a new page instead of moving existing objects,
+//! so addresses of objects stay stable until the object is removed.
+//! Pages are filled front to back, so all pages except the last one are full.
+//! Pages and the page table are allocated from the memory resource of the array.
+template<class ObjectType, size_t PageBytes = 16 * 1024>
+class PagedArray
+{
+public:
+  //! Count of objects in a single page, rounded down to power of two.
+  static constexpr size_t ObjectsPerPage = std::bit_floor(
+    std::max<size_t>(1, PageBytes / sizeof(ObjectType)));
+  //! Shift converting object index to page index.
+  static constexpr size_t PageShift = std::countr_zero(ObjectsPerPage);
+  //! Mask converting object index to index within the page.
+  static constexpr size_t PageMask = ObjectsPerPage - 1;
+  //! Alignment of the page storage, at least a cache line.
+  static constexpr size_t PageAlignment = std::max<size_t>(alignof(ObjectType), 64);
+
+  template<bool Const>
+  class Iterator;
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  //! Constructs empty array.
+  //! @param resource Memory resource of the pages, must outlive the array.
+  explicit PagedArray(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+    : _pages(resource)
+  {}
+
+  //! Deleted copy constructor.
+  PagedArray(const PagedArray& rhs) = delete;
+
+  //! Deleted move constructor.
+  PagedArray(PagedArray&& rhs) = delete;
+
+  //! Destroys all objects and releases all pages.
+  ~PagedArray()
+  {
+    clear();
+    for (auto* page: _pages)
+      deallocatePage(page);
+  }
+
+  template<typename... _Args>
+  //! Constructs object at the end of the array.
+  //! @returns Reference to the constructed object.
+  ObjectType& emplace_back(_Args&&... args)
+  {
+    const size_t pageIndex = _size >> PageShift;
+    if (pageIndex == _pages.size())
+      _pages.emplace_back(allocatePage());
+
+    auto* object = std::construct_at(
+      _pages[pageIndex] + (_size & PageMask),
+      std::forward<_Args>(args)...);
+    ++_size;
+    return *object;
+  }
+
+  //! Destroys the last object in the array.
+  //! Pages are kept for re-use.
+  void pop_back() noexcept
+  {
+    --_size;
+    std::destroy_at(&(*this)[_size]);
+  }
+
+  //! Destroys all objects in the array.
+  //! Pages are kept for re-use.
+  void clear() noexcept
+  {
+    while (_size > 0)
+      pop_back();
+  }
+
+  //! Allocates pages for at least the specified count of objects.
+  //! @param capacity Count of objects.
+  void reserve(const size_t capacity)
+  {
+    const size_t pageCount = (capacity + PageMask) >> PageShift;
+    _pages.reserve(pageCount);
+    while (_pages.size() < pageCount)
+      _pages.emplace_back(allocatePage());
+  }
+
+  //! Resizes the array without initializing the objects.
+  //! Objects are expected to be overwritten in place, for example page by page with memcpy.
+  //! @param size Count of objects.
+  void resizeForOverwrite(const size_t size) requires std::is_trivially_copyable_v<ObjectType>
+  {
+    reserve(size);
+    _size = size;
+  }
+
+  //! @returns Reference to the object at the index.
+  [[nodiscard]] ObjectType& operator[](const size_t index) noexcept
+  {
+    return _pages[index >> PageShift][index & PageMask];
+  }
+
+  //! @returns Reference to the immutable object at the index.
+  [[nodiscard]] const ObjectType& operator[](const size_t index) const noexcept
+  {
+    return _pages[index >> PageShift][index & PageMask];
+  }
+
+  //! @returns Reference to the last object.
+  [[nodiscard]] ObjectType& back() noexcept
+  {
+    return (*this)[_size - 1];
+  }
+
+  //! @returns Count of objects.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _size;
+  }
+
+  //! @returns Memory resource of the pages.
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept
+  {
+    return _pages.get_allocator().resource();
+  }
+
+  //! @returns True if the array holds no objects.
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return _size == 0;
+  }
+
+  //! @returns Count of pages holding at least one object.
+  [[nodiscard]] size_t pageCount() const noexcept
+  {
+    return (_size + PageMask) >> PageShift;
+  }
+
+  //! @returns Contiguous span of objects in the page.
+  [[nodiscard]] std::span<ObjectType> page(const size_t pageIndex) noexcept
+  {
+    return {_pages[pageIndex], pageSize(pageIndex)};
+  }
+
+  //! @returns Contiguous span of immutable objects in the page.
+  [[nodiscard]] std::span<const ObjectType> page(const size_t pageIndex) const noexcept
+  {
+    return {_pages[pageIndex], pageSize(pageIndex)};
+  }
+
+  //! Invokes the callable with contiguous span of each page.
+  //! Preferred over element iteration in hot loops, as it avoids the page lookup per object.
+  template<typename Callable>
+  void forEachPage(Callable&& callable)
+  {
+    for (size_t pageIndex = 0; pageIndex < pageCount(); ++pageIndex)
+      callable(page(pageIndex));
+  }
+
+  [[nodiscard]] iterator begin() noexcept { return {this, 0}; }
+  [[nodiscard]] iterator end() noexcept { return {this, _size}; }
+  [[nodiscard]] const_iterator begin() const noexcept { return {this, 0}; }
+  [[nodiscard]] const_iterator end() const noexcept { return {this, _size}; }
+
+  //! Random access iterator over the paged array.
+  template<bool Const>
+  class Iterator
+  {
+  public:
+    using Array = std::conditional_t<Const, const PagedArray, PagedArray>;
+
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = ObjectType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const ObjectType*, ObjectType*>;
+    using reference = std::conditional_t<Const, const ObjectType&, ObjectType&>;
+
+    Iterator() = default;
+    Iterator(Array* array, const size_t index) noexcept
+      : _array(array), _index(index)
+    {}
+
+    reference operator*() const noexcept { return (*_array)[_index]; }
+    pointer operator->() const noexcept { return &(*_array)[_index]; }
+    reference operator[](const difference_type offset) const noexcept { return (*_array)[_index + offset]; }
+
+    Iterator& operator++() noexcept { ++_index; return *this; }
+    Iterator operator++(int) noexcept { auto copy = *this; ++_index; return copy; }
+    Iterator& operator--() noexcept { --_index; return *this; }
+    Iterator operator--(int) noexcept { auto copy = *this; --_index; return copy; }
+
+    Iterator& operator+=(const difference_type offset) noexcept { _index += offset; return *this; }
+    Iterator& operator-=(const difference_type offset) noexcept { _index -= offset; return *this; }
+    Iterator operator+(const difference_type offset) const noexcept { return {_array, _index + offset}; }
+    Iterator operator-(const difference_type offset) const noexcept { return {_array, _index - offset}; }
+    friend Iterator operator+(const difference_type offset, const Iterator& it) noexcept { return it + offset; }
+
+    difference_type operator-(const Iterator& rhs) const noexcept
+    {
+      return static_cast<difference_type>(_index) - static_cast<difference_type>(rhs._index);
+    }
+
+    bool operator==(const Iterator& rhs) const noexcept { return _index == rhs._index; }
+    auto operator<=>(const Iterator& rhs) const noexcept { return _index <=> rhs._index; }
+
+  private:
+    Array* _array = nullptr;
+    size_t _index = 0;
+  };
+
+private:
+  //! @returns Count of objects in the page.
+  [[nodiscard]] size_t pageSize(const size_t pageIndex) const noexcept
+  {
+    return std::min(ObjectsPerPage, _size - (pageIndex << PageShift));
+  }
+
+  //! @returns Uninitialized storage for a page.
+  ObjectType* allocatePage()
+  {
+    return static_cast<ObjectType*>(resource()->allocate(
+      ObjectsPerPage * sizeof(ObjectType),
+      PageAlignment));
+  }
+
+  //! Releases storage of a page.
+  void deallocatePage(ObjectType* page) noexcept
+  {
+    resource()->deallocate(
+      page,
+      ObjectsPerPage * sizeof(ObjectType),
+      PageAlignment);
+  }
+
+private:
+  std::pmr::vector<ObjectType*> _pages;
+  size_t _size = 0;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_PAGED_ARRAY_HPP
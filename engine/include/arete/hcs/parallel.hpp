@@ -0,0 +1,84 @@
+#ifndef ARETE_PARALLEL_HPP
+#define ARETE_PARALLEL_HPP
+
+#include "arete/hcs/arena.hpp"
+#include "arete/threading/job_system.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <span>
+
+namespace arete::hcs
+{
+
+//! Default count of objects processed by a single task.
+static constexpr size_t DefaultGrainSize = 1024;
+
+//! Size of a cache line.
+static constexpr size_t CacheLineSize = 64;
+
+template<std::unsigned_integral ObjectHandleType, class ObjectType, typename Callable>
+//! Executes callable over chunks of the arena objects on the job system.
+//! Chunks never straddle arena pages and start on a cache line boundary.
+//! Chunking depends only on the object count and the grain size,
+//! so the chunk indexes and ranges are the same regardless of the thread count.
+//! @param arena Arena.
+//! @param callable Callable accepting index of the chunk and span of objects in the chunk.
+//! @param grainSize Count of objects in a chunk, rounded up to a cache line and clamped to a page.
+//!                  The last chunk of a page holds the remaining objects of the page, so it may be smaller.
+//! @param jobs Job system.
+void parallelForEachChunk(
+  Arena<ObjectHandleType, ObjectType>& arena,
+  Callable&& callable,
+  const size_t grainSize = DefaultGrainSize,
+  threading::JobSystem& jobs = threading::JobSystem::shared())
+{
+  using ObjectArray = typename Arena<ObjectHandleType, ObjectType>::ObjectArray;
+
+  // Smallest count of objects spanning whole cache lines.
+  constexpr size_t ObjectsPerLine = CacheLineSize / std::gcd(sizeof(ObjectType), CacheLineSize);
+  const size_t chunkSize = std::min(
+    ObjectArray::ObjectsPerPage,
+    std::max(ObjectsPerLine, (grainSize + ObjectsPerLine - 1) / ObjectsPerLine * ObjectsPerLine));
+  const size_t chunksPerPage = (ObjectArray::ObjectsPerPage + chunkSize - 1) / chunkSize;
+
+  auto& objects = arena.objects();
+  const size_t pageCount = objects.pageCount();
+
+  jobs.parallelFor(pageCount * chunksPerPage, [&](const size_t chunkIndex) {
+    const size_t pageIndex = chunkIndex / chunksPerPage;
+    const auto page = objects.page(pageIndex);
+    const size_t begin = (chunkIndex % chunksPerPage) * chunkSize;
+    if (begin >= page.size())
+      return;
+
+    callable(chunkIndex, page.subspan(begin, std::min(chunkSize, page.size() - begin)));
+  });
+}
+
+template<std::unsigned_integral ObjectHandleType, class ObjectType, typename Callable>
+//! Executes callable for every object in the arena on the job system.
+//! @param arena Arena.
+//! @param callable Callable accepting reference to object.
+//! @param grainSize Count of objects in a chunk, rounded and clamped to a page as in parallelForEachChunk.
+//! @param jobs Job system.
+void parallelForEach(
+  Arena<ObjectHandleType, ObjectType>& arena,
+  Callable&& callable,
+  const size_t grainSize = DefaultGrainSize,
+  threading::JobSystem& jobs = threading::JobSystem::shared())
+{
+  parallelForEachChunk(
+    arena,
+    [&](size_t, std::span<ObjectType> chunk) {
+      for (auto& object: chunk)
+        callable(object);
+    },
+    grainSize,
+    jobs);
+}
+
+} // namespace arete::hcs
+
+#endif // ARETE_PARALLEL_HPP
@@ -0,0 +1,162 @@
+#ifndef ARETE_SCHEDULER_HPP
+#define ARETE_SCHEDULER_HPP
+
+#include "arete/hcs/world.hpp"
+#include "arete/threading/job_system.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Phase of a frame. Phases run in order, each phase finishes before the next one starts.
+enum class FramePhase : uint8_t
+{
+  Input,
+  Simulation,
+  Physics,
+  DrawExtraction,
+  Count
+};
+
+//! Count of frame phases.
+static constexpr size_t FramePhaseCount = static_cast<size_t>(FramePhase::Count);
+
+//! Component types read and written by a system.
+struct SystemAccess
+{
+  //! Component types read by the system.
+  ComponentMask reads = 0;
+  //! Component types written by the system.
+  ComponentMask writes = 0;
+
+  template<class... Components>
+  //! Declares the component types as read.
+  SystemAccess& read()
+  {
+    reads |= componentMask<Components...>();
+    return *this;
+  }
+
+  template<class... Components>
+  //! Declares the component types as written.
+  SystemAccess& write()
+  {
+    writes |= componentMask<Components...>();
+    return *this;
+  }
+
+  //! @returns True if the systems may not run concurrently.
+  [[nodiscard]] bool conflicts(const SystemAccess& other) const noexcept
+  {
+    return (writes & (other.reads | other.writes)) != 0
+      || (other.writes & reads) != 0;
+  }
+};
+
+//! Identifier of a system within its scheduler.
+using SystemId = size_t;
+
+//! Execution of a system within a frame.
+struct SystemTiming
+{
+  //! System.
+  SystemId system;
+  //! Index of the thread of the frame job system which executed the system.
+  size_t threadIndex;
+  //! Start of the execution, relative to the start of the frame.
+  std::chrono::nanoseconds start;
+  //! Duration of the execution.
+  std::chrono::nanoseconds duration;
+};
+
+//! Scheduler of systems.
+//! Systems declare the component types they read and write and are assigned to a frame phase.
+//! Within a phase, systems which conflict run in the order of their registration,
+//! systems which do not conflict run concurrently on the job system.
+class Scheduler
+{
+public:
+  //! Callable of a system accepting the time delta of the frame in seconds.
+  using SystemCallable = std::function<void(float deltaTime)>;
+
+  //! Registers system.
+  //! @param name Name of the system, used in the timeline.
+  //! @param phase Phase of the frame in which the system runs.
+  //! @param access Component types read and written by the system.
+  //! @param callable Callable of the system, must not throw.
+  //! @returns Identifier of the system.
+  SystemId addSystem(std::string name, FramePhase phase, SystemAccess access, SystemCallable callable);
+
+  //! Runs all systems for a single frame and records the timeline.
+  //! @param deltaTime Time delta of the frame in seconds.
+  //! @param jobs Job system.
+  void run(float deltaTime, threading::JobSystem& jobs = threading::JobSystem::shared());
+
+  //! @returns Executions of all systems in the last frame, indexed by the system identifier.
+  [[nodiscard]] const std::vector<SystemTiming>& timeline() const noexcept
+  {
+    return _timeline;
+  }
+
+  //! @returns Systems on the longest chain of dependent systems of the last frame, in execution order.
+  [[nodiscard]] std::vector<SystemId> criticalPath() const;
+
+  //! @returns Name of the system.
+  [[nodiscard]] const std::string& systemName(SystemId system) const
+  {
+    return _systems.at(system).name;
+  }
+
+  //! @returns Systems which must finish before the system starts, all of the same phase.
+  [[nodiscard]] const std::vector<SystemId>& systemDependencies(SystemId system) const
+  {
+    return _systems.at(system).dependencies;
+  }
+
+  //! @returns Count of registered systems.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _systems.size();
+  }
+
+private:
+  //! Registered system with its place in the graph of its phase.
+  struct System
+  {
+    std::string name;
+    FramePhase phase;
+    SystemAccess access;
+    SystemCallable callable;
+
+    //! Conflicting systems of the phase registered earlier.
+    std::vector<SystemId> dependencies;
+    //! Conflicting systems of the phase registered later.
+    std::vector<SystemId> dependents;
+  };
+
+  //! State of a running frame shared by the jobs.
+  struct Frame;
+
+  //! Starts the system as a job.
+  static void start(Frame& frame, SystemId system);
+
+private:
+  std::vector<System> _systems;
+  std::array<std::vector<SystemId>, FramePhaseCount> _phases;
+
+  std::unique_ptr<std::atomic<size_t>[]> _pendingDependencies;
+  std::vector<SystemTiming> _timeline;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_SCHEDULER_HPP
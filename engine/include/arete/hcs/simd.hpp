@@ -0,0 +1,25 @@
+#ifndef ARETE_SIMD_HPP
+#define ARETE_SIMD_HPP
+
+#include <cstdint>
+
+namespace arete::hcs
+{
+
+//! Instruction set used by the batch kernels.
+enum class SimdLevel : uint8_t
+{
+  Scalar,
+  Sse41,
+  Avx2
+};
+
+//! @returns Best instruction set supported by the processor, detected once.
+[[nodiscard]] SimdLevel detectSimdLevel() noexcept;
+
+//! @returns Name of the instruction set.
+[[nodiscard]] const char* simdLevelName(SimdLevel level) noexcept;
+
+} // namespace arete::hcs
+
+#endif // ARETE_SIMD_HPP
@@ -0,0 +1,117 @@
+#ifndef ARETE_SNAPSHOT_HPP
+#define ARETE_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Snapshot of storage state in a single contiguous buffer.
+//! The buffer is split into sections, one per write, which are diffed separately.
+struct Snapshot
+{
+  //! Snapshot bytes.
+  std::vector<std::byte> data;
+  //! Size of every section, in order. Empty if the whole buffer is a single section.
+  std::vector<uint64_t> sections;
+};
+
+//! Compact difference between two snapshots.
+struct SnapshotDelta
+{
+  //! Run of changed bytes.
+  struct Run
+  {
+    //! Section of the run in the target snapshot.
+    uint64_t section;
+    //! Offset of the run in the section.
+    uint64_t offset;
+    //! Length of the run.
+    uint64_t length;
+  };
+
+  //! Size of every section of the target snapshot.
+  std::vector<uint64_t> targetSections;
+  //! Runs of changed bytes, ordered by section and offset.
+  std::vector<Run> runs;
+  //! Changed bytes of all runs, concatenated.
+  std::vector<std::byte> bytes;
+};
+
+//! Size of the block compared when diffing snapshots.
+inline constexpr size_t SnapshotDeltaBlockSize = 64;
+
+//! Computes difference between snapshots.
+//! Sections are compared with the section of the same index in blocks at offsets from the start
+//! of the section, so a section changing its length does not shift the blocks of the sections after it.
+//! Adjacent changed blocks are merged into a single run.
+//! @param base Base snapshot.
+//! @param target Target snapshot.
+//! @returns Delta transforming the base snapshot into the target snapshot.
+SnapshotDelta diffSnapshots(const Snapshot& base, const Snapshot& target);
+
+//! Applies delta to the snapshot.
+//! @param snapshot Base snapshot, transformed into the target snapshot.
+//! @param delta Delta computed against the base snapshot.
+//! @throws std::out_of_range if a run lies outside of its section or past the delta bytes.
+void applySnapshotDelta(Snapshot& snapshot, const SnapshotDelta& delta);
+
+//! Sequential writer of snapshot sections.
+class SnapshotWriter
+{
+public:
+  explicit SnapshotWriter(Snapshot& snapshot) noexcept
+    : _snapshot(snapshot)
+  {}
+
+  //! Appends bytes to the snapshot as a new section.
+  void write(const void* source, size_t size);
+
+  template<class T>
+  //! Appends span of trivially copyable values as a new section.
+  void write(std::span<const T> values)
+  {
+    write(values.data(), values.size_bytes());
+  }
+
+private:
+  Snapshot& _snapshot;
+};
+
+//! Sequential reader of snapshot sections.
+class SnapshotReader
+{
+public:
+  explicit SnapshotReader(const Snapshot& snapshot) noexcept
+    : _snapshot(snapshot)
+  {}
+
+  //! Reads bytes from the snapshot.
+  //! @throws std::out_of_range if the snapshot is truncated.
+  void read(void* destination, size_t size);
+
+  template<class T>
+  //! Reads trivially copyable values into the span.
+  //! @throws std::out_of_range if the snapshot is truncated.
+  void read(std::span<T> values)
+  {
+    read(values.data(), values.size_bytes());
+  }
+
+  //! @returns Count of bytes left to read.
+  [[nodiscard]] size_t remaining() const noexcept
+  {
+    return _snapshot.data.size() - _offset;
+  }
+
+private:
+  const Snapshot& _snapshot;
+  size_t _offset = 0;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_SNAPSHOT_HPP
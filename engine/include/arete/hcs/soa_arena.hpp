@@ -0,0 +1,238 @@
+#ifndef ARETE_SOA_ARENA_HPP
+#define ARETE_SOA_ARENA_HPP
+
+#include "arete/core.hpp"
+#include "arete/hcs/sparse_index.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Allocator aligning its storage to at least a cache line,
+//! so arrays can be fed to aligned vector loads.
+template<class T, size_t Alignment = 64>
+struct AlignedAllocator
+{
+  using value_type = T;
+
+  //! Alignment of the storage.
+  static constexpr std::align_val_t StorageAlignment{std::max(Alignment, alignof(T))};
+
+  template<class U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+
+  template<class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+  {}
+
+  [[nodiscard]] T* allocate(const size_t count)
+  {
+    return static_cast<T*>(::operator new(count * sizeof(T), StorageAlignment));
+  }
+
+  void deallocate(T* storage, const size_t count) noexcept
+  {
+    ::operator delete(storage, count * sizeof(T), StorageAlignment);
+  }
+
+  template<class U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+  {
+    return true;
+  }
+};
+
+//! Structure-of-arrays arena.
+//! Object is described by a tuple of fields, each field is stored in its own aligned array.
+//! Systems touching only some of the fields pull only those fields through the cache
+//! and can feed the per-field spans directly into vectorized loops.
+//!
+//! Objects are addressed by the same generational handles as in Arena,
+//! field arrays are packed with the same swap-and-pop scheme.
+//! Unlike Arena, the field arrays are contiguous and may move when they grow.
+template<std::unsigned_integral ObjectHandleType, class ObjectFields>
+class SoAArena;
+
+template<std::unsigned_integral ObjectHandleType, class... FieldTypes>
+class SoAArena<ObjectHandleType, std::tuple<FieldTypes...>>
+{
+  static_assert(sizeof...(FieldTypes) > 0, "SoAArena requires at least one field.");
+
+public:
+  //! Sparse index of the object handles.
+  using ObjectHandleIndex = SparseIndex<ObjectHandleType>;
+  //! Layout of the object handles.
+  using Handle = typename ObjectHandleIndex::Handle;
+  //! Represents index of an object in the field arrays.
+  using ObjectIndex = typename ObjectHandleIndex::ObjectIndex;
+  //! Fields of the object.
+  using ObjectFields = std::tuple<FieldTypes...>;
+
+  //! Type of the field at the index.
+  template<size_t FieldIndex>
+  using FieldType = std::tuple_element_t<FieldIndex, ObjectFields>;
+
+  //! Contiguous aligned array of a single field.
+  template<class Field>
+  using FieldArray = std::vector<Field, AlignedAllocator<Field>>;
+
+  //! Count of the fields.
+  static constexpr size_t FieldCount = sizeof...(FieldTypes);
+
+  //! Default constructor.
+  SoAArena() = default;
+
+  //! Deleted copy constructor.
+  SoAArena(const SoAArena& rhs) = delete;
+
+  //! Deleted move constructor.
+  SoAArena(SoAArena&& rhs) = delete;
+
+  //! Creates new object with value-initialized fields.
+  //! @returns Object handle.
+  //! @throws std::length_error if the arena ran out of addressable slots.
+  [[nodiscard]] ObjectHandleType createObject()
+  {
+    return createObject(FieldTypes{}...);
+  }
+
+  //! Creates new object with specified fields.
+  //! Nothing is created if storing a field throws.
+  //! @returns Object handle.
+  //! @throws std::length_error if the arena ran out of addressable slots.
+  [[nodiscard]] ObjectHandleType createObject(FieldTypes... fields)
+  {
+    const ObjectHandleType objectHandle = _objectIndex.insert();
+    size_t appendedCount = 0;
+    try
+    {
+      std::apply(
+        [&](auto&... arrays) { ((arrays.emplace_back(std::move(fields)), ++appendedCount), ...); },
+        _fields);
+      return objectHandle;
+    } catch (...)
+    {
+      // Field arrays appended before the failure are shrunk back, so they stay co-indexed.
+      size_t array = 0;
+      std::apply(
+        [&](auto&... arrays) {
+          ([&](auto& fieldArray) {
+            if (array++ < appendedCount)
+              fieldArray.pop_back();
+          }(arrays), ...);
+        },
+        _fields);
+      [[maybe_unused]] const auto index = _objectIndex.erase(objectHandle);
+      throw;
+    }
+  }
+
+  //! Destroys object in the arena.
+  //! Last object in the field arrays is moved to the place of the destroyed object.
+  //! @param objectHandle Object handle.
+  //! @returns True if the object was destroyed, false if the handle is stale.
+  [[maybe_unused]] bool destroyObject(const ObjectHandleType objectHandle)
+  {
+    const auto index = _objectIndex.erase(objectHandle);
+    if (!index)
+      return false;
+
+    std::apply(
+      [&](auto&... arrays) {
+        ([&](auto& array) {
+          if (*index != array.size() - 1)
+            array[*index] = std::move(array.back());
+          array.pop_back();
+        }(arrays), ...);
+      },
+      _fields);
+
+    return true;
+  }
+
+  //! Reserves storage in all field arrays.
+  //! @param capacity Count of objects.
+  void reserve(const size_t capacity)
+  {
+    std::apply(
+      [&](auto&... arrays) { (arrays.reserve(capacity), ...); },
+      _fields);
+  }
+
+  //! @returns True if the handle refers to a live object.
+  [[nodiscard]] bool contains(const ObjectHandleType objectHandle) const noexcept
+  {
+    return _objectIndex.contains(objectHandle);
+  }
+
+  //! Gets all fields of object by its handle.
+  //! @returns Optional tuple of field references, empty if the handle is stale.
+  [[nodiscard]] std::optional<std::tuple<FieldTypes&...>> getObject(const ObjectHandleType objectHandle)
+  {
+    const auto index = _objectIndex.find(objectHandle);
+    if (!index)
+      return std::nullopt;
+    return std::apply(
+      [&](auto&... arrays) { return std::tuple<FieldTypes&...>(arrays[*index]...); },
+      _fields);
+  }
+
+  template<size_t FieldIndex>
+  //! Gets single field of object by its handle.
+  //! @returns Optional field reference, empty if the handle is stale.
+  [[nodiscard]] std::optional<Ref<FieldType<FieldIndex>>> getField(const ObjectHandleType objectHandle)
+  {
+    const auto index = _objectIndex.find(objectHandle);
+    if (!index)
+      return std::nullopt;
+    return std::get<FieldIndex>(_fields)[*index];
+  }
+
+  template<size_t FieldIndex>
+  //! @returns Packed span of the field of all live objects, co-indexed with handles.
+  [[nodiscard]] std::span<FieldType<FieldIndex>> field() noexcept
+  {
+    return std::get<FieldIndex>(_fields);
+  }
+
+  template<size_t FieldIndex>
+  //! @returns Packed span of the immutable field of all live objects, co-indexed with handles.
+  [[nodiscard]] std::span<const FieldType<FieldIndex>> field() const noexcept
+  {
+    return std::get<FieldIndex>(_fields);
+  }
+
+  //! @returns Count of live objects.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _objectIndex.size();
+  }
+
+  //! @returns Packed span of live object handles, co-indexed with fields.
+  [[nodiscard]] std::span<const ObjectHandleType> handles() const noexcept
+  {
+    return _objectIndex.handles();
+  }
+
+private:
+  std::tuple<FieldArray<FieldTypes>...> _fields;
+  ObjectHandleIndex _objectIndex;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_SOA_ARENA_HPP
@@ -0,0 +1,300 @@
+#ifndef ARETE_SPARSE_INDEX_HPP
+#define ARETE_SPARSE_INDEX_HPP
+
+#include "arete/hcs/handle.hpp"
+#include "arete/hcs/snapshot.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Sparse index of generational handles.
+//! Maps handles through slots to indexes in a dense array owned by the user of the index.
+//! Erasing a handle moves the last dense entry into the hole,
+//! the owner of the dense array is expected to move its storage the same way.
+//! All arrays of the index are allocated from its memory resource.
+//!
+//! Freed slots are reused in the order they were freed, and only while more than
+//! MinimumFreeSlots slots are free, so at least MinimumFreeSlots other handles are erased
+//! between two reuses of a slot. Generations wrap around, a stale handle is mistaken for a live one
+//! only after its slot was reused 2^GenerationBits times, that is after at least
+//! 2^GenerationBits * MinimumFreeSlots erasures (256 * 1024 for 32-bit handles).
+template<std::unsigned_integral ObjectHandleType>
+class SparseIndex
+{
+public:
+  //! Layout of the object handles.
+  using Handle = HandleTraits<ObjectHandleType>;
+  //! Represents index in the dense array, or index of a slot.
+  using ObjectIndex = ObjectHandleType;
+  //! Represents generation of a slot.
+  using ObjectGeneration = ObjectHandleType;
+  //! Contiguous array of live handles, co-indexed with the dense array.
+  using ObjectHandleArray = std::pmr::vector<ObjectHandleType>;
+
+  //! Slot.
+  struct ObjectSlot
+  {
+    //! Index in the dense array.
+    ObjectIndex index;
+    //! Generation of the slot.
+    ObjectGeneration generation;
+  };
+
+  //! Represents all slots, indexed by the slot index of handles.
+  using ObjectSlotArray = std::pmr::vector<ObjectSlot>;
+  //! Represents array of freed slots which can be re-used.
+  using ObjectSlotFreeList = std::pmr::vector<ObjectIndex>;
+
+  //! Index of a slot which does not hold any object.
+  static constexpr ObjectIndex InvalidIndex = std::numeric_limits<ObjectIndex>::max();
+  //! Count of free slots kept before a freed slot is reused.
+  static constexpr size_t MinimumFreeSlots = 1024;
+
+  //! Constructs empty index.
+  //! @param resource Memory resource of the index, must outlive the index.
+  explicit SparseIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept
+    : _handles(resource)
+    , _slots(resource)
+    , _slotFreelist(resource)
+    , _freeMarks(resource)
+  {}
+
+  //! Inserts new handle at the end of the dense array.
+  //! @returns Handle.
+  //! @throws std::length_error if the index ran out of addressable slots.
+  [[nodiscard]] ObjectHandleType insert()
+  {
+    // Reuse the oldest free slot once enough slots are free,
+    // otherwise allocate a new one. Out of addressable slots, reuse any free slot.
+    const bool reuse = freeCount() > MinimumFreeSlots
+      || (freeCount() != 0 && _slots.size() >= Handle::MaxSlots);
+    if (!reuse && _slots.size() >= Handle::MaxSlots)
+      throw std::length_error("Ran out of addressable object slots.");
+
+    ObjectIndex slotIndex = 0;
+    if (reuse)
+    {
+      slotIndex = _slotFreelist[_freeHead];
+      _handles.emplace_back(Handle::make(slotIndex, _slots[slotIndex].generation));
+      popFreeSlot();
+    } else
+    {
+      slotIndex = static_cast<ObjectIndex>(_slots.size());
+      _slots.emplace_back(ObjectSlot{InvalidIndex, 0});
+      try
+      {
+        _handles.emplace_back(Handle::make(slotIndex, 0));
+      } catch (...)
+      {
+        _slots.pop_back();
+        throw;
+      }
+    }
+
+    _slots[slotIndex].index = static_cast<ObjectIndex>(_handles.size() - 1);
+    return _handles.back();
+  }
+
+  //! Reserves space for the specified count of additional handles.
+  //! @param count Count of additional handles.
+  //! @throws std::length_error if the index can not address that many handles.
+  void reserve(const size_t count)
+  {
+    const size_t freeSlots = freeCount() + (Handle::MaxSlots - _slots.size());
+    if (count > freeSlots)
+      throw std::length_error("Ran out of addressable object slots.");
+
+    _handles.reserve(_handles.size() + count);
+    const size_t reusable = freeCount() > MinimumFreeSlots ? freeCount() - MinimumFreeSlots : 0;
+    if (count > reusable)
+      _slots.reserve(std::min<size_t>(_slots.size() + count - reusable, Handle::MaxSlots));
+  }
+
+  //! Sorts the reusable part of the free list so the lowest slots are re-used first.
+  //! Keeps slots of objects created in bulk close to each other.
+  //! The MinimumFreeSlots most recently freed slots keep their order, so they are not reused early.
+  void sortFreeList()
+  {
+    if (freeCount() <= MinimumFreeSlots)
+      return;
+    const auto reusable = std::span(_slotFreelist).subspan(_freeHead, freeCount() - MinimumFreeSlots);
+
+    // Slots are bounded by the slot count, so sort through a bitmap in linear time.
+    // The bitmap is kept between calls, so repeated sorting does not allocate.
+    _freeMarks.assign((_slots.size() + 63) / 64, 0);
+    for (const auto slotIndex: reusable)
+      _freeMarks[slotIndex / 64] |= uint64_t{1} << (slotIndex % 64);
+
+    size_t position = 0;
+    for (size_t word = 0; word < _freeMarks.size(); ++word)
+    {
+      for (uint64_t bits = _freeMarks[word]; bits != 0; bits &= bits - 1)
+        reusable[position++] = static_cast<ObjectIndex>(word * 64 + std::countr_zero(bits));
+    }
+  }
+
+  //! Erases handle from the index.
+  //! Last handle in the dense array is moved to the place of the erased handle.
+  //! @param objectHandle Handle.
+  //! @returns Dense index of the erased handle, empty if the handle is stale.
+  [[nodiscard]] std::optional<ObjectIndex> erase(const ObjectHandleType objectHandle)
+  {
+    if (!contains(objectHandle))
+      return std::nullopt;
+
+    const ObjectIndex slotIndex = Handle::index(objectHandle);
+    auto& slot = _slots[slotIndex];
+    const ObjectIndex index = slot.index;
+    const ObjectIndex lastIndex = static_cast<ObjectIndex>(_handles.size() - 1);
+
+    // Fill the hole with the last handle and patch its slot.
+    if (index != lastIndex)
+    {
+      _handles[index] = _handles[lastIndex];
+      _slots[Handle::index(_handles[index])].index = index;
+    }
+    _handles.pop_back();
+
+    // Invalidate all handles to this slot
+    // and mark this slot as free.
+    slot.index = InvalidIndex;
+    slot.generation = Handle::nextGeneration(slot.generation);
+    _slotFreelist.push_back(slotIndex);
+
+    return index;
+  }
+
+  //! @returns True if the handle refers to a live object.
+  [[nodiscard]] bool contains(const ObjectHandleType objectHandle) const noexcept
+  {
+    const ObjectIndex slotIndex = Handle::index(objectHandle);
+    return slotIndex < _slots.size()
+      && _slots[slotIndex].generation == Handle::generation(objectHandle)
+      && _slots[slotIndex].index != InvalidIndex;
+  }
+
+  //! @returns Dense index of the handle, empty if the handle is stale.
+  [[nodiscard]] std::optional<ObjectIndex> find(const ObjectHandleType objectHandle) const noexcept
+  {
+    if (!contains(objectHandle))
+      return std::nullopt;
+    return _slots[Handle::index(objectHandle)].index;
+  }
+
+  //! @returns Count of live handles.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _handles.size();
+  }
+
+  //! @returns Count of free slots.
+  [[nodiscard]] size_t freeCount() const noexcept
+  {
+    return _slotFreelist.size() - _freeHead;
+  }
+
+  //! @returns Packed span of live handles, co-indexed with the dense array.
+  [[nodiscard]] std::span<const ObjectHandleType> handles() const noexcept
+  {
+    return _handles;
+  }
+
+  //! @returns Memory resource of the index.
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept
+  {
+    return _handles.get_allocator().resource();
+  }
+
+  //! Writes handles, slots and the free list to the snapshot.
+  //! @param writer Snapshot writer.
+  void snapshot(SnapshotWriter& writer) const
+  {
+    const uint64_t counts[] {_handles.size(), _slots.size(), freeCount()};
+    writer.write(counts, sizeof(counts));
+    writer.write(std::span<const ObjectHandleType>(_handles));
+    writer.write(std::span<const ObjectSlot>(_slots));
+    writer.write(std::span<const ObjectIndex>(_slotFreelist).subspan(_freeHead));
+  }
+
+  //! Reads handles, slots and the free list from the snapshot.
+  //! @param reader Snapshot reader.
+  //! @throws std::out_of_range if the snapshot is truncated.
+  //! @throws std::length_error if the snapshot holds more slots than addressable,
+  //! or more handles than slots.
+  //! @throws std::invalid_argument if a handle, slot or free list entry indexes past its array.
+  //! The index is left in an unspecified state if restoring throws.
+  void restore(SnapshotReader& reader)
+  {
+    uint64_t counts[3] {};
+    reader.read(counts, sizeof(counts));
+    if (counts[1] > Handle::MaxSlots || counts[0] > counts[1] || counts[2] > counts[1])
+      throw std::length_error("Snapshot object slots are out of range.");
+
+    _handles.resize(counts[0]);
+    _slots.resize(counts[1]);
+    _slotFreelist.resize(counts[2]);
+    _freeHead = 0;
+    reader.read(std::span<ObjectHandleType>(_handles));
+    reader.read(std::span<ObjectSlot>(_slots));
+    reader.read(std::span<ObjectIndex>(_slotFreelist));
+
+    // Lookups index the arrays without bounds checks, reject indexes a valid index never holds.
+    for (const auto handle: _handles)
+    {
+      if (Handle::index(handle) >= _slots.size())
+        throw std::invalid_argument("Snapshot object handle is out of range.");
+    }
+    for (const auto& slot: _slots)
+    {
+      if (slot.index != InvalidIndex && slot.index >= _handles.size())
+        throw std::invalid_argument("Snapshot object slot is out of range.");
+    }
+    for (const auto slotIndex: _slotFreelist)
+    {
+      if (slotIndex >= _slots.size())
+        throw std::invalid_argument("Snapshot free object slot is out of range.");
+    }
+  }
+
+private:
+  //! Removes the oldest slot from the free list.
+  void popFreeSlot() noexcept
+  {
+    // The free list is a queue starting at the head, consumed entries are dropped
+    // once they make up half of the list, so popping is amortized constant.
+    if (++_freeHead == _slotFreelist.size())
+    {
+      _slotFreelist.clear();
+      _freeHead = 0;
+    } else if (_freeHead * 2 >= _slotFreelist.size())
+    {
+      _slotFreelist.erase(_slotFreelist.begin(), _slotFreelist.begin() + static_cast<ptrdiff_t>(_freeHead));
+      _freeHead = 0;
+    }
+  }
+
+private:
+  ObjectHandleArray _handles;
+
+  ObjectSlotArray _slots;
+  //! Queue of free slots, oldest first, starting at the head.
+  ObjectSlotFreeList _slotFreelist;
+  size_t _freeHead = 0;
+  std::pmr::vector<uint64_t> _freeMarks;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_SPARSE_INDEX_HPP
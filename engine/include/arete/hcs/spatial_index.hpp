@@ -0,0 +1,273 @@
+#ifndef ARETE_SPATIAL_INDEX_HPP
+#define ARETE_SPATIAL_INDEX_HPP
+
+#include "arete/hcs/bounds.hpp"
+#include "arete/hcs/handle.hpp"
+#include "arete/hcs/transform_hierarchy.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Generational handle of an object of a spatial index.
+using SpatialHandle = uint32_t;
+
+//! Nearest object hit by a ray.
+struct RayHit
+{
+  SpatialHandle object;
+  //! Distance at which the ray enters the bounds of the object.
+  float distance;
+};
+
+//! Loose octree of object bounds.
+//! Every object is stored in a single node whose cell contains the center of its bounds
+//! and is at least as large as the bounds. Loose node bounds are twice the size of the cell,
+//! so they enclose every object of the node and the node is found directly from the bounds,
+//! without testing the objects of the neighboring nodes.
+//! Nodes hold objects smaller than their cell until they are full, then they split and move
+//! those objects to their children, so sparse regions of the world stay shallow.
+//!
+//! Moving an object within its cell updates its bounds in place, otherwise the object
+//! moves to another node, which is proportional to the depth of the octree.
+//! Queries skip empty subtrees and collect whole subtrees lying inside the query volume
+//! without testing their objects.
+//!
+//! Objects with the center outside of the world bounds are kept in the root node
+//! and tested by every query.
+class SpatialIndex
+{
+public:
+  //! Layout of the object handles.
+  using Handle = HandleTraits<SpatialHandle>;
+
+  //! Handle of no object.
+  static constexpr SpatialHandle NoObject = std::numeric_limits<SpatialHandle>::max();
+
+  //! Maximum depth of the octree.
+  static constexpr uint32_t MaxDepth = 16;
+
+  //! Count of objects of a node above which the objects fitting smaller cells move to its children.
+  static constexpr size_t SplitThreshold = 16;
+
+  //! Constructs empty index.
+  //! @param worldBounds Bounds of the world, enclosed by the cell of the root node.
+  //! @param depth Depth of the octree, at most MaxDepth.
+  //!              Cells of the deepest nodes are 2^depth times smaller than the world.
+  //! @param resource Memory resource of the index, must outlive the index.
+  //! @throws std::invalid_argument if the depth is too large.
+  explicit SpatialIndex(
+    const Aabb& worldBounds,
+    uint32_t depth = 10,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  //! Inserts object.
+  //! @param bounds World bounds of the object.
+  //! @returns Handle of the object.
+  //! @throws std::length_error if the index ran out of addressable slots.
+  [[nodiscard]] SpatialHandle insert(const Aabb& bounds);
+
+  //! Inserts objects.
+  //! @param bounds World bounds of every object.
+  //! @param objects Receives handle of every object.
+  //! @throws std::invalid_argument if the sizes of the arrays differ.
+  //! @throws std::length_error if the index ran out of addressable slots.
+  void insert(std::span<const Aabb> bounds, std::span<SpatialHandle> objects);
+
+  //! Inserts object following a transform of the hierarchy.
+  //! Its world bounds are refitted by refit(const TransformHierarchy&).
+  //! @param hierarchy Transform hierarchy.
+  //! @param transform Transform of the object, at most one object follows a transform.
+  //! @param localBounds Bounds of the object relative to the transform.
+  //! @returns Handle of the object.
+  //! @throws std::invalid_argument if the transform does not exist or already has an object.
+  //! @throws std::length_error if the index ran out of addressable slots.
+  [[nodiscard]] SpatialHandle insert(
+    const TransformHierarchy& hierarchy,
+    TransformHandle transform,
+    const Aabb& localBounds);
+
+  //! Removes object.
+  //! @throws std::invalid_argument if the object does not exist.
+  void remove(SpatialHandle object);
+
+  //! Removes objects.
+  //! @throws std::invalid_argument if an object does not exist.
+  void remove(std::span<const SpatialHandle> objects);
+
+  //! Updates world bounds of the object.
+  //! @throws std::invalid_argument if the object does not exist.
+  void refit(SpatialHandle object, const Aabb& bounds);
+
+  //! Updates world bounds of the objects.
+  //! @param objects Objects.
+  //! @param bounds World bounds of every object.
+  //! @throws std::invalid_argument if the sizes of the arrays differ or an object does not exist.
+  void refit(std::span<const SpatialHandle> objects, std::span<const Aabb> bounds);
+
+  //! Updates world bounds of the objects following transforms recomputed by the last update of the hierarchy.
+  //! @param hierarchy Transform hierarchy the objects were inserted with.
+  void refit(const TransformHierarchy& hierarchy);
+
+  //! @returns True if the object exists.
+  [[nodiscard]] bool contains(SpatialHandle object) const noexcept;
+
+  //! @returns World bounds of the object.
+  //! @throws std::invalid_argument if the object does not exist.
+  [[nodiscard]] const Aabb& bounds(SpatialHandle object) const;
+
+  //! Collects objects whose bounds overlap the box.
+  //! @param box Query box.
+  //! @param objects Array the objects are appended to.
+  void query(const Aabb& box, std::vector<SpatialHandle>& objects) const;
+
+  //! Collects objects whose bounds overlap the sphere.
+  //! @param sphere Query sphere.
+  //! @param objects Array the objects are appended to.
+  void query(const Sphere& sphere, std::vector<SpatialHandle>& objects) const;
+
+  //! Collects objects whose bounds overlap the frustum.
+  //! @param frustum Query frustum.
+  //! @param objects Array the objects are appended to.
+  void query(const Frustum& frustum, std::vector<SpatialHandle>& objects) const;
+
+  //! Collects objects whose bounds are hit by the ray, in no particular order.
+  //! @param ray Query ray.
+  //! @param maxDistance Length of the ray.
+  //! @param objects Array the objects are appended to.
+  void query(const Ray& ray, float maxDistance, std::vector<SpatialHandle>& objects) const;
+
+  //! Finds the nearest object whose bounds are hit by the ray.
+  //! @param ray Query ray.
+  //! @param maxDistance Length of the ray.
+  //! @returns Nearest hit, or nothing if the ray hits no object.
+  [[nodiscard]] std::optional<RayHit> raycast(const Ray& ray, float maxDistance) const;
+
+  //! @returns Count of objects.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _nodes[RootNode].objectCount;
+  }
+
+  //! @returns Count of the nodes holding or leading to objects.
+  [[nodiscard]] size_t nodeCount() const noexcept
+  {
+    return _nodes.size() - _nodeFreeList.size();
+  }
+
+private:
+  //! Index of a node.
+  using NodeIndex = uint32_t;
+  //! Index of no node.
+  static constexpr NodeIndex NoNode = std::numeric_limits<NodeIndex>::max();
+  //! Index of the root node.
+  static constexpr NodeIndex RootNode = 0;
+
+  //! Object stored in a node.
+  struct Entry
+  {
+    Aabb bounds;
+    SpatialHandle object;
+  };
+
+  //! Node of the octree.
+  struct Node
+  {
+    //! Center of the cell.
+    glm::vec3 center;
+    //! Half size of the cell, loose bounds are twice as large.
+    float halfSize;
+    uint32_t depth;
+    NodeIndex parent;
+    //! Children by octant, bit 0 set for the positive x half, bit 1 for y and bit 2 for z.
+    std::array<NodeIndex, 8> children;
+    //! Count of objects of the node and its descendants.
+    uint32_t objectCount;
+    //! Whether the objects fitting smaller cells were moved to the children.
+    bool split;
+    std::pmr::vector<Entry> entries;
+  };
+
+  //! Slot of a handle.
+  struct Slot
+  {
+    //! Node of the object, or NoNode if the slot is free.
+    NodeIndex node;
+    //! Index of the object in the node entries.
+    uint32_t entry;
+    //! Generation of the slot.
+    SpatialHandle generation;
+    //! Transform the object follows, or NoTransform.
+    TransformHandle transform;
+    //! Bounds relative to the transform.
+    Aabb localBounds;
+  };
+
+  //! @returns Slot of the object.
+  //! @throws std::invalid_argument if the object does not exist.
+  [[nodiscard]] Slot& slotOf(SpatialHandle object);
+
+  //! @returns Depth of the node the bounds belong to, 0 for bounds centered outside of the world.
+  [[nodiscard]] uint32_t depthOf(const Aabb& bounds) const noexcept;
+
+  //! @returns Node the bounds belong to, creating the missing nodes on the way.
+  [[nodiscard]] NodeIndex nodeOf(const Aabb& bounds);
+
+  //! @returns Child of the node whose cell contains the point, created if missing.
+  [[nodiscard]] NodeIndex childOf(NodeIndex node, const glm::vec3& point);
+
+  //! @returns Loose bounds of the node.
+  [[nodiscard]] Aabb looseBounds(const Node& node) const noexcept;
+
+  //! Appends the object to the node and counts it in the ancestors.
+  void link(SpatialHandle object, const Aabb& bounds, NodeIndex node);
+
+  //! Removes the object from its node and releases the nodes left empty.
+  void unlink(Slot& slot);
+
+  //! Removes the entry from the node, moving the last entry of the node in its place.
+  //! @returns Removed entry.
+  Entry takeEntry(NodeIndex node, uint32_t entry);
+
+  //! Splits the node once it is full, moving the objects fitting smaller cells to the children.
+  void split(NodeIndex node);
+
+  //! Creates the child of the node in the octant.
+  [[nodiscard]] NodeIndex createChild(NodeIndex parent, uint32_t octant);
+
+  template<typename Classify, typename Test>
+  //! Collects objects of the nodes the classifier does not reject and which pass the test.
+  void collect(Classify&& classify, Test&& test, std::vector<SpatialHandle>& objects) const;
+
+  //! Appends every object of the subtree.
+  void collectSubtree(NodeIndex node, std::vector<SpatialHandle>& objects) const;
+
+private:
+  std::pmr::memory_resource* _resource;
+
+  //! Center and half size of the cell of the root node.
+  glm::vec3 _rootCenter;
+  float _rootHalfSize;
+  uint32_t _depth;
+
+  std::pmr::vector<Node> _nodes;
+  std::pmr::vector<NodeIndex> _nodeFreeList;
+
+  std::pmr::vector<Slot> _slots;
+  std::pmr::vector<SpatialHandle> _slotFreeList;
+
+  //! Object following every transform, indexed by the slot of the transform handle.
+  std::pmr::vector<SpatialHandle> _transformObjects;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_SPATIAL_INDEX_HPP
@@ -0,0 +1,57 @@
+#ifndef ARETE_TRANSFORM_BATCH_HPP
+#define ARETE_TRANSFORM_BATCH_HPP
+
+#include "arete/hcs/simd.hpp"
+
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace arete::hcs
+{
+
+//! Positions, rotations and scales of transforms as structure of arrays.
+//! All arrays hold a value per transform.
+struct TransformBatch
+{
+  std::span<const float> positionX;
+  std::span<const float> positionY;
+  std::span<const float> positionZ;
+
+  //! Rotations as unit quaternions.
+  std::span<const float> rotationX;
+  std::span<const float> rotationY;
+  std::span<const float> rotationZ;
+  std::span<const float> rotationW;
+
+  std::span<const float> scaleX;
+  std::span<const float> scaleY;
+  std::span<const float> scaleZ;
+
+  //! @returns Count of transforms.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return positionX.size();
+  }
+};
+
+//! Composes world matrices of the transforms, translation * rotation * scale,
+//! and their clip matrices, view-projection * world.
+//! Matches SpatialComponent::localMatrix within floating-point rounding.
+//! @param batch Transforms.
+//! @param viewProjection View-projection matrix.
+//! @param worlds World matrix for every transform.
+//! @param clips Clip matrix for every transform.
+//! @param level Instruction set, clamped to the one supported by the processor.
+//! @throws std::invalid_argument if the sizes of the arrays differ.
+void composeTransforms(
+  const TransformBatch& batch,
+  const glm::mat4& viewProjection,
+  std::span<glm::mat4> worlds,
+  std::span<glm::mat4> clips,
+  SimdLevel level = detectSimdLevel());
+
+} // namespace arete::hcs
+
+#endif // ARETE_TRANSFORM_BATCH_HPP
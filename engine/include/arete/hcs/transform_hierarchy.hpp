@@ -0,0 +1,196 @@
+#ifndef ARETE_TRANSFORM_HIERARCHY_HPP
+#define ARETE_TRANSFORM_HIERARCHY_HPP
+
+#include "arete/hcs/components/spatial.hpp"
+#include "arete/hcs/handle.hpp"
+#include "arete/threading/job_system.hpp"
+
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Generational handle of a transform.
+using TransformHandle = uint32_t;
+
+//! Hierarchy of transforms with cached world matrices.
+//! Transforms are stored in breadth-first order, so parents precede their children,
+//! children of a transform are contiguous and transforms of a depth form a contiguous level.
+//!
+//! Modifying a transform marks it dirty. Update recomputes world matrices of the dirty
+//! transforms and their descendants only, level by level, so its cost is proportional
+//! to what moved rather than to the size of the hierarchy. Transforms of a level are
+//! independent of each other and may be split across workers.
+//!
+//! Structural changes (creation, destruction, re-parenting) re-sort the hierarchy
+//! on the next update, which is linear in its size.
+class TransformHierarchy
+{
+public:
+  //! Layout of the transform handles.
+  using Handle = HandleTraits<TransformHandle>;
+
+  //! Handle of no transform, parent of the root transforms.
+  static constexpr TransformHandle NoTransform = std::numeric_limits<TransformHandle>::max();
+
+  //! Count of transforms of a level recomputed by a single job.
+  static constexpr size_t ParallelBatchSize = 1024;
+
+  //! Constructs empty hierarchy.
+  //! @param resource Memory resource of the hierarchy, must outlive the hierarchy.
+  explicit TransformHierarchy(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  //! Creates transform.
+  //! @param local Transform relative to the parent.
+  //! @param parent Parent transform, or NoTransform for a root transform.
+  //! @returns Handle of the transform.
+  //! @throws std::invalid_argument if the parent does not exist.
+  //! @throws std::length_error if the hierarchy ran out of addressable slots.
+  [[nodiscard]] TransformHandle create(const SpatialComponent& local = {}, TransformHandle parent = NoTransform);
+
+  //! Destroys transform with all its descendants.
+  //! @throws std::invalid_argument if the transform does not exist.
+  void destroy(TransformHandle transform);
+
+  //! Attaches transform to a new parent, keeping its local transform.
+  //! @param transform Transform.
+  //! @param parent Parent transform, or NoTransform to make the transform a root.
+  //! @throws std::invalid_argument if a transform does not exist or the parent is a descendant of the transform.
+  void setParent(TransformHandle transform, TransformHandle parent);
+
+  //! @returns Parent of the transform, or NoTransform for a root transform.
+  //! @throws std::invalid_argument if the transform does not exist.
+  [[nodiscard]] TransformHandle parent(TransformHandle transform) const;
+
+  //! @returns True if the transform exists.
+  [[nodiscard]] bool contains(TransformHandle transform) const noexcept;
+
+  //! @returns Transform relative to the parent.
+  //! @throws std::invalid_argument if the transform does not exist.
+  [[nodiscard]] const SpatialComponent& local(TransformHandle transform) const;
+
+  //! Marks the transform dirty.
+  //! @returns Transform relative to the parent for modification.
+  //! @throws std::invalid_argument if the transform does not exist.
+  [[nodiscard]] SpatialComponent& modify(TransformHandle transform);
+
+  //! @returns World matrix of the transform as of the last update.
+  //! @throws std::invalid_argument if the transform does not exist.
+  [[nodiscard]] const glm::mat4& world(TransformHandle transform) const;
+
+  //! Recomputes world matrices of the dirty transforms and their descendants.
+  void update();
+
+  //! Recomputes world matrices of the dirty transforms and their descendants,
+  //! splitting large levels across the job system.
+  //! @param jobs Job system.
+  void update(threading::JobSystem& jobs);
+
+  //! @returns World matrices in breadth-first order, valid until the next structural change.
+  [[nodiscard]] std::span<const glm::mat4> worldMatrices() const noexcept
+  {
+    return _worlds;
+  }
+
+  //! @returns Handles in breadth-first order, co-indexed with the world matrices.
+  [[nodiscard]] std::span<const TransformHandle> handles() const noexcept
+  {
+    return _handles;
+  }
+
+  //! @returns Count of transforms.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _handles.size() - _destroyedCount;
+  }
+
+  //! @returns Count of levels of the hierarchy as of the last update.
+  [[nodiscard]] size_t levelCount() const noexcept
+  {
+    return _levels.empty() ? 0 : _levels.size() - 1;
+  }
+
+  //! @returns Count of world matrices recomputed by the last update.
+  [[nodiscard]] size_t updatedCount() const noexcept
+  {
+    return _updatedTransforms.size();
+  }
+
+  //! @returns Transforms whose world matrices were recomputed by the last update, parents first.
+  [[nodiscard]] std::span<const TransformHandle> updatedTransforms() const noexcept
+  {
+    return _updatedTransforms;
+  }
+
+private:
+  //! Index of a transform in the breadth-first arrays.
+  using Index = uint32_t;
+  //! Index of no transform.
+  static constexpr Index NoIndex = std::numeric_limits<Index>::max();
+
+  //! Slot of a handle.
+  struct Slot
+  {
+    //! Index of the transform, or NoIndex if the slot is free.
+    Index index;
+    //! Generation of the slot.
+    TransformHandle generation;
+  };
+
+  //! @returns Index of the transform.
+  //! @throws std::invalid_argument if the transform does not exist.
+  [[nodiscard]] Index indexOf(TransformHandle transform) const;
+
+  //! Marks the transform dirty.
+  void markDirty(Index index);
+
+  //! Sorts the transforms breadth-first and drops the destroyed ones.
+  void rebuild();
+
+  //! Recomputes world matrices level by level.
+  void update(threading::JobSystem* jobs);
+
+  //! Recomputes world matrix of the transform from its parent.
+  void computeWorld(Index index) noexcept;
+
+private:
+  // Breadth-first arrays, co-indexed.
+  std::pmr::vector<TransformHandle> _handles;
+  std::pmr::vector<Index> _parents;
+  std::pmr::vector<Index> _firstChildren;
+  std::pmr::vector<Index> _childCounts;
+  std::pmr::vector<SpatialComponent> _locals;
+  std::pmr::vector<glm::mat4> _worlds;
+  std::pmr::vector<uint8_t> _dirty;
+
+  //! Beginning of every level, followed by the end of the last level.
+  std::pmr::vector<Index> _levels;
+
+  std::pmr::vector<Slot> _slots;
+  std::pmr::vector<Index> _slotFreeList;
+
+  //! Transforms marked dirty since the last update.
+  std::pmr::vector<Index> _dirtyIndices;
+  //! Scratch arrays of the update and the rebuild, kept to reuse their capacity.
+  std::pmr::vector<Index> _levelIndices;
+  std::pmr::vector<Index> _childIndices;
+  std::pmr::vector<Index> _order;
+
+  std::pmr::vector<TransformHandle> _updatedTransforms;
+
+  //! Whether the breadth-first order is out of date.
+  bool _structureChanged = false;
+  //! Count of destroyed transforms still in the arrays.
+  size_t _destroyedCount = 0;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_TRANSFORM_HIERARCHY_HPP
@@ -0,0 +1,159 @@
+#ifndef ARETE_UPDATE_HPP
+#define ARETE_UPDATE_HPP
+
+#include "arete/hcs/arena.hpp"
+#include "arete/hcs/scheduler.hpp"
+#include "arete/hcs/components/component_draw.hpp"
+#include "arete/hcs/components/component_phys_tick.hpp"
+#include "arete/hcs/components/component_tick.hpp"
+
+#include <concepts>
+#include <span>
+#include <string>
+
+namespace arete::hcs
+{
+
+//! Type updated in batches by a static `update(std::span<T>, float deltaTime)`.
+template<class Type>
+concept BatchTickable = requires(std::span<Type> objects, float deltaTime)
+{
+  { Type::update(objects, deltaTime) } -> std::same_as<void>;
+};
+
+//! Type updated in batches by a static `physicsUpdate(std::span<T>, float deltaTime)`.
+template<class Type>
+concept BatchPhysTickable = requires(std::span<Type> objects, float deltaTime)
+{
+  { Type::physicsUpdate(objects, deltaTime) } -> std::same_as<void>;
+};
+
+//! Type drawn in batches by a static `draw(std::span<const T>)`.
+template<class Type>
+concept BatchDrawable = requires(std::span<const Type> objects)
+{
+  { Type::draw(objects) } -> std::same_as<void>;
+};
+
+//! @returns True if the type takes part in ticks, batched or through ComponentTick.
+template<class Type>
+inline constexpr bool Ticks = BatchTickable<Type> || std::derived_from<Type, ComponentTick>;
+
+//! @returns True if the type takes part in physics ticks, batched or through ComponentPhysTick.
+template<class Type>
+inline constexpr bool PhysTicks = BatchPhysTickable<Type> || std::derived_from<Type, ComponentPhysTick>;
+
+//! @returns True if the type takes part in drawing, batched or through ComponentDraw.
+template<class Type>
+inline constexpr bool Draws = BatchDrawable<Type> || std::derived_from<Type, ComponentDraw>;
+
+template<std::unsigned_integral ObjectHandleType, class ObjectType>
+  requires Ticks<ObjectType>
+//! Ticks all objects of the arena.
+//! Batched update is called once per page, otherwise onTick is called per object.
+//! @param arena Arena.
+//! @param deltaTime Time delta in seconds.
+void tickArena(Arena<ObjectHandleType, ObjectType>& arena, const float deltaTime)
+{
+  arena.objects().forEachPage([deltaTime](const std::span<ObjectType> page) {
+    if constexpr (BatchTickable<ObjectType>)
+    {
+      ObjectType::update(page, deltaTime);
+    } else
+    {
+      for (ComponentTick& object: page)
+        object.onTick(deltaTime);
+    }
+  });
+}
+
+template<std::unsigned_integral ObjectHandleType, class ObjectType>
+  requires PhysTicks<ObjectType>
+//! Ticks physics of all objects of the arena.
+//! Batched update is called once per page, otherwise onPhysTick is called per object.
+//! @param arena Arena.
+//! @param deltaTime Time delta in seconds.
+void physTickArena(Arena<ObjectHandleType, ObjectType>& arena, const float deltaTime)
+{
+  arena.objects().forEachPage([deltaTime](const std::span<ObjectType> page) {
+    if constexpr (BatchPhysTickable<ObjectType>)
+    {
+      ObjectType::physicsUpdate(page, deltaTime);
+    } else
+    {
+      for (ComponentPhysTick& object: page)
+        object.onPhysTick(deltaTime);
+    }
+  });
+}
+
+template<std::unsigned_integral ObjectHandleType, class ObjectType>
+  requires Draws<ObjectType>
+//! Draws all objects of the arena.
+//! Batched draw is called once per page, otherwise onDraw is called per object.
+//! @param arena Arena.
+void drawArena(Arena<ObjectHandleType, ObjectType>& arena)
+{
+  arena.objects().forEachPage([](const std::span<ObjectType> page) {
+    if constexpr (BatchDrawable<ObjectType>)
+    {
+      ObjectType::draw(std::span<const ObjectType>(page));
+    } else
+    {
+      for (ComponentDraw& object: page)
+        object.onDraw();
+    }
+  });
+}
+
+template<std::unsigned_integral ObjectHandleType, class ObjectType>
+//! Registers systems updating the arena in every phase its object type takes part in.
+//! Ticks run in the simulation phase, physics ticks in the physics phase
+//! and drawing in the draw extraction phase.
+//! @param scheduler Scheduler.
+//! @param name Name prefix of the systems.
+//! @param arena Arena, must outlive the scheduler.
+//! @param access Component types accessed by the updates besides the object type.
+void addUpdateSystems(
+  Scheduler& scheduler,
+  const std::string& name,
+  Arena<ObjectHandleType, ObjectType>& arena,
+  SystemAccess access = {})
+{
+  if constexpr (Ticks<ObjectType>)
+  {
+    scheduler.addSystem(
+      name + ".tick",
+      FramePhase::Simulation,
+      SystemAccess(access).write<ObjectType>(),
+      [&arena](const float deltaTime) {
+        tickArena(arena, deltaTime);
+      });
+  }
+
+  if constexpr (PhysTicks<ObjectType>)
+  {
+    scheduler.addSystem(
+      name + ".physTick",
+      FramePhase::Physics,
+      SystemAccess(access).write<ObjectType>(),
+      [&arena](const float deltaTime) {
+        physTickArena(arena, deltaTime);
+      });
+  }
+
+  if constexpr (Draws<ObjectType>)
+  {
+    scheduler.addSystem(
+      name + ".draw",
+      FramePhase::DrawExtraction,
+      SystemAccess(access).read<ObjectType>(),
+      [&arena](float) {
+        drawArena(arena);
+      });
+  }
+}
+
+} // namespace arete::hcs
+
+#endif // ARETE_UPDATE_HPP
@@ -0,0 +1,446 @@
+#ifndef ARETE_WORLD_HPP
+#define ARETE_WORLD_HPP
+
+#include "arete/hcs/hcs.hpp"
+#include "arete/hcs/sparse_index.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace arete::hcs
+{
+
+//! Identifier of a component type.
+using ComponentTypeId = uint32_t;
+
+//! Set of component types, one bit per component type identifier.
+using ComponentMask = uint64_t;
+
+//! Maximum count of component types which can be stored in a world.
+static constexpr ComponentTypeId MaxComponentTypes = std::numeric_limits<ComponentMask>::digits;
+
+//! Type-erased operations of a component type.
+struct ComponentInfo
+{
+  //! Size of the component.
+  size_t size;
+  //! Alignment of the component.
+  size_t alignment;
+  //! Move constructs component at destination from source and destroys the source.
+  void (*relocate)(void* destination, void* source);
+  //! Destroys component.
+  void (*destroy)(void* component);
+
+  //! @returns Info of the component type.
+  template<class Component>
+  static constexpr ComponentInfo of() noexcept
+  {
+    return ComponentInfo{
+      .size = sizeof(Component),
+      .alignment = alignof(Component),
+      .relocate = [](void* destination, void* source) {
+        auto* sourceComponent = static_cast<Component*>(source);
+        std::construct_at(static_cast<Component*>(destination), std::move(*sourceComponent));
+        std::destroy_at(sourceComponent);
+      },
+      .destroy = [](void* component) {
+        std::destroy_at(static_cast<Component*>(component));
+      }};
+  }
+};
+
+//! Registers component type.
+//! @param info Component type info.
+//! @returns Identifier of the component type.
+//! @throws std::length_error if more than MaxComponentTypes were registered.
+ComponentTypeId registerComponentType(const ComponentInfo& info);
+
+//! @returns Info of the registered component type.
+const ComponentInfo& componentInfo(ComponentTypeId type);
+
+//! @returns Identifier of the component type, registering it on first use.
+template<class Component>
+ComponentTypeId componentTypeId()
+{
+  using Type = std::remove_cvref_t<Component>;
+  if constexpr (!std::is_same_v<Type, Component>)
+  {
+    // Qualified types share the identifier of the unqualified type.
+    return componentTypeId<Type>();
+  } else
+  {
+    static const ComponentTypeId type = registerComponentType(ComponentInfo::of<Type>());
+    return type;
+  }
+}
+
+//! @returns Mask of the component types.
+template<class... Components>
+ComponentMask componentMask()
+{
+  return ((ComponentMask{1} << componentTypeId<Components>()) | ... | ComponentMask{0});
+}
+
+//! Archetype.
+//! Stores all actors which have exactly the same set of component types.
+//! Every component type is stored in its own column, columns are co-indexed by rows,
+//! so row N of every column belongs to the actor N.
+class Archetype
+{
+public:
+  //! Constructs archetype for the set of component types.
+  explicit Archetype(ComponentMask mask);
+
+  //! Deleted copy constructor.
+  Archetype(const Archetype& rhs) = delete;
+
+  //! Deleted move constructor.
+  Archetype(Archetype&& rhs) = delete;
+
+  //! Destroys all components and releases the columns.
+  ~Archetype();
+
+  //! @returns Set of component types stored in this archetype.
+  [[nodiscard]] ComponentMask mask() const noexcept
+  {
+    return _mask;
+  }
+
+  //! @returns Count of rows.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _actors.size();
+  }
+
+  //! @returns Packed span of actors, co-indexed with columns.
+  [[nodiscard]] std::span<const ActorHandle> actors() const noexcept
+  {
+    return _actors;
+  }
+
+  //! @returns True if this archetype stores the component type.
+  [[nodiscard]] bool hasComponent(const ComponentTypeId type) const noexcept
+  {
+    return _mask & (ComponentMask{1} << type);
+  }
+
+  //! @returns Pointer to the component at the row.
+  [[nodiscard]] void* component(ComponentTypeId type, size_t row) noexcept;
+
+  template<class Component>
+  //! @returns Pointer to the first component in the column.
+  [[nodiscard]] Component* column() noexcept
+  {
+    return static_cast<Component*>(component(componentTypeId<Component>(), 0));
+  }
+
+  //! Appends row for the actor.
+  //! Components of the row are left uninitialized and must be constructed by the caller.
+  //! @returns Index of the row.
+  size_t appendRow(ActorHandle actor);
+
+  //! Removes the last row, components of which were already destroyed or never constructed.
+  void popRow() noexcept;
+
+  //! Destroys components of the row and moves the last row into its place.
+  //! @returns Actor which was moved into the row, if any.
+  std::optional<ActorHandle> removeRow(size_t row);
+
+  //! Moves row into the row of the target archetype appended by the caller.
+  //! Components shared with the target are relocated, the rest are destroyed.
+  //! Components of the target which are not stored in this archetype must already be constructed.
+  //! @param row Row in this archetype.
+  //! @param target Target archetype.
+  //! @param targetRow Row in the target.
+  //! @returns Actor which was moved into the row of this archetype, if any.
+  std::optional<ActorHandle> moveRow(size_t row, Archetype& target, size_t targetRow);
+
+private:
+  //! Moves the last row into the row, components of which were already destroyed or relocated.
+  std::optional<ActorHandle> fillRow(size_t row);
+
+  //! Grows capacity of all columns.
+  void grow();
+
+private:
+  struct Column
+  {
+    ComponentTypeId type;
+    const ComponentInfo* info;
+    std::byte* data;
+  };
+
+  static constexpr uint8_t InvalidColumn = 0xFF;
+
+  ComponentMask _mask;
+  std::vector<Column> _columns;
+  std::array<uint8_t, MaxComponentTypes> _columnIndex {};
+  std::vector<ActorHandle> _actors;
+  size_t _capacity = 0;
+};
+
+//! Cached set of archetypes matching a query.
+struct QueryCache
+{
+  //! Set of component types required by the query.
+  ComponentMask mask;
+  //! Archetypes which store all required component types.
+  std::vector<Archetype*> archetypes;
+};
+
+//! Query over all actors which have all of the specified components.
+template<class... Components>
+class Query
+{
+public:
+  explicit Query(const QueryCache& cache) noexcept
+    : _cache(cache)
+  {}
+
+  template<typename Callable>
+  //! Invokes the callable with co-indexed spans of each matched archetype.
+  //! @param callable Callable accepting span of actors followed by a span per component.
+  void forEachChunk(Callable&& callable) const
+  {
+    for (auto* archetype: _cache.archetypes)
+    {
+      const size_t size = archetype->size();
+      if (size == 0)
+        continue;
+
+      callable(
+        archetype->actors(),
+        std::span<Components>(
+          archetype->template column<std::remove_const_t<Components>>(), size)...);
+    }
+  }
+
+  template<typename Callable>
+  //! Invokes the callable for each matched actor.
+  //! @param callable Callable accepting reference to each component.
+  void forEach(Callable&& callable) const
+  {
+    forEachChunk([&](std::span<const ActorHandle> actors, std::span<Components>... columns) {
+      for (size_t row = 0; row < actors.size(); ++row)
+        callable(columns[row]...);
+    });
+  }
+
+  //! @returns Count of matched actors.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    size_t count = 0;
+    for (const auto* archetype: _cache.archetypes)
+      count += archetype->size();
+    return count;
+  }
+
+private:
+  const QueryCache& _cache;
+};
+
+//! World.
+//! Stores actors and their components grouped by archetypes.
+class World
+{
+public:
+  //! Sparse index of the actor handles.
+  using ActorHandleIndex = SparseIndex<ActorHandle>;
+
+  //! Default constructor.
+  World();
+
+  //! Deleted copy constructor.
+  World(const World& rhs) = delete;
+
+  //! Deleted move constructor.
+  World(World&& rhs) = delete;
+
+  template<class... Components>
+  //! Creates actor with the components.
+  //! If a component constructor throws, the world is left unchanged.
+  //! @returns Actor handle.
+  //! @throws std::invalid_argument if a component type is specified more than once.
+  ActorHandle createActor(Components&&... components)
+  {
+    const ComponentMask mask = componentMask<Components...>();
+    if (std::popcount(mask) != sizeof...(Components))
+      throw std::invalid_argument("Component type specified more than once.");
+
+    auto& archetype = getOrCreateArchetype(mask);
+    _actorRecords.reserve(_actorRecords.size() + 1);
+    const ActorHandle actor = _actorIndex.insert();
+
+    size_t row = 0;
+    bool appended = false;
+    size_t constructed = 0;
+    try
+    {
+      row = archetype.appendRow(actor);
+      appended = true;
+      ((std::construct_at(
+          static_cast<std::remove_cvref_t<Components>*>(
+            archetype.component(componentTypeId<Components>(), row)),
+          std::forward<Components>(components)),
+        ++constructed),
+       ...);
+    } catch (...)
+    {
+      // Destroy the components constructed so far, the actor is the last row and the last handle.
+      const std::array<ComponentTypeId, sizeof...(Components)> types {componentTypeId<Components>()...};
+      for (size_t index = 0; index < constructed; ++index)
+        componentInfo(types[index]).destroy(archetype.component(types[index], row));
+      if (appended)
+        archetype.popRow();
+      [[maybe_unused]] const auto erasedIndex = _actorIndex.erase(actor);
+      throw;
+    }
+
+    _actorRecords.push_back({&archetype, row});
+    return actor;
+  }
+
+  //! Destroys actor and all of its components.
+  //! @returns True if the actor was destroyed, false if the handle is stale.
+  bool destroyActor(ActorHandle actor);
+
+  //! @returns True if the handle refers to a live actor.
+  [[nodiscard]] bool contains(const ActorHandle actor) const noexcept
+  {
+    return _actorIndex.contains(actor);
+  }
+
+  template<class Component, typename... _Args>
+  //! Adds component to the actor, moving the actor to another archetype.
+  //! Replaces the component if the actor already has it.
+  //! If the component constructor throws, the actor keeps its archetype and components.
+  //! @returns Reference to the component.
+  //! @throws std::invalid_argument if the actor handle is stale.
+  Component& addComponent(const ActorHandle actor, _Args&&... args)
+  {
+    auto& record = actorRecord(actor);
+    const ComponentTypeId type = componentTypeId<Component>();
+    if (record.archetype->hasComponent(type))
+    {
+      auto* component = static_cast<Component*>(record.archetype->component(type, record.row));
+      *component = Component(std::forward<_Args>(args)...);
+      return *component;
+    }
+
+    // Construct the component in the target row first, so a throwing constructor leaves the actor in place.
+    auto& target = getOrCreateArchetype(record.archetype->mask() | (ComponentMask{1} << type));
+    const size_t targetRow = target.appendRow(actor);
+    Component* component = nullptr;
+    try
+    {
+      component = std::construct_at(
+        static_cast<Component*>(target.component(type, targetRow)),
+        std::forward<_Args>(args)...);
+    } catch (...)
+    {
+      target.popRow();
+      throw;
+    }
+
+    moveActor(record, target, targetRow);
+    return *component;
+  }
+
+  template<class Component>
+  //! Removes component from the actor, moving the actor to another archetype.
+  //! @returns True if the component was removed.
+  //! @throws std::invalid_argument if the actor handle is stale.
+  bool removeComponent(const ActorHandle actor)
+  {
+    auto& record = actorRecord(actor);
+    const ComponentTypeId type = componentTypeId<Component>();
+    if (!record.archetype->hasComponent(type))
+      return false;
+
+    auto& target = getOrCreateArchetype(record.archetype->mask() & ~(ComponentMask{1} << type));
+    moveActor(record, target, target.appendRow(actor));
+    return true;
+  }
+
+  template<class Component>
+  //! @returns Pointer to the component of the actor, null if the actor has no such component.
+  [[nodiscard]] Component* getComponent(const ActorHandle actor)
+  {
+    const auto index = _actorIndex.find(actor);
+    if (!index)
+      return nullptr;
+
+    const auto& record = _actorRecords[*index];
+    const ComponentTypeId type = componentTypeId<Component>();
+    if (!record.archetype->hasComponent(type))
+      return nullptr;
+    return static_cast<Component*>(record.archetype->component(type, record.row));
+  }
+
+  template<class... Components>
+  //! Queries all actors which have all of the components.
+  //! Matched archetypes are cached and the cache is updated whenever new archetype is created.
+  //! @returns Query.
+  [[nodiscard]] Query<Components...> query()
+  {
+    return Query<Components...>(queryCache(componentMask<Components...>()));
+  }
+
+  //! @returns Count of live actors.
+  [[nodiscard]] size_t size() const noexcept
+  {
+    return _actorIndex.size();
+  }
+
+  //! @returns Count of archetypes.
+  [[nodiscard]] size_t archetypeCount() const noexcept
+  {
+    return _archetypes.size();
+  }
+
+private:
+  //! Actor record.
+  struct ActorRecord
+  {
+    //! Archetype storing the actor.
+    Archetype* archetype;
+    //! Row of the actor in the archetype.
+    size_t row;
+  };
+
+  //! @returns Record of the actor.
+  //! @throws std::invalid_argument if the actor handle is stale.
+  ActorRecord& actorRecord(ActorHandle actor);
+
+  //! Moves actor to the row of the target archetype and patches records.
+  void moveActor(ActorRecord& record, Archetype& target, size_t targetRow);
+
+  //! @returns Archetype for the set of component types.
+  Archetype& getOrCreateArchetype(ComponentMask mask);
+
+  //! @returns Cache of archetypes matching the set of component types.
+  const QueryCache& queryCache(ComponentMask mask);
+
+private:
+  ActorHandleIndex _actorIndex;
+  std::vector<ActorRecord> _actorRecords;
+
+  std::vector<std::unique_ptr<Archetype>> _archetypes;
+  std::unordered_map<ComponentMask, Archetype*> _archetypesByMask;
+  std::unordered_map<ComponentMask, QueryCache> _queries;
+};
+
+} // namespace arete::hcs
+
+#endif // ARETE_WORLD_HPP
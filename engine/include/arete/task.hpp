@@ -0,0 +1,434 @@
+#ifndef ARETE_TASK_HPP
+#define ARETE_TASK_HPP
+
+#include "arete/threading/job_system.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace arete
+{
+
+template<class Type = void>
+class Task;
+
+//! Largest coroutine frame served by the pools of the task frame resource,
+//! larger frames fall back to the upstream resource.
+static constexpr size_t MaxPooledTaskFrameSize = 4096;
+
+//! @returns Memory resource of coroutine frames of tasks.
+//! Thread-safe pool, so frames of suspended tasks are recycled instead of returned to the heap.
+[[nodiscard]] std::pmr::memory_resource& taskFrameResource() noexcept;
+
+namespace detail
+{
+
+//! Promise state shared by tasks of all result types.
+class TaskPromiseBase
+{
+public:
+  //! Allocates coroutine frame from the task frame resource.
+  static void* operator new(const size_t size)
+  {
+    return taskFrameResource().allocate(size, alignof(std::max_align_t));
+  }
+
+  //! Returns coroutine frame to the task frame resource.
+  static void operator delete(void* frame, const size_t size) noexcept
+  {
+    taskFrameResource().deallocate(frame, size, alignof(std::max_align_t));
+  }
+
+  //! Tasks are lazy, they start once awaited or started.
+  [[nodiscard]] std::suspend_always initial_suspend() const noexcept
+  {
+    return {};
+  }
+
+  //! Resumes the awaiting coroutine once finished.
+  struct FinalAwaiter
+  {
+    [[nodiscard]] bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    template<class Promise>
+    [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) const noexcept
+    {
+      TaskPromiseBase& promise = coroutine.promise();
+      const std::coroutine_handle<> continuation = promise._continuation;
+      promise._finished.store(true, std::memory_order_release);
+      if (continuation)
+        return continuation;
+      return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+  };
+
+  [[nodiscard]] FinalAwaiter final_suspend() const noexcept
+  {
+    return {};
+  }
+
+  void unhandled_exception() noexcept
+  {
+    _exception = std::current_exception();
+  }
+
+  //! Sets the coroutine resumed once the task finished.
+  void continuation(const std::coroutine_handle<> continuation) noexcept
+  {
+    _continuation = continuation;
+  }
+
+  //! @returns True if the task finished.
+  [[nodiscard]] bool finished() const noexcept
+  {
+    return _finished.load(std::memory_order_acquire);
+  }
+
+  //! Rethrows the exception thrown by the task, if any.
+  void rethrow() const
+  {
+    if (_exception)
+      std::rethrow_exception(_exception);
+  }
+
+private:
+  std::coroutine_handle<> _continuation;
+  std::exception_ptr _exception;
+  std::atomic<bool> _finished {false};
+};
+
+template<class Type>
+//! Promise of a task with a result.
+class TaskPromise : public TaskPromiseBase
+{
+public:
+  [[nodiscard]] Task<Type> get_return_object() noexcept;
+
+  template<class Value>
+    requires std::is_convertible_v<Value&&, Type>
+  void return_value(Value&& value)
+  {
+    _result.emplace(std::forward<Value>(value));
+  }
+
+  //! @returns Result of the task.
+  //! @throws Exception thrown by the task.
+  [[nodiscard]] Type& result()
+  {
+    rethrow();
+    return *_result;
+  }
+
+private:
+  std::optional<Type> _result;
+};
+
+template<>
+//! Promise of a task without a result.
+class TaskPromise<void> : public TaskPromiseBase
+{
+public:
+  [[nodiscard]] Task<void> get_return_object() noexcept;
+
+  void return_void() noexcept
+  {
+  }
+
+  //! @throws Exception thrown by the task.
+  void result() const
+  {
+    rethrow();
+  }
+};
+
+} // namespace detail
+
+template<class Type>
+//! Lazily started coroutine producing a value.
+//! Task is started by awaiting it from another task, or by start() from ordinary code.
+//! Once finished, the awaiting task is resumed on the thread which finished the task.
+//! The task owns its coroutine frame, which is drawn from the task frame resource.
+class Task
+{
+public:
+  using promise_type = detail::TaskPromise<Type>;
+
+  //! Constructs empty task.
+  Task() noexcept = default;
+
+  //! Constructs task owning the coroutine.
+  explicit Task(std::coroutine_handle<promise_type> coroutine) noexcept
+    : _coroutine(coroutine)
+  {}
+
+  //! Deleted copy constructor.
+  Task(const Task& rhs) = delete;
+
+  //! Move constructor.
+  Task(Task&& rhs) noexcept
+    : _coroutine(std::exchange(rhs._coroutine, nullptr))
+  {}
+
+  //! Move assignment.
+  Task& operator=(Task&& rhs) noexcept
+  {
+    if (this != &rhs)
+    {
+      destroy();
+      _coroutine = std::exchange(rhs._coroutine, nullptr);
+    }
+    return *this;
+  }
+
+  //! Destroys the coroutine. Task must not be running.
+  ~Task()
+  {
+    destroy();
+  }
+
+  //! Starts the task on the current thread, runs until its first suspension.
+  void start()
+  {
+    _coroutine.resume();
+  }
+
+  //! @returns True if the task finished.
+  [[nodiscard]] bool done() const noexcept
+  {
+    return _coroutine && _coroutine.promise().finished();
+  }
+
+  //! @returns Result of the finished task.
+  //! @throws Exception thrown by the task.
+  decltype(auto) result()
+  {
+    return _coroutine.promise().result();
+  }
+
+  //! Awaiter starting the task and resuming the awaiting coroutine once the task finished.
+  struct Awaiter
+  {
+    std::coroutine_handle<promise_type> coroutine;
+
+    [[nodiscard]] bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    [[nodiscard]] std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) const noexcept
+    {
+      coroutine.promise().continuation(awaiting);
+      return coroutine;
+    }
+
+    decltype(auto) await_resume() const
+    {
+      if constexpr (std::is_void_v<Type>)
+        coroutine.promise().result();
+      else
+        return std::move(coroutine.promise().result());
+    }
+  };
+
+  [[nodiscard]] Awaiter operator co_await() && noexcept
+  {
+    return {_coroutine};
+  }
+
+  [[nodiscard]] Awaiter operator co_await() & noexcept
+  {
+    return {_coroutine};
+  }
+
+private:
+  void destroy() noexcept
+  {
+    if (_coroutine)
+      _coroutine.destroy();
+    _coroutine = nullptr;
+  }
+
+private:
+  std::coroutine_handle<promise_type> _coroutine;
+};
+
+namespace detail
+{
+
+template<class Type>
+Task<Type> TaskPromise<Type>::get_return_object() noexcept
+{
+  return Task<Type>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept
+{
+  return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+//! Resumes the coroutine as a job of the job system.
+//! A system without workers would leave the job waiting until some thread waits on the system,
+//! so the coroutine is not scheduled and is resumed right away by the calling thread instead.
+//! @returns True if the coroutine was scheduled, false if the calling thread resumes it.
+bool resumeAsJob(threading::JobSystem& jobs, std::coroutine_handle<> coroutine);
+
+} // namespace detail
+
+//! Awaiter resuming the awaiting task on a thread of the job system.
+struct JobAwaiter
+{
+  threading::JobSystem& jobs;
+
+  [[nodiscard]] bool await_ready() const noexcept
+  {
+    return false;
+  }
+
+  [[nodiscard]] bool await_suspend(const std::coroutine_handle<> coroutine) const
+  {
+    return detail::resumeAsJob(jobs, coroutine);
+  }
+
+  void await_resume() const noexcept
+  {
+  }
+};
+
+//! Moves the awaiting task to the job system, e.g. before blocking IO or heavy computation.
+//! On a job system without workers the task continues on the awaiting thread.
+//! @param jobs Job system.
+//! @returns Awaiter.
+[[nodiscard]] inline JobAwaiter resumeOn(threading::JobSystem& jobs = threading::JobSystem::shared()) noexcept
+{
+  return {jobs};
+}
+
+//! Waits on the job system until all jobs of the counter finished.
+//! The awaiting task is resumed on a thread of the job system.
+//! @param counter Counter of the jobs.
+//! @param jobs Job system running the jobs.
+Task<> waitFor(const threading::JobCounter& counter, threading::JobSystem& jobs = threading::JobSystem::shared());
+
+//! Reads the whole file on the job system.
+//! The awaiting task is resumed on a thread of the job system.
+//! @param path Path of the file.
+//! @param jobs Job system.
+//! @returns Content of the file.
+//! @throws std::runtime_error If the file could not be read.
+Task<std::vector<uint8_t>> readFile(std::filesystem::path path, threading::JobSystem& jobs = threading::JobSystem::shared());
+
+//! Resumes tasks at frame boundaries.
+//! Tasks wait for the next frame, or poll a condition once per frame, e.g. a GPU fence.
+//! Awaiting is thread-safe, resume() is called by a single thread once per frame.
+class FrameScheduler
+{
+public:
+  //! Awaiter resuming the awaiting task on the next frame.
+  struct FrameAwaiter
+  {
+    FrameScheduler& scheduler;
+
+    [[nodiscard]] bool await_ready() const noexcept
+    {
+      return false;
+    }
+
+    void await_suspend(const std::coroutine_handle<> coroutine) const
+    {
+      scheduler.enqueue({.coroutine = coroutine, .poll = nullptr, .condition = nullptr});
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+  };
+
+  template<class Predicate>
+  //! Awaiter resuming the awaiting task on the first frame the predicate holds.
+  struct ConditionAwaiter
+  {
+    FrameScheduler& scheduler;
+    Predicate predicate;
+
+    [[nodiscard]] bool await_ready()
+    {
+      return predicate();
+    }
+
+    void await_suspend(const std::coroutine_handle<> coroutine)
+    {
+      // The awaiter lives in the suspended coroutine frame, it outlives the waiter.
+      scheduler.enqueue({
+        .coroutine = coroutine,
+        .poll = [](void* condition) {
+          return static_cast<ConditionAwaiter*>(condition)->predicate();
+        },
+        .condition = this});
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+  };
+
+  //! @returns Awaiter resuming the awaiting task on the next frame.
+  [[nodiscard]] FrameAwaiter nextFrame() noexcept
+  {
+    return {*this};
+  }
+
+  template<class Predicate>
+  //! @param predicate Predicate polled once per frame on the thread calling resume(),
+  //!                  e.g. checking the status of a GPU fence.
+  //! @returns Awaiter resuming the awaiting task on the first frame the predicate holds.
+  [[nodiscard]] ConditionAwaiter<std::decay_t<Predicate>> until(Predicate&& predicate)
+  {
+    return {*this, std::forward<Predicate>(predicate)};
+  }
+
+  //! Resumes the tasks waiting for this frame and the tasks whose condition holds.
+  //! Tasks awaiting the next frame while resumed wait for the following call.
+  void resume();
+
+  //! @returns Count of waiting tasks.
+  [[nodiscard]] size_t size() const;
+
+private:
+  //! Suspended task.
+  struct Waiter
+  {
+    std::coroutine_handle<> coroutine;
+    //! Polls the condition, null to resume on the next frame.
+    bool (*poll)(void* condition);
+    void* condition;
+  };
+
+  void enqueue(const Waiter& waiter);
+
+private:
+  mutable std::mutex _mutex;
+  std::vector<Waiter> _waiting;
+  //! Waiters of the frame being resumed, kept to reuse its capacity.
+  std::vector<Waiter> _resuming;
+};
+
+} // namespace arete
+
+#endif // ARETE_TASK_HPP
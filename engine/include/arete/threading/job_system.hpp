@@ -0,0 +1,280 @@
+#ifndef ARETE_JOB_SYSTEM_HPP
+#define ARETE_JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace arete::threading
+{
+
+class JobSystem;
+
+//! Counter of pending jobs.
+//! Jobs started with a counter increment it and decrement it once finished,
+//! waiting on the counter acts as a fan-in point and a dependency between jobs.
+class JobCounter
+{
+public:
+  //! Default constructor.
+  JobCounter() = default;
+
+  //! Deleted copy constructor.
+  JobCounter(const JobCounter& rhs) = delete;
+
+  //! @returns True if all jobs of the counter finished.
+  [[nodiscard]] bool done() const noexcept
+  {
+    return _pending.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+  friend class JobSystem;
+
+  std::atomic<size_t> _pending {0};
+};
+
+//! Job.
+//! Callable is stored in-place, so starting a job does not allocate.
+struct alignas(64) Job
+{
+  //! Size of the in-place callable storage.
+  static constexpr size_t StorageSize = 40;
+
+  //! Invokes and destroys the callable.
+  void (*function)(Job& job);
+  //! Counter decremented once the job finished.
+  JobCounter* counter;
+  //! Storage of the callable.
+  alignas(std::max_align_t) std::byte storage[StorageSize];
+  //! Whether the job was started and did not finish yet, the job may not be reused until then.
+  std::atomic<bool> inFlight {false};
+};
+
+//! Bounded work-stealing deque of jobs.
+//! The owner pushes and pops jobs at the bottom, other threads steal jobs from the top.
+//! Follows the Chase-Lev deque with the memory orderings of Lê et al.
+class JobDeque
+{
+public:
+  //! Capacity of the deque.
+  static constexpr size_t Capacity = 4096;
+
+  //! Pushes job to the bottom. Owner only.
+  //! @returns False if the deque is full.
+  bool push(Job* job) noexcept;
+
+  //! Pops job from the bottom. Owner only.
+  //! @returns Job, or null if the deque is empty.
+  [[nodiscard]] Job* pop() noexcept;
+
+  //! Steals job from the top. Any thread.
+  //! @returns Job, or null if the deque is empty or the steal lost a race.
+  [[nodiscard]] Job* steal() noexcept;
+
+private:
+  static constexpr size_t Mask = Capacity - 1;
+
+  alignas(64) std::atomic<int64_t> _top {0};
+  alignas(64) std::atomic<int64_t> _bottom {0};
+  alignas(64) std::array<std::atomic<Job*>, Capacity> _jobs {};
+};
+
+//! Work-stealing job system.
+//! Every worker thread owns a deque of jobs and a pool of job storage,
+//! idle workers steal jobs from the other deques.
+//! Threads waiting for a counter execute pending jobs instead of blocking,
+//! so jobs may start and wait for other jobs.
+//!
+//! Threads outside of the system share a single context guarded by a mutex,
+//! so system of N threads owns N - 1 worker threads.
+class JobSystem
+{
+public:
+  //! Count of jobs in the job pool of every thread.
+  //! Jobs started while all jobs of the pool are in flight are invoked right away.
+  static constexpr size_t JobPoolSize = JobDeque::Capacity;
+
+  //! Constructs job system.
+  //! @param threadCount Count of threads executing jobs, including the thread outside of the system.
+  //! @param pinThreads Whether to pin the worker threads to physical cores.
+  explicit JobSystem(size_t threadCount = physicalCoreCount(), bool pinThreads = true);
+
+  //! Deleted copy constructor.
+  JobSystem(const JobSystem& rhs) = delete;
+
+  //! Deleted move constructor.
+  JobSystem(JobSystem&& rhs) = delete;
+
+  //! Stops and joins the worker threads.
+  //! All started jobs must be finished.
+  ~JobSystem();
+
+  //! @returns Count of threads executing jobs, including the thread outside of the system.
+  [[nodiscard]] size_t threadCount() const noexcept
+  {
+    return _contexts.size();
+  }
+
+  template<typename Callable>
+  //! Starts job.
+  //! Callable is invoked once on any thread of the system and must not throw.
+  //! @param counter Counter incremented until the job finishes.
+  //! @param callable Callable without arguments, at most Job::StorageSize bytes.
+  void run(JobCounter& counter, Callable&& callable)
+  {
+    using CallableType = std::decay_t<Callable>;
+    static_assert(sizeof(CallableType) <= Job::StorageSize, "Job callable is too large, capture by reference.");
+    static_assert(alignof(CallableType) <= alignof(std::max_align_t), "Job callable is over-aligned.");
+
+    Context& context = currentContext();
+    std::unique_lock lock = lockContext(context);
+
+    Job* job = allocateJob(context);
+    if (job == nullptr)
+    {
+      // All jobs of the pool are in flight, invoke the callable right away.
+      lock = {};
+      callable();
+      return;
+    }
+
+    job->counter = &counter;
+    std::construct_at(reinterpret_cast<CallableType*>(job->storage), std::forward<Callable>(callable));
+    job->function = [](Job& job) {
+      auto* typedCallable = std::launder(reinterpret_cast<CallableType*>(job.storage));
+      (*typedCallable)();
+      std::destroy_at(typedCallable);
+    };
+
+    counter._pending.fetch_add(1, std::memory_order_relaxed);
+    if (!context.deque.push(job))
+    {
+      // Deque is full, execute the job right away.
+      lock = {};
+      execute(job);
+      return;
+    }
+    lock = {};
+    wake();
+  }
+
+  //! Waits until all jobs of the counter finished.
+  //! Executes pending jobs while waiting.
+  void wait(const JobCounter& counter) noexcept;
+
+  template<typename Callable>
+  //! Executes task for every index in range [0, taskCount) and waits for completion.
+  //! Tasks are distributed dynamically over a job per thread.
+  //! May be called from within a job. Tasks must not throw.
+  //! @param taskCount Count of tasks.
+  //! @param callable Callable accepting index of the task.
+  void parallelFor(const size_t taskCount, Callable&& callable)
+  {
+    if (taskCount == 0)
+      return;
+
+    std::atomic<size_t> nextTask {0};
+    const auto runTasks = [&nextTask, &callable, taskCount]() {
+      for (size_t taskIndex = nextTask.fetch_add(1, std::memory_order_relaxed);
+           taskIndex < taskCount;
+           taskIndex = nextTask.fetch_add(1, std::memory_order_relaxed))
+      {
+        callable(taskIndex);
+      }
+    };
+
+    JobCounter counter;
+    const size_t jobCount = std::min(taskCount, threadCount()) - 1;
+    for (size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+      run(counter, runTasks);
+
+    runTasks();
+    wait(counter);
+  }
+
+  //! @returns Index of the current thread within its job system, 0 for threads outside of any system.
+  [[nodiscard]] static size_t currentThreadIndex() noexcept;
+
+  //! @returns Index of the current thread within this system, 0 for threads outside of this system.
+  [[nodiscard]] size_t localThreadIndex() const noexcept;
+
+  //! @returns Count of physical cores available to the process.
+  [[nodiscard]] static size_t physicalCoreCount();
+
+  //! @returns Engine-wide job system using all physical cores.
+  [[nodiscard]] static JobSystem& shared();
+
+private:
+  //! Context of a thread executing jobs.
+  struct Context
+  {
+    JobDeque deque;
+    std::unique_ptr<Job[]> jobs = std::make_unique<Job[]>(JobPoolSize);
+    size_t nextJob = 0;
+  };
+
+  //! @returns Context of the current thread.
+  [[nodiscard]] Context& currentContext() noexcept;
+
+  //! Locks the context if it is shared by the threads outside of the system.
+  [[nodiscard]] std::unique_lock<std::mutex> lockContext(const Context& context)
+  {
+    if (&context == _contexts.front().get())
+      return std::unique_lock(_externalMutex);
+    return {};
+  }
+
+  //! Finds job of the context pool which is not in flight.
+  //! @returns Job marked as in flight, or null if all jobs are in flight.
+  [[nodiscard]] static Job* allocateJob(Context& context) noexcept
+  {
+    for (size_t attempt = 0; attempt < JobPoolSize; ++attempt)
+    {
+      Job& job = context.jobs[context.nextJob++ % JobPoolSize];
+      if (!job.inFlight.load(std::memory_order_acquire))
+      {
+        job.inFlight.store(true, std::memory_order_relaxed);
+        return &job;
+      }
+    }
+    return nullptr;
+  }
+
+  //! Pops job of the current thread or steals job of another thread.
+  //! @returns Job, or null if there is none.
+  [[nodiscard]] Job* findJob(Context& context) noexcept;
+
+  //! Executes job and signals its counter.
+  static void execute(Job* job) noexcept;
+
+  //! Wakes an idle worker.
+  void wake() noexcept;
+
+  //! Worker thread loop.
+  void workerLoop(size_t threadIndex) noexcept;
+
+private:
+  std::vector<std::unique_ptr<Context>> _contexts;
+  std::vector<std::thread> _workers;
+
+  //! Guards the context shared by the threads outside of the system.
+  std::mutex _externalMutex;
+
+  //! Bumped whenever a job is started, idle workers wait for a change.
+  std::atomic<uint32_t> _wakeEpoch {0};
+  std::atomic<bool> _stopping {false};
+};
+
+} // namespace arete::threading
+
+#endif // ARETE_JOB_SYSTEM_HPP
@@ -0,0 +1,97 @@
+#ifndef ARETE_TRIPLE_BUFFER_HPP
+#define ARETE_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace arete::threading
+{
+
+template<class Type>
+//! Triple buffer handing values over from a single producer thread to a single consumer thread.
+//! The producer owns the back slot and the consumer owns the front slot, the third slot holds
+//! the latest published value. Neither side ever waits for the other to finish with its slot,
+//! the consumer always gets the latest value and values published in between are skipped.
+class TripleBuffer
+{
+public:
+  //! Constructs triple buffer with all slots holding the value.
+  //! @param value Initial value.
+  explicit TripleBuffer(const Type& value = {})
+  {
+    for (auto& slot: _slots)
+      slot.value = value;
+  }
+
+  //! Deleted copy constructor.
+  TripleBuffer(const TripleBuffer& rhs) = delete;
+
+  //! @returns Value owned by the producer. Producer only.
+  [[nodiscard]] Type& back() noexcept
+  {
+    return _slots[_back].value;
+  }
+
+  //! Publishes the back value and hands the producer a stale slot. Producer only.
+  //! The previous back value is not reachable by the producer anymore.
+  void publish() noexcept
+  {
+    // Release the back slot to the consumer, acquire the slot the consumer released.
+    const uint8_t previous = _middle.exchange(
+      static_cast<uint8_t>(_back | FreshBit),
+      std::memory_order_acq_rel);
+    _back = previous & IndexMask;
+    _middle.notify_one();
+  }
+
+  //! Takes the latest published value, if any. Consumer only.
+  //! @returns True if a value was published since the last acquire.
+  bool acquire() noexcept
+  {
+    if ((_middle.load(std::memory_order_relaxed) & FreshBit) == 0)
+      return false;
+
+    const uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+    _front = previous & IndexMask;
+    return true;
+  }
+
+  //! Blocks until a value is published since the last acquire. Consumer only.
+  void wait() const noexcept
+  {
+    for (uint8_t middle = _middle.load(std::memory_order_acquire);
+         (middle & FreshBit) == 0;
+         middle = _middle.load(std::memory_order_acquire))
+    {
+      _middle.wait(middle, std::memory_order_acquire);
+    }
+  }
+
+  //! @returns Value owned by the consumer, the latest acquired. Consumer only.
+  [[nodiscard]] const Type& front() const noexcept
+  {
+    return _slots[_front].value;
+  }
+
+private:
+  //! Slot on its own cache line, so the producer and the consumer do not share one.
+  struct alignas(64) Slot
+  {
+    Type value;
+  };
+
+  static constexpr uint8_t IndexMask = 0b011;
+  //! Set in the middle index while the middle slot holds a value not acquired yet.
+  static constexpr uint8_t FreshBit = 0b100;
+
+  std::array<Slot, 3> _slots;
+
+  alignas(64) uint8_t _back = 0;
+  alignas(64) std::atomic<uint8_t> _middle {1};
+  alignas(64) uint8_t _front = 2;
+};
+
+} // namespace arete::threading
+
+#endif // ARETE_TRIPLE_BUFFER_HPP
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 namespace arete {
 
@@ -11,24 +12,84 @@ class TickClock
     float deltaTime;
   };
 
+  //! Fixed steps due in a frame.
+  struct FixedStep {
+    //! Count of steps to run, at most the max step count.
+    uint32_t stepCount;
+    //! Time delta of every step in seconds.
+    float stepDelta;
+    //! Progress towards the next step in range [0, 1),
+    //! used to interpolate between the previous and the current step state.
+    float alpha;
+    //! Count of steps dropped to stay within the max step count.
+    uint32_t droppedStepCount;
+  };
+
+  //! Frame pacing statistics of waitForTick.
+  struct PacingStats {
+    //! Count of paced ticks.
+    uint64_t tickCount;
+    //! Target tick period in seconds.
+    float targetPeriod;
+    //! Mean achieved tick period in seconds.
+    float meanPeriod;
+    //! Mean absolute difference of the wake-up time from the target time in seconds.
+    float meanJitter;
+    //! Max absolute difference of the wake-up time from the target time in seconds.
+    float maxJitter;
+  };
+
 public:
   using Clock = std::chrono::steady_clock;
 
 public:
   //! Constructs tick clock.
-  //! @param tickPeriod Tick period [T].
-  explicit TickClock(float tickPeriod);
+  //! @param tickRate Tick rate [Hz], 0 ticks on every call.
+  //! @param maxStepCount Max count of fixed steps per frame,
+  //!                     time beyond is dropped to prevent the simulation from falling behind for good.
+  explicit TickClock(float tickRate, uint32_t maxStepCount = 8);
 
   //! Performs tick.
-  //! @returns Tick information.
+  //! Time left over after a tick counts towards the next tick.
+  //! @returns Tick information, a tick reports the time of a single period.
   Tick tick() noexcept;
 
+  //! Sleeps until the next tick is due and performs it.
+  //! Sleeps coarsely and spins for the last stretch, which is calibrated to the sleep overshoot of the system.
+  //! Without a tick rate, ticks right away.
+  //! @returns Tick information, always ticking.
+  Tick waitForTick() noexcept;
+
+  //! @returns Frame pacing statistics of waitForTick.
+  [[nodiscard]] PacingStats pacingStats() const noexcept;
+
+  //! Calibrates the spin threshold on the first call.
+  //! @returns Time before a deadline spent spinning instead of sleeping.
+  [[nodiscard]] static Clock::duration spinThreshold() noexcept;
+
+  //! Accumulates time since the last call and consumes it in fixed steps.
+  //! @returns Fixed steps to run.
+  FixedStep fixedStep() noexcept;
+
+  //! Resets accumulated time, e.g. after a load.
+  void reset() noexcept;
+
 private:
   Clock::time_point curentTickTime;
   Clock::time_point lastTickTime;
 
   float tickTimeDelta = 0;
-  float tickPeriod = 0;
+  float tickRate = 0;
+
+  Clock::duration stepPeriod {};
+  Clock::duration stepAccumulator {};
+  uint32_t maxStepCount = 0;
+
+  Clock::time_point nextPacedTickTime;
+  Clock::time_point firstPacedTickTime;
+  uint64_t pacedTickCount = 0;
+  double pacingJitterSum = 0;
+  double pacingJitterMax = 0;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,183 @@
+#ifndef ARETE_TLSF_HPP
+#define ARETE_TLSF_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace arete
+{
+
+//! Two-level segregated fit allocator of ranges of an address space it does not access.
+//! Bookkeeping is kept apart from the managed space, so it suballocates memory
+//! the processor cannot read, such as device memory.
+//!
+//! Free ranges are kept in lists by size class, the first level is the power of two
+//! of the size and the second level splits it into 32 linear classes.
+//! Bitmasks of the non-empty lists find a free range large enough for a request
+//! in constant time, allocation and free do not depend on the count of ranges.
+//! Freed ranges are merged with their free neighbors immediately.
+class TlsfAllocator
+{
+public:
+  //! Offset or size in the address space.
+  using Size = uint64_t;
+  //! Index of a range.
+  using RangeIndex = uint32_t;
+
+  //! Index of no range.
+  static constexpr RangeIndex NoRange = std::numeric_limits<RangeIndex>::max();
+
+  //! Allocated range.
+  struct Allocation
+  {
+    Size offset;
+    Size size;
+    //! Range holding the allocation, identifies it when freed.
+    RangeIndex range;
+  };
+
+  //! Usage statistics.
+  struct Stats
+  {
+    Size capacity = 0;
+    Size usedSize = 0;
+    //! Size of the largest free range.
+    Size largestFreeSize = 0;
+    size_t allocationCount = 0;
+    size_t freeRangeCount = 0;
+
+    //! @returns Size of the free space.
+    [[nodiscard]] Size freeSize() const noexcept
+    {
+      return capacity - usedSize;
+    }
+
+    //! @returns Share of the free space outside of the largest free range, in range [0, 1].
+    //!          Zero when the free space is a single range.
+    [[nodiscard]] float fragmentation() const noexcept
+    {
+      const Size free = freeSize();
+      return free == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeSize) / static_cast<float>(free);
+    }
+  };
+
+  //! Constructs allocator of free space.
+  //! @param capacity Size of the address space.
+  //! @param resource Memory resource of the bookkeeping, must outlive the allocator.
+  //! @throws std::invalid_argument if the capacity is zero.
+  explicit TlsfAllocator(
+    Size capacity,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  //! Allocates range.
+  //! @param size Size of the range.
+  //! @param alignment Alignment of the offset, power of two.
+  //! @returns Allocated range, or nothing if no free range fits the request.
+  //! @throws std::invalid_argument if the size is zero or the alignment is not a power of two.
+  [[nodiscard]] std::optional<Allocation> allocate(Size size, Size alignment = 1);
+
+  //! Frees range.
+  //! @throws std::invalid_argument if the range is not allocated.
+  void free(const Allocation& allocation);
+
+  //! @returns Usage statistics.
+  [[nodiscard]] Stats stats() const noexcept;
+
+  //! @returns Size of the address space.
+  [[nodiscard]] Size capacity() const noexcept
+  {
+    return _capacity;
+  }
+
+  //! @returns Size of the allocated ranges, padding of their alignment stays free.
+  [[nodiscard]] Size usedSize() const noexcept
+  {
+    return _usedSize;
+  }
+
+  //! @returns True if nothing is allocated.
+  [[nodiscard]] bool empty() const noexcept
+  {
+    return _allocationCount == 0;
+  }
+
+private:
+  //! Bits of the second level index.
+  static constexpr uint32_t SecondLevelBits = 5;
+  //! Count of second level classes of every first level class.
+  static constexpr uint32_t SecondLevelCount = 1u << SecondLevelBits;
+  //! Count of first level classes, the first class holds sizes below SecondLevelCount.
+  static constexpr uint32_t FirstLevelCount = 64 - SecondLevelBits + 1;
+
+  //! Range of the address space, free or allocated.
+  struct Range
+  {
+    Size offset;
+    Size size;
+    //! Ranges adjacent in the address space.
+    RangeIndex previous;
+    RangeIndex next;
+    //! Ranges of the same free list.
+    RangeIndex previousFree;
+    RangeIndex nextFree;
+    bool free;
+  };
+
+  //! Size class of a free list.
+  struct SizeClass
+  {
+    uint32_t firstLevel;
+    uint32_t secondLevel;
+  };
+
+  //! @returns Class of the list the range of the size is stored in.
+  [[nodiscard]] static SizeClass classOf(Size size) noexcept;
+
+  //! @returns Non-empty class whose every range holds at least the size, or nothing.
+  [[nodiscard]] std::optional<SizeClass> findClass(Size size) const noexcept;
+
+  //! @returns Free range fitting the size at the alignment, or NoRange.
+  //!          Ranges in the classes the request might fit are tested only if no class
+  //!          guarantees a fit, which happens when the space is nearly full.
+  [[nodiscard]] RangeIndex findRange(Size size, Size alignment) const noexcept;
+
+  //! @returns New range.
+  [[nodiscard]] RangeIndex createRange(Size offset, Size size, RangeIndex previous, RangeIndex next);
+
+  //! Releases the range for reuse.
+  void destroyRange(RangeIndex range);
+
+  //! Marks the range free and inserts it at the head of its free list.
+  void insertFree(RangeIndex range) noexcept;
+
+  //! Removes the range from its free list and marks it allocated.
+  void removeFree(RangeIndex range) noexcept;
+
+  //! Merges the next range into the range.
+  void mergeNext(RangeIndex range);
+
+private:
+  Size _capacity;
+  Size _usedSize = 0;
+  size_t _allocationCount = 0;
+  size_t _freeRangeCount = 0;
+
+  //! Bit set for every first level class with a non-empty list.
+  uint64_t _firstLevelMask = 0;
+  //! Bit set for every second level class with a non-empty list, by first level.
+  std::array<uint32_t, FirstLevelCount> _secondLevelMasks {};
+  //! Head of the free list of every class.
+  std::array<std::array<RangeIndex, SecondLevelCount>, FirstLevelCount> _freeLists;
+
+  std::pmr::vector<Range> _ranges;
+  std::pmr::vector<RangeIndex> _rangeFreeList;
+};
+
+} // namespace arete
+
+#endif // ARETE_TLSF_HPP
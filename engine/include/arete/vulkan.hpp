@@ -2,6 +2,11 @@
 #define ARETE_VULKAN_HPP
 
 #include "arete/engine.hpp"
+#include "arete/hcs/culling.hpp"
+#include "arete/hcs/scheduler.hpp"
+#include "arete/hcs/transform_hierarchy.hpp"
+#include "arete/task.hpp"
+#include "arete/vulkan_memory.hpp"
 
 #define VULKAN_HPP_NO_CONSTRUCTORS
 
@@ -14,6 +19,7 @@
 
 #include <string_view>
 #include <array>
+#include <chrono>
 #include <vector>
 #include <optional>
 
@@ -52,6 +58,17 @@ struct PushConstants
   float time;
 };
 
+//! State of a frame handed over from the simulation to the rendering.
+//! Rendering reads nothing else written by the simulation.
+struct FrameState
+{
+  PushConstants pushConstants;
+  //! Meshes in the view frustum, in ascending order.
+  std::vector<uint32_t> visibleMeshes;
+  //! Statistics of the culling of the frame.
+  hcs::CullingStats culling;
+};
+
 // struct PushConstantsCore
 // {
 //   float time;
@@ -81,16 +98,16 @@ struct VulkanMesh
 {
   MeshHandle _mesh { 0 };
   vkr::Buffer _vertexBuffer { nullptr };
-  vkr::DeviceMemory _vertexBufferMemory { nullptr };
+  VulkanAllocation _vertexBufferMemory;
   vkr::Buffer _indexBuffer { nullptr };
-  vkr::DeviceMemory _indexBufferMemory { nullptr };
+  VulkanAllocation _indexBufferMemory;
 
   void indexBuffer(const vkr::Device& device,
-                   const vkr::PhysicalDevice& physicalDevice,
+                   VulkanMemoryAllocator& memory,
                    const Mesh& mesh);
 
   void vertexBuffer(const vkr::Device& device,
-                    const vkr::PhysicalDevice& physicalDevice,
+                    VulkanMemoryAllocator& memory,
                     const Mesh& mesh);
 };
 
@@ -147,6 +164,9 @@ public:
   vkr::PhysicalDevice _physicalDevice { nullptr };
   vkr::Device _device { nullptr };
 
+  //! Device memory of the resources, created with the device and released before it.
+  std::optional<arete::VulkanMemoryAllocator> _memory;
+
   arete::VulkanMesh _mesh;
 
   vkr::Queue _graphicsQueue { nullptr };
@@ -158,9 +178,9 @@ public:
   vkr::Image _depthImage { nullptr };
   vk::Format _depthImageFormat {};
   vkr::ImageView _depthImageView { nullptr };
-  vkr::DeviceMemory _depthMemory { nullptr };
+  arete::VulkanAllocation _depthMemory;
 
-  vkr::DeviceMemory _uniformBufferMemory { nullptr };
+  arete::VulkanAllocation _uniformBufferMemory;
   vkr::Buffer _uniformBuffer { nullptr };
 
   vkr::DescriptorSetLayout _uniformDescriptorLayout { nullptr };
@@ -215,29 +235,38 @@ class InFlightRendering
 {
 public:
   explicit InFlightRendering(
-    const VulkanRenderer& renderer,
-    const VulkanEngine& engine);
+    const VulkanRenderer& renderer);
 
   ~InFlightRendering();
   /**
    * Draws frame.
+   * @param frame State of the frame.
    */
-  void draw();
+  void draw(const arete::FrameState& frame);
 
 private:
   /**
    * Renders image in swapchain.
+   * @param frame State of the frame.
    */
-  void render();
+  void render(const arete::FrameState& frame);
 
   /**
    * Presents rendered image to surface.
    */
   void present();
 
+  /**
+   * Accumulates culling statistics of the frame, printing their average once per report interval.
+   * @param culling Culling statistics of the frame.
+   */
+  void reportCulling(const hcs::CullingStats& culling);
+
 private:
+  //! Interval between the reports of the culling statistics.
+  static constexpr std::chrono::seconds CullingReportInterval {5};
+
   const VulkanRenderer& _renderer;
-  const VulkanEngine& _engine;
 
   std::array<vkr::Semaphore, MaxFramesInFlight> _imageAvailableSemaphores
     {
@@ -259,6 +288,11 @@ private:
 private:
   uint32_t _inFlightFrameIndex = 0;
   uint32_t _currentImageIndex = 0;
+
+  //! Culling statistics summed over the frames since the last report.
+  hcs::CullingStats _culling;
+  size_t _cullingFrameCount = 0;
+  std::chrono::steady_clock::time_point _cullingReportTime = std::chrono::steady_clock::now();
 };
 
 class VulkanEngine :
@@ -288,6 +322,22 @@ public:
   arete::ShaderMatrices _shaderMatrices;
   // arete::PushConstantsCore _pushConstantsCore;
 
+  //! Systems run on every fixed physics step.
+  arete::hcs::Scheduler _scheduler;
+
+  //! Transforms of the scene, updated on every fixed physics step.
+  arete::hcs::TransformHierarchy _transforms;
+
+  //! Tasks resumed on the simulation thread once per frame.
+  arete::FrameScheduler _frameTasks;
+
+  //! Culls the meshes outside of the camera frustum before every frame is handed to the rendering.
+  arete::hcs::FrustumCuller _culler;
+
+  //! Whether frames are rendered on a separate thread while the next frame is simulated.
+  //! Otherwise the simulation waits for the rendering of every frame.
+  bool _pipelinedRendering = true;
+
   VulkanRenderer _renderer;
   Display _display;
 
@@ -0,0 +1,220 @@
+#ifndef ARETE_VULKAN_MEMORY_HPP
+#define ARETE_VULKAN_MEMORY_HPP
+
+#include "arete/tlsf.hpp"
+
+#define VULKAN_HPP_NO_CONSTRUCTORS
+
+#include <vulkan/vulkan_raii.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace arete
+{
+
+namespace vkr = vk::raii;
+
+class VulkanMemoryAllocator;
+
+//! Kind of a resource bound to device memory.
+//! Linear and optimal resources must not share a page of the buffer image granularity.
+enum class VulkanResourceKind
+{
+  //! Buffers and images with linear tiling.
+  Linear,
+  //! Images with optimal tiling.
+  Optimal,
+};
+
+//! Range of device memory suballocated from a block of the allocator.
+//! Returns the range to the allocator when destroyed, so it must not outlive the allocator.
+class VulkanAllocation
+{
+public:
+  VulkanAllocation() = default;
+  VulkanAllocation(VulkanAllocation&& other) noexcept;
+  VulkanAllocation& operator=(VulkanAllocation&& other) noexcept;
+  VulkanAllocation(const VulkanAllocation&) = delete;
+  VulkanAllocation& operator=(const VulkanAllocation&) = delete;
+  ~VulkanAllocation();
+
+  //! Returns the range to the allocator.
+  void reset() noexcept;
+
+  //! @returns Device memory of the block holding the range.
+  [[nodiscard]] vk::DeviceMemory memory() const noexcept
+  {
+    return _memory;
+  }
+
+  //! @returns Offset of the range in the device memory.
+  [[nodiscard]] vk::DeviceSize offset() const noexcept
+  {
+    return _range.offset;
+  }
+
+  //! @returns Size of the range.
+  [[nodiscard]] vk::DeviceSize size() const noexcept
+  {
+    return _range.size;
+  }
+
+  //! @returns Host address of the range, or nullptr if the memory is not host visible.
+  //!          Host visible blocks stay mapped for their whole lifetime.
+  [[nodiscard]] void* mapped() const noexcept
+  {
+    return _mapped;
+  }
+
+  //! @returns True if the allocation holds a range.
+  explicit operator bool() const noexcept
+  {
+    return _allocator != nullptr;
+  }
+
+private:
+  friend class VulkanMemoryAllocator;
+
+  VulkanMemoryAllocator* _allocator = nullptr;
+  vk::DeviceMemory _memory {};
+  void* _mapped = nullptr;
+  TlsfAllocator::Allocation _range {};
+  uint32_t _pool = 0;
+  uint32_t _block = 0;
+};
+
+//! Memory usage of a device memory heap.
+struct VulkanHeapStats
+{
+  //! Size of the heap reported by the device.
+  vk::DeviceSize heapSize = 0;
+  //! Size of the device memory blocks allocated from the heap.
+  vk::DeviceSize blockSize = 0;
+  //! Size of the ranges allocated from the blocks.
+  vk::DeviceSize usedSize = 0;
+  //! Size of the largest free range of a single block.
+  vk::DeviceSize largestFreeSize = 0;
+  uint32_t blockCount = 0;
+  size_t allocationCount = 0;
+
+  //! @returns Share of the free space of the blocks outside of the largest free range, in range [0, 1].
+  [[nodiscard]] float fragmentation() const noexcept
+  {
+    const vk::DeviceSize freeSize = blockSize - usedSize;
+    return freeSize == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeSize) / static_cast<float>(freeSize);
+  }
+};
+
+//! Suballocates device memory for the resources of the renderer.
+//! Devices limit the count of device memory allocations, often to 4096, so resources are
+//! placed in large blocks allocated per memory type, each managed by a TlsfAllocator.
+//! Resources larger than half of a block get a block of their own, sized to the resource
+//! rounded up to its alignment and the buffer-image granularity.
+//!
+//! Linear and optimal resources are kept in separate blocks if the device has a buffer image
+//! granularity larger than 1, so they never share its page regardless of their alignment.
+//! Host visible blocks are mapped once when allocated, resources are written through their mapping.
+//! Blocks left empty are released, except for the last block of every memory type.
+class VulkanMemoryAllocator
+{
+public:
+  //! Default size of a block.
+  static constexpr vk::DeviceSize DefaultBlockSize = vk::DeviceSize {64} << 20;
+
+  //! Constructs allocator.
+  //! @param device Logical device, must outlive the allocator.
+  //! @param physicalDevice Physical device of the logical device.
+  //! @param blockSize Size of a block, lowered to an eighth of smaller heaps.
+  VulkanMemoryAllocator(
+    const vkr::Device& device,
+    const vkr::PhysicalDevice& physicalDevice,
+    vk::DeviceSize blockSize = DefaultBlockSize);
+
+  VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+  VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+
+  //! Allocates memory.
+  //! @param requirements Memory requirements of the resource.
+  //! @param flags Properties the memory must have.
+  //! @param kind Kind of the resource.
+  //! @returns Allocated range.
+  //! @throws std::runtime_error if no memory type satisfies the requirements.
+  //! @throws vk::SystemError if the device memory ran out.
+  [[nodiscard]] VulkanAllocation allocate(
+    const vk::MemoryRequirements& requirements,
+    vk::MemoryPropertyFlags flags,
+    VulkanResourceKind kind);
+
+  //! Allocates memory for the buffer and binds it.
+  //! @returns Allocated range.
+  //! @throws std::runtime_error if no memory type satisfies the requirements.
+  //! @throws vk::SystemError if the device memory ran out.
+  [[nodiscard]] VulkanAllocation bind(const vkr::Buffer& buffer, vk::MemoryPropertyFlags flags);
+
+  //! Allocates memory for the image and binds it.
+  //! @param tiling Tiling the image was created with.
+  //! @returns Allocated range.
+  //! @throws std::runtime_error if no memory type satisfies the requirements.
+  //! @throws vk::SystemError if the device memory ran out.
+  [[nodiscard]] VulkanAllocation bind(
+    const vkr::Image& image,
+    vk::ImageTiling tiling,
+    vk::MemoryPropertyFlags flags);
+
+  //! @returns Memory usage of every heap, indexed by heap.
+  [[nodiscard]] std::vector<VulkanHeapStats> heapStats() const;
+
+  //! @returns Count of the device memory allocations of the blocks.
+  [[nodiscard]] uint32_t deviceAllocationCount() const;
+
+private:
+  friend class VulkanAllocation;
+
+  //! Device memory block.
+  struct Block
+  {
+    vkr::DeviceMemory memory;
+    TlsfAllocator ranges;
+    //! Host address of the block, or nullptr if the memory is not host visible.
+    void* mapped;
+  };
+
+  //! Blocks of a memory type holding a kind of resources.
+  struct Pool
+  {
+    uint32_t memoryType;
+    //! Blocks, released blocks are left empty for reuse of their index.
+    std::vector<std::unique_ptr<Block>> blocks;
+  };
+
+  //! @returns Index of the first memory type satisfying the requirements.
+  //! @throws std::runtime_error if no memory type satisfies the requirements.
+  [[nodiscard]] uint32_t memoryTypeOf(
+    const vk::MemoryRequirements& requirements,
+    vk::MemoryPropertyFlags flags) const;
+
+  //! @returns Size of the blocks allocated from the heap of the memory type.
+  [[nodiscard]] vk::DeviceSize blockSizeOf(uint32_t memoryType) const noexcept;
+
+  //! Returns the range of the allocation to its block.
+  void free(const VulkanAllocation& allocation) noexcept;
+
+private:
+  const vkr::Device* _device;
+  vk::PhysicalDeviceMemoryProperties _memoryProperties;
+  vk::DeviceSize _bufferImageGranularity;
+  vk::DeviceSize _blockSize;
+
+  //! Pools of linear and optimal resources of every memory type.
+  std::vector<Pool> _pools;
+  uint32_t _deviceAllocationCount = 0;
+  mutable std::mutex _mutex;
+};
+
+} // namespace arete
+
+#endif // ARETE_VULKAN_MEMORY_HPP
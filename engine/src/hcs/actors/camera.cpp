@@ -1,5 +1,5 @@
 #include "arete/hcs/actors/camera.hpp"
-#include "arete/components/spatial.hpp"
+#include "arete/hcs/components/spatial.hpp"
 
 namespace arete {
 
@@ -0,0 +1,255 @@
+#include "arete/hcs/culling.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ARETE_CULLING_X86
+#include <immintrin.h>
+#endif
+
+namespace arete::hcs
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+//! Culls the spheres in range [begin, end) one at a time.
+//! @returns Count of the visible spheres written.
+uint32_t cullScalar(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  const size_t begin,
+  const size_t end,
+  uint32_t* visible) noexcept
+{
+  uint32_t count = 0;
+  for (size_t i = begin; i < end; ++i)
+  {
+    const Sphere sphere {
+      .center = glm::vec3(spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]),
+      .radius = spheres.radius[i]};
+    if (frustum.intersects(sphere))
+      visible[count++] = static_cast<uint32_t>(i);
+  }
+  return count;
+}
+
+#if defined(ARETE_CULLING_X86)
+
+//! Lanes of the visible spheres for every mask of 8 spheres, packed 3 bits per lane.
+constexpr std::array<uint32_t, 256> CompressLanes = []() {
+  std::array<uint32_t, 256> lanes {};
+  for (uint32_t mask = 0; mask < 256; ++mask)
+  {
+    uint32_t packed = 0;
+    uint32_t position = 0;
+    for (uint32_t lane = 0; lane < 8; ++lane)
+    {
+      if ((mask & (1u << lane)) != 0)
+        packed |= lane << (3 * position++);
+    }
+    lanes[mask] = packed;
+  }
+  return lanes;
+}();
+
+__attribute__((target("avx2,fma")))
+//! Culls the spheres in range [begin, end) 8 at a time, the rest one at a time.
+//! Visible indices are compressed with a permutation and stored 8 at a time,
+//! the stores never reach past the index of the last tested sphere.
+//! @returns Count of the visible spheres written.
+uint32_t cullAvx2(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  const size_t begin,
+  const size_t end,
+  uint32_t* visible) noexcept
+{
+  __m256 planes[6][4];
+  for (size_t plane = 0; plane < 6; ++plane)
+  {
+    for (size_t component = 0; component < 4; ++component)
+      planes[plane][component] = _mm256_set1_ps(frustum.planes[plane][static_cast<int>(component)]);
+  }
+
+  const __m256i laneShifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+  const __m256i laneMask = _mm256_set1_epi32(7);
+  const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+  uint32_t count = 0;
+  size_t i = begin;
+  for (; i + 8 <= end; i += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(&spheres.centerX[i]);
+    const __m256 y = _mm256_loadu_ps(&spheres.centerY[i]);
+    const __m256 z = _mm256_loadu_ps(&spheres.centerZ[i]);
+    const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+    // Outside of the frustum if entirely behind any of the planes.
+    __m256 outside = _mm256_setzero_ps();
+    for (size_t plane = 0; plane < 6; ++plane)
+    {
+      __m256 distance = _mm256_fmadd_ps(planes[plane][0], x, planes[plane][3]);
+      distance = _mm256_fmadd_ps(planes[plane][1], y, distance);
+      distance = _mm256_fmadd_ps(planes[plane][2], z, distance);
+      outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+    }
+
+    const auto mask = static_cast<uint32_t>(~_mm256_movemask_ps(outside) & 0xff);
+    const __m256i lanes = _mm256_and_si256(
+      _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(CompressLanes[mask])), laneShifts), laneMask);
+    const __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), laneOffsets);
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(visible + count), _mm256_permutevar8x32_epi32(indices, lanes));
+    count += static_cast<uint32_t>(std::popcount(mask));
+  }
+
+  return count + cullScalar(frustum, spheres, i, end, visible + count);
+}
+
+__attribute__((target("sse4.1")))
+//! Culls the spheres in range [begin, end) 4 at a time, the rest one at a time.
+//! @returns Count of the visible spheres written.
+uint32_t cullSse41(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  const size_t begin,
+  const size_t end,
+  uint32_t* visible) noexcept
+{
+  __m128 planes[6][4];
+  for (size_t plane = 0; plane < 6; ++plane)
+  {
+    for (size_t component = 0; component < 4; ++component)
+      planes[plane][component] = _mm_set1_ps(frustum.planes[plane][static_cast<int>(component)]);
+  }
+
+  uint32_t count = 0;
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4)
+  {
+    const __m128 x = _mm_loadu_ps(&spheres.centerX[i]);
+    const __m128 y = _mm_loadu_ps(&spheres.centerY[i]);
+    const __m128 z = _mm_loadu_ps(&spheres.centerZ[i]);
+    const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+    __m128 outside = _mm_setzero_ps();
+    for (size_t plane = 0; plane < 6; ++plane)
+    {
+      __m128 distance = _mm_add_ps(_mm_mul_ps(planes[plane][0], x), planes[plane][3]);
+      distance = _mm_add_ps(distance, _mm_mul_ps(planes[plane][1], y));
+      distance = _mm_add_ps(distance, _mm_mul_ps(planes[plane][2], z));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negativeRadius));
+    }
+
+    for (auto mask = static_cast<uint32_t>(~_mm_movemask_ps(outside) & 0xf); mask != 0; mask &= mask - 1)
+      visible[count++] = static_cast<uint32_t>(i) + static_cast<uint32_t>(std::countr_zero(mask));
+  }
+
+  return count + cullScalar(frustum, spheres, i, end, visible + count);
+}
+
+#endif
+
+//! Culls the spheres in range [begin, end) with the instruction set.
+//! @returns Count of the visible spheres written.
+uint32_t cullRange(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  const size_t begin,
+  const size_t end,
+  uint32_t* visible,
+  const SimdLevel level) noexcept
+{
+  switch (level)
+  {
+#if defined(ARETE_CULLING_X86)
+    case SimdLevel::Avx2:
+      return cullAvx2(frustum, spheres, begin, end, visible);
+    case SimdLevel::Sse41:
+      return cullSse41(frustum, spheres, begin, end, visible);
+#endif
+    default:
+      return cullScalar(frustum, spheres, begin, end, visible);
+  }
+}
+
+} // namespace
+
+FrustumCuller::FrustumCuller(std::pmr::memory_resource* resource)
+  : _visible(resource)
+  , _chunkCounts(resource)
+{}
+
+std::span<const uint32_t> FrustumCuller::cull(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  const SimdLevel level)
+{
+  return cull(frustum, spheres, nullptr, level);
+}
+
+std::span<const uint32_t> FrustumCuller::cull(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  threading::JobSystem& jobs,
+  const SimdLevel level)
+{
+  return cull(frustum, spheres, &jobs, level);
+}
+
+std::span<const uint32_t> FrustumCuller::cull(
+  const Frustum& frustum,
+  const BoundingSpheres& spheres,
+  threading::JobSystem* jobs,
+  const SimdLevel level)
+{
+  const size_t count = spheres.size();
+  if (spheres.centerY.size() != count || spheres.centerZ.size() != count || spheres.radius.size() != count)
+    throw std::invalid_argument("Bounding sphere arrays differ in size.");
+
+  const auto start = Clock::now();
+  const SimdLevel supportedLevel = std::min(level, detectSimdLevel());
+
+  const size_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+  if (_visible.size() < count)
+    _visible.resize(count);
+  _chunkCounts.resize(chunkCount);
+
+  const auto cullChunk = [&](const size_t chunk) {
+    const size_t begin = chunk * ChunkSize;
+    const size_t end = std::min(count, begin + ChunkSize);
+    _chunkCounts[chunk] = cullRange(frustum, spheres, begin, end, _visible.data() + begin, supportedLevel);
+  };
+  if (jobs != nullptr && chunkCount > 1)
+    jobs->parallelFor(chunkCount, cullChunk);
+  else
+  {
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+      cullChunk(chunk);
+  }
+
+  // Visible spheres of every chunk start at the beginning of its range, move them after the previous chunk.
+  size_t visibleCount = 0;
+  for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+  {
+    const uint32_t* chunkVisible = _visible.data() + chunk * ChunkSize;
+    if (visibleCount != chunk * ChunkSize)
+      std::memmove(_visible.data() + visibleCount, chunkVisible, _chunkCounts[chunk] * sizeof(uint32_t));
+    visibleCount += _chunkCounts[chunk];
+  }
+
+  _stats = {
+    .visibleCount = visibleCount,
+    .culledCount = count - visibleCount,
+    .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)};
+  return visible();
+}
+
+} // namespace arete::hcs
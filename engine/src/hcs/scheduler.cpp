@@ -0,0 +1,153 @@
+#include "arete/hcs/scheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace arete::hcs
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+} // namespace
+
+struct Scheduler::Frame
+{
+  Scheduler& scheduler;
+  threading::JobSystem& jobs;
+  threading::JobCounter counter;
+  float deltaTime;
+  Clock::time_point begin;
+};
+
+SystemId Scheduler::addSystem(
+  std::string name,
+  const FramePhase phase,
+  const SystemAccess access,
+  SystemCallable callable)
+{
+  const SystemId system = _systems.size();
+  auto& phaseSystems = _phases[static_cast<size_t>(phase)];
+
+  // Conflicting systems registered earlier run first.
+  std::vector<SystemId> dependencies;
+  for (const SystemId other: phaseSystems)
+  {
+    if (_systems[other].access.conflicts(access))
+      dependencies.push_back(other);
+  }
+
+  _systems.push_back({
+    .name = std::move(name),
+    .phase = phase,
+    .access = access,
+    .callable = std::move(callable),
+    .dependencies = std::move(dependencies),
+    .dependents = {}});
+  for (const SystemId dependency: _systems.back().dependencies)
+    _systems[dependency].dependents.push_back(system);
+  phaseSystems.push_back(system);
+
+  _pendingDependencies = std::make_unique<std::atomic<size_t>[]>(_systems.size());
+  _timeline.resize(_systems.size());
+  return system;
+}
+
+void Scheduler::run(const float deltaTime, threading::JobSystem& jobs)
+{
+  Frame frame {
+    .scheduler = *this,
+    .jobs = jobs,
+    .counter = {},
+    .deltaTime = deltaTime,
+    .begin = Clock::now()};
+
+  for (const auto& phaseSystems: _phases)
+  {
+    for (const SystemId system: phaseSystems)
+    {
+      _pendingDependencies[system].store(
+        _systems[system].dependencies.size(),
+        std::memory_order_relaxed);
+    }
+
+    // Start the roots, the rest is started by the systems it depends on.
+    for (const SystemId system: phaseSystems)
+    {
+      if (_systems[system].dependencies.empty())
+        start(frame, system);
+    }
+    jobs.wait(frame.counter);
+  }
+}
+
+std::vector<SystemId> Scheduler::criticalPath() const
+{
+  // Longest chain ending at every system. Dependencies are always registered earlier,
+  // so the registration order is a topological order.
+  std::vector<std::chrono::nanoseconds> chainEnd(_systems.size());
+  std::vector<SystemId> previous(_systems.size());
+
+  std::vector<SystemId> path;
+  for (const auto& phaseSystems: _phases)
+  {
+    if (phaseSystems.empty())
+      continue;
+
+    SystemId last = phaseSystems.front();
+    for (const SystemId system: phaseSystems)
+    {
+      previous[system] = system;
+      std::chrono::nanoseconds longestDependency {0};
+      for (const SystemId dependency: _systems[system].dependencies)
+      {
+        if (chainEnd[dependency] > longestDependency)
+        {
+          longestDependency = chainEnd[dependency];
+          previous[system] = dependency;
+        }
+      }
+      chainEnd[system] = longestDependency + _timeline[system].duration;
+
+      if (chainEnd[system] > chainEnd[last])
+        last = system;
+    }
+
+    const size_t phaseBegin = path.size();
+    for (SystemId system = last;; system = previous[system])
+    {
+      path.push_back(system);
+      if (previous[system] == system)
+        break;
+    }
+    std::reverse(path.begin() + static_cast<std::ptrdiff_t>(phaseBegin), path.end());
+  }
+  return path;
+}
+
+void Scheduler::start(Frame& frame, const SystemId system)
+{
+  frame.jobs.run(frame.counter, [&frame, system]() {
+    auto& scheduler = frame.scheduler;
+
+    const auto started = Clock::now();
+    scheduler._systems[system].callable(frame.deltaTime);
+    const auto finished = Clock::now();
+
+    scheduler._timeline[system] = {
+      .system = system,
+      .threadIndex = frame.jobs.localThreadIndex(),
+      .start = started - frame.begin,
+      .duration = finished - started};
+
+    for (const SystemId dependent: scheduler._systems[system].dependents)
+    {
+      if (scheduler._pendingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        start(frame, dependent);
+    }
+  });
+}
+
+} // namespace arete::hcs
@@ -0,0 +1,35 @@
+#include "arete/hcs/simd.hpp"
+
+namespace arete::hcs
+{
+
+SimdLevel detectSimdLevel() noexcept
+{
+  static const SimdLevel level = []() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+      return SimdLevel::Avx2;
+    if (__builtin_cpu_supports("sse4.1"))
+      return SimdLevel::Sse41;
+#endif
+    return SimdLevel::Scalar;
+  }();
+  return level;
+}
+
+const char* simdLevelName(const SimdLevel level) noexcept
+{
+  switch (level)
+  {
+    case SimdLevel::Avx2:
+      return "avx2";
+    case SimdLevel::Sse41:
+      return "sse4.1";
+    case SimdLevel::Scalar:
+      break;
+  }
+  return "scalar";
+}
+
+} // namespace arete::hcs
@@ -0,0 +1,128 @@
+#include "arete/hcs/snapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace arete::hcs
+{
+
+namespace
+{
+
+//! @returns Offset of every section in the snapshot, followed by the size of the snapshot.
+//! @throws std::out_of_range if the sections do not add up to the size of the snapshot.
+std::vector<uint64_t> sectionOffsets(const Snapshot& snapshot)
+{
+  std::vector<uint64_t> offsets {0};
+  if (snapshot.sections.empty())
+  {
+    offsets.push_back(snapshot.data.size());
+    return offsets;
+  }
+
+  for (const auto size: snapshot.sections)
+    offsets.push_back(offsets.back() + size);
+  if (offsets.back() != snapshot.data.size())
+    throw std::out_of_range("Snapshot sections do not match its size.");
+  return offsets;
+}
+
+} // namespace
+
+SnapshotDelta diffSnapshots(const Snapshot& base, const Snapshot& target)
+{
+  const auto baseOffsets = sectionOffsets(base);
+  const auto targetOffsets = sectionOffsets(target);
+  const size_t baseSectionCount = baseOffsets.size() - 1;
+  const size_t targetSectionCount = targetOffsets.size() - 1;
+
+  SnapshotDelta delta;
+  delta.targetSections.reserve(targetSectionCount);
+  for (size_t section = 0; section < targetSectionCount; ++section)
+  {
+    const std::byte* targetSection = target.data.data() + targetOffsets[section];
+    const size_t targetSize = targetOffsets[section + 1] - targetOffsets[section];
+    const std::byte* baseSection = section < baseSectionCount ? base.data.data() + baseOffsets[section] : nullptr;
+    const size_t baseSize = section < baseSectionCount ? baseOffsets[section + 1] - baseOffsets[section] : 0;
+    delta.targetSections.push_back(targetSize);
+
+    for (size_t offset = 0; offset < targetSize; offset += SnapshotDeltaBlockSize)
+    {
+      const size_t length = std::min(SnapshotDeltaBlockSize, targetSize - offset);
+      const bool changed = offset + length > baseSize
+        || std::memcmp(baseSection + offset, targetSection + offset, length) != 0;
+      if (!changed)
+        continue;
+
+      // Extend the previous run if it ends right before this block.
+      auto* previous = delta.runs.empty() ? nullptr : &delta.runs.back();
+      if (previous != nullptr && previous->section == section && previous->offset + previous->length == offset)
+        previous->length += length;
+      else
+        delta.runs.push_back({section, offset, length});
+
+      delta.bytes.insert(delta.bytes.end(), targetSection + offset, targetSection + offset + length);
+    }
+  }
+
+  return delta;
+}
+
+void applySnapshotDelta(Snapshot& snapshot, const SnapshotDelta& delta)
+{
+  const auto baseOffsets = sectionOffsets(snapshot);
+  const size_t baseSectionCount = baseOffsets.size() - 1;
+
+  // Sections keep the bytes of their base section wherever no run overwrites them.
+  std::vector<uint64_t> targetOffsets {0};
+  for (const auto size: delta.targetSections)
+    targetOffsets.push_back(targetOffsets.back() + size);
+
+  std::vector<std::byte> data(targetOffsets.back());
+  for (size_t section = 0; section < delta.targetSections.size() && section < baseSectionCount; ++section)
+  {
+    const size_t length = std::min<uint64_t>(
+      delta.targetSections[section], baseOffsets[section + 1] - baseOffsets[section]);
+    if (length != 0)
+      std::memcpy(data.data() + targetOffsets[section], snapshot.data.data() + baseOffsets[section], length);
+  }
+
+  size_t source = 0;
+  for (const auto& run: delta.runs)
+  {
+    if (run.section >= delta.targetSections.size()
+      || run.offset + run.length > delta.targetSections[run.section]
+      || source + run.length > delta.bytes.size())
+      throw std::out_of_range("Snapshot delta run is out of range.");
+
+    std::memcpy(data.data() + targetOffsets[run.section] + run.offset, delta.bytes.data() + source, run.length);
+    source += run.length;
+  }
+
+  snapshot.data = std::move(data);
+  snapshot.sections = delta.targetSections;
+}
+
+void SnapshotWriter::write(const void* source, const size_t size)
+{
+  const size_t offset = _snapshot.data.size();
+  _snapshot.data.resize(offset + size);
+  if (_snapshot.sections.empty() && offset != 0)
+    _snapshot.sections.push_back(offset);
+  _snapshot.sections.push_back(size);
+  if (size != 0)
+    std::memcpy(_snapshot.data.data() + offset, source, size);
+}
+
+void SnapshotReader::read(void* destination, const size_t size)
+{
+  if (_offset + size > _snapshot.data.size())
+    throw std::out_of_range("Snapshot is truncated.");
+
+  if (size != 0)
+    std::memcpy(destination, _snapshot.data.data() + _offset, size);
+  _offset += size;
+}
+
+} // namespace arete::hcs
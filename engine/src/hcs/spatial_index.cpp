@@ -0,0 +1,567 @@
+#include "arete/hcs/spatial_index.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace arete::hcs
+{
+
+namespace
+{
+
+//! @returns Low 10 bits of the value spread to every third bit.
+uint32_t spreadBits(uint32_t value) noexcept
+{
+  value &= 0x3ffu;
+  value = (value | (value << 16)) & 0x030000ffu;
+  value = (value | (value << 8)) & 0x0300f00fu;
+  value = (value | (value << 4)) & 0x030c30c3u;
+  value = (value | (value << 2)) & 0x09249249u;
+  return value;
+}
+
+} // namespace
+
+SpatialIndex::SpatialIndex(
+  const Aabb& worldBounds,
+  const uint32_t depth,
+  std::pmr::memory_resource* resource)
+  : _resource(resource)
+  , _rootCenter(worldBounds.center())
+  , _rootHalfSize(std::max({worldBounds.extents().x, worldBounds.extents().y, worldBounds.extents().z}))
+  , _depth(depth)
+  , _nodes(resource)
+  , _nodeFreeList(resource)
+  , _slots(resource)
+  , _slotFreeList(resource)
+  , _transformObjects(resource)
+{
+  if (depth > MaxDepth)
+    throw std::invalid_argument("Spatial index depth is too large.");
+
+  _nodes.push_back({
+    .center = _rootCenter,
+    .halfSize = _rootHalfSize,
+    .depth = 0,
+    .parent = NoNode,
+    .children = {NoNode, NoNode, NoNode, NoNode, NoNode, NoNode, NoNode, NoNode},
+    .objectCount = 0,
+    .split = false,
+    .entries = std::pmr::vector<Entry>(_resource)});
+}
+
+SpatialHandle SpatialIndex::insert(const Aabb& bounds)
+{
+  SpatialHandle slotIndex = 0;
+  if (!_slotFreeList.empty())
+  {
+    slotIndex = _slotFreeList.back();
+    _slotFreeList.pop_back();
+  } else
+  {
+    if (_slots.size() >= Handle::MaxSlots)
+      throw std::length_error("Ran out of addressable spatial index slots.");
+    slotIndex = static_cast<SpatialHandle>(_slots.size());
+    _slots.push_back({
+      .node = NoNode,
+      .entry = 0,
+      .generation = 0,
+      .transform = TransformHierarchy::NoTransform,
+      .localBounds = {}});
+  }
+
+  auto& slot = _slots[slotIndex];
+  slot.transform = TransformHierarchy::NoTransform;
+
+  const SpatialHandle object = Handle::make(slotIndex, slot.generation);
+  link(object, bounds, nodeOf(bounds));
+  return object;
+}
+
+void SpatialIndex::insert(const std::span<const Aabb> bounds, const std::span<SpatialHandle> objects)
+{
+  if (bounds.size() != objects.size())
+    throw std::invalid_argument("Spatial index arrays differ in size.");
+
+  if (bounds.size() > _slotFreeList.size())
+    _slots.reserve(_slots.size() + bounds.size() - _slotFreeList.size());
+
+  // Inserted in the Morton order of their centers, so consecutive objects
+  // mostly descend to the nodes visited just before.
+  std::pmr::vector<std::pair<uint32_t, uint32_t>> order(_resource);
+  order.reserve(bounds.size());
+  const float scale = 1023.0f / (2.0f * _rootHalfSize);
+  for (size_t i = 0; i < bounds.size(); ++i)
+  {
+    const glm::vec3 cell = glm::clamp(
+      (bounds[i].center() - _rootCenter + glm::vec3(_rootHalfSize)) * scale, glm::vec3(0.0f), glm::vec3(1023.0f));
+    order.emplace_back(
+      spreadBits(static_cast<uint32_t>(cell.x))
+        | (spreadBits(static_cast<uint32_t>(cell.y)) << 1)
+        | (spreadBits(static_cast<uint32_t>(cell.z)) << 2),
+      static_cast<uint32_t>(i));
+  }
+  std::sort(order.begin(), order.end());
+
+  for (const auto& [code, i]: order)
+    objects[i] = insert(bounds[i]);
+}
+
+SpatialHandle SpatialIndex::insert(
+  const TransformHierarchy& hierarchy,
+  const TransformHandle transform,
+  const Aabb& localBounds)
+{
+  if (!hierarchy.contains(transform))
+    throw std::invalid_argument("Transform does not exist.");
+
+  const auto transformSlot = TransformHierarchy::Handle::index(transform);
+  if (transformSlot >= _transformObjects.size())
+    _transformObjects.resize(transformSlot + 1, NoObject);
+
+  // Objects of the destroyed transforms which reused the slot are not followed anymore.
+  const SpatialHandle previous = _transformObjects[transformSlot];
+  if (previous != NoObject && _slots[Handle::index(previous)].transform == transform)
+    throw std::invalid_argument("Transform already has an object.");
+
+  const SpatialHandle object = insert(localBounds.transformed(hierarchy.world(transform)));
+  auto& slot = _slots[Handle::index(object)];
+  slot.transform = transform;
+  slot.localBounds = localBounds;
+  _transformObjects[transformSlot] = object;
+  return object;
+}
+
+void SpatialIndex::remove(const SpatialHandle object)
+{
+  auto& slot = slotOf(object);
+  if (slot.transform != TransformHierarchy::NoTransform)
+  {
+    auto& transformObject = _transformObjects[TransformHierarchy::Handle::index(slot.transform)];
+    if (transformObject == object)
+      transformObject = NoObject;
+    slot.transform = TransformHierarchy::NoTransform;
+  }
+
+  unlink(slot);
+  slot.generation = Handle::nextGeneration(slot.generation);
+  _slotFreeList.push_back(Handle::index(object));
+}
+
+void SpatialIndex::remove(const std::span<const SpatialHandle> objects)
+{
+  for (const SpatialHandle object: objects)
+    remove(object);
+}
+
+void SpatialIndex::refit(const SpatialHandle object, const Aabb& bounds)
+{
+  auto& slot = slotOf(object);
+  auto& node = _nodes[slot.node];
+
+  // Bounds centered in the same cell stay in the node, unless their size changed
+  // so they belong to another level.
+  const uint32_t depth = depthOf(bounds);
+  const glm::vec3 offset = glm::abs(bounds.center() - node.center);
+  const bool sameCell = node.depth == 0
+    || (offset.x <= node.halfSize && offset.y <= node.halfSize && offset.z <= node.halfSize);
+  if (sameCell && (depth == node.depth || (depth > node.depth && !node.split)))
+  {
+    node.entries[slot.entry].bounds = bounds;
+    return;
+  }
+
+  unlink(slot);
+  link(object, bounds, nodeOf(bounds));
+}
+
+void SpatialIndex::refit(const std::span<const SpatialHandle> objects, const std::span<const Aabb> bounds)
+{
+  if (objects.size() != bounds.size())
+    throw std::invalid_argument("Spatial index arrays differ in size.");
+
+  for (size_t i = 0; i < objects.size(); ++i)
+    refit(objects[i], bounds[i]);
+}
+
+void SpatialIndex::refit(const TransformHierarchy& hierarchy)
+{
+  for (const TransformHandle transform: hierarchy.updatedTransforms())
+  {
+    const auto transformSlot = TransformHierarchy::Handle::index(transform);
+    if (transformSlot >= _transformObjects.size())
+      continue;
+
+    const SpatialHandle object = _transformObjects[transformSlot];
+    if (object == NoObject)
+      continue;
+
+    const auto& slot = _slots[Handle::index(object)];
+    if (slot.transform != transform)
+      continue;
+    refit(object, slot.localBounds.transformed(hierarchy.world(transform)));
+  }
+}
+
+bool SpatialIndex::contains(const SpatialHandle object) const noexcept
+{
+  const SpatialHandle slotIndex = Handle::index(object);
+  if (object == NoObject || slotIndex >= _slots.size())
+    return false;
+
+  const auto& slot = _slots[slotIndex];
+  return slot.node != NoNode && slot.generation == Handle::generation(object);
+}
+
+const Aabb& SpatialIndex::bounds(const SpatialHandle object) const
+{
+  if (!contains(object))
+    throw std::invalid_argument("Spatial index object does not exist.");
+
+  const auto& slot = _slots[Handle::index(object)];
+  return _nodes[slot.node].entries[slot.entry].bounds;
+}
+
+void SpatialIndex::query(const Aabb& box, std::vector<SpatialHandle>& objects) const
+{
+  collect(
+    [&box](const Aabb& nodeBounds) {
+      if (!box.intersects(nodeBounds))
+        return Containment::Outside;
+      return box.contains(nodeBounds) ? Containment::Inside : Containment::Intersecting;
+    },
+    [&box](const Aabb& bounds) {
+      return box.intersects(bounds);
+    },
+    objects);
+}
+
+void SpatialIndex::query(const Sphere& sphere, std::vector<SpatialHandle>& objects) const
+{
+  collect(
+    [&sphere](const Aabb& nodeBounds) {
+      if (!sphere.intersects(nodeBounds))
+        return Containment::Outside;
+      return sphere.contains(nodeBounds) ? Containment::Inside : Containment::Intersecting;
+    },
+    [&sphere](const Aabb& bounds) {
+      return sphere.intersects(bounds);
+    },
+    objects);
+}
+
+void SpatialIndex::query(const Frustum& frustum, std::vector<SpatialHandle>& objects) const
+{
+  collect(
+    [&frustum](const Aabb& nodeBounds) {
+      return frustum.classify(nodeBounds);
+    },
+    [&frustum](const Aabb& bounds) {
+      return frustum.intersects(bounds);
+    },
+    objects);
+}
+
+void SpatialIndex::query(const Ray& ray, const float maxDistance, std::vector<SpatialHandle>& objects) const
+{
+  const glm::vec3 inverseDirection = 1.0f / ray.direction;
+  const auto hits = [&](const Aabb& bounds) {
+    return ray.intersect(bounds, inverseDirection, maxDistance).has_value();
+  };
+
+  collect(
+    [&hits](const Aabb& nodeBounds) {
+      return hits(nodeBounds) ? Containment::Intersecting : Containment::Outside;
+    },
+    hits,
+    objects);
+}
+
+std::optional<RayHit> SpatialIndex::raycast(const Ray& ray, const float maxDistance) const
+{
+  const glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+  //! Node to visit and the distance at which the ray enters it.
+  struct Visit
+  {
+    NodeIndex node;
+    float distance;
+  };
+
+  std::optional<RayHit> hit;
+  float nearest = maxDistance;
+
+  // Depth-first, nearer children are visited first and the farther ones
+  // are skipped once an object nearer than them is hit.
+  std::array<Visit, 8 * MaxDepth + 1> stack {};
+  size_t stackSize = 0;
+  stack[stackSize++] = {RootNode, 0.0f};
+  while (stackSize > 0)
+  {
+    const Visit visit = stack[--stackSize];
+    if (visit.distance > nearest)
+      continue;
+
+    const auto& node = _nodes[visit.node];
+    for (const auto& entry: node.entries)
+    {
+      const auto distance = ray.intersect(entry.bounds, inverseDirection, nearest);
+      if (distance && (!hit || *distance < nearest))
+      {
+        nearest = *distance;
+        hit = RayHit{.object = entry.object, .distance = nearest};
+      }
+    }
+
+    std::array<Visit, 8> children {};
+    size_t childCount = 0;
+    for (const NodeIndex child: node.children)
+    {
+      if (child == NoNode)
+        continue;
+      const auto distance = ray.intersect(looseBounds(_nodes[child]), inverseDirection, nearest);
+      if (distance)
+        children[childCount++] = {child, *distance};
+    }
+
+    // Pushed farthest first so the nearest is on the top of the stack.
+    for (size_t sorted = 1; sorted < childCount; ++sorted)
+    {
+      for (size_t child = sorted; child > 0 && children[child - 1].distance < children[child].distance; --child)
+        std::swap(children[child - 1], children[child]);
+    }
+    for (size_t child = 0; child < childCount; ++child)
+      stack[stackSize++] = children[child];
+  }
+  return hit;
+}
+
+SpatialIndex::Slot& SpatialIndex::slotOf(const SpatialHandle object)
+{
+  if (!contains(object))
+    throw std::invalid_argument("Spatial index object does not exist.");
+  return _slots[Handle::index(object)];
+}
+
+uint32_t SpatialIndex::depthOf(const Aabb& bounds) const noexcept
+{
+  const glm::vec3 offset = glm::abs(bounds.center() - _rootCenter);
+  if (offset.x > _rootHalfSize || offset.y > _rootHalfSize || offset.z > _rootHalfSize)
+    return 0;
+
+  // The deepest cell at least as large as the bounds, the loose bounds of its node
+  // then enclose the bounds wherever their center lies in the cell.
+  const glm::vec3 extents = bounds.extents();
+  const float radius = std::max({extents.x, extents.y, extents.z});
+  uint32_t depth = 0;
+  for (float halfSize = _rootHalfSize * 0.5f; depth < _depth && halfSize >= radius; halfSize *= 0.5f)
+    ++depth;
+  return depth;
+}
+
+SpatialIndex::NodeIndex SpatialIndex::nodeOf(const Aabb& bounds)
+{
+  const uint32_t depth = depthOf(bounds);
+  const glm::vec3 center = bounds.center();
+
+  NodeIndex node = RootNode;
+  while (_nodes[node].split && _nodes[node].depth < depth)
+    node = childOf(node, center);
+  return node;
+}
+
+SpatialIndex::NodeIndex SpatialIndex::childOf(const NodeIndex node, const glm::vec3& point)
+{
+  const glm::vec3& nodeCenter = _nodes[node].center;
+  const uint32_t octant = (point.x >= nodeCenter.x ? 1u : 0u)
+    | (point.y >= nodeCenter.y ? 2u : 0u)
+    | (point.z >= nodeCenter.z ? 4u : 0u);
+
+  const NodeIndex child = _nodes[node].children[octant];
+  return child == NoNode ? createChild(node, octant) : child;
+}
+
+Aabb SpatialIndex::looseBounds(const Node& node) const noexcept
+{
+  return Aabb::fromCenter(node.center, glm::vec3(node.halfSize * 2.0f));
+}
+
+void SpatialIndex::link(const SpatialHandle object, const Aabb& bounds, const NodeIndex node)
+{
+  auto& entries = _nodes[node].entries;
+  auto& slot = _slots[Handle::index(object)];
+  slot.node = node;
+  slot.entry = static_cast<uint32_t>(entries.size());
+  entries.push_back({.bounds = bounds, .object = object});
+
+  for (NodeIndex ancestor = node; ancestor != NoNode; ancestor = _nodes[ancestor].parent)
+    ++_nodes[ancestor].objectCount;
+  split(node);
+}
+
+void SpatialIndex::unlink(Slot& slot)
+{
+  const NodeIndex node = slot.node;
+  static_cast<void>(takeEntry(node, slot.entry));
+  slot.node = NoNode;
+
+  // Nodes left without objects in their subtree are released, their children were released before.
+  NodeIndex ancestor = node;
+  while (ancestor != NoNode)
+  {
+    auto& current = _nodes[ancestor];
+    const NodeIndex parent = current.parent;
+    if (--current.objectCount == 0 && ancestor != RootNode)
+    {
+      auto& siblings = _nodes[parent].children;
+      *std::find(siblings.begin(), siblings.end(), ancestor) = NoNode;
+      _nodeFreeList.push_back(ancestor);
+    }
+    ancestor = parent;
+  }
+}
+
+SpatialIndex::Entry SpatialIndex::takeEntry(const NodeIndex node, const uint32_t entry)
+{
+  auto& entries = _nodes[node].entries;
+  const Entry taken = entries[entry];
+  if (entry + 1 != entries.size())
+  {
+    entries[entry] = entries.back();
+    _slots[Handle::index(entries[entry].object)].entry = entry;
+  }
+  entries.pop_back();
+  return taken;
+}
+
+void SpatialIndex::split(const NodeIndex node)
+{
+  if (_nodes[node].split || _nodes[node].entries.size() <= SplitThreshold || _nodes[node].depth >= _depth)
+    return;
+  _nodes[node].split = true;
+
+  // The node keeps the objects of its size, the smaller ones move to the children.
+  // They stay in the subtree, so only the children count them.
+  const uint32_t depth = _nodes[node].depth;
+  for (uint32_t entry = 0; entry < _nodes[node].entries.size();)
+  {
+    if (depthOf(_nodes[node].entries[entry].bounds) == depth)
+    {
+      ++entry;
+      continue;
+    }
+
+    const Entry moved = takeEntry(node, entry);
+    const NodeIndex child = childOf(node, moved.bounds.center());
+    auto& slot = _slots[Handle::index(moved.object)];
+    slot.node = child;
+    slot.entry = static_cast<uint32_t>(_nodes[child].entries.size());
+    _nodes[child].entries.push_back(moved);
+    ++_nodes[child].objectCount;
+  }
+
+  const auto children = _nodes[node].children;
+  for (const NodeIndex child: children)
+  {
+    if (child != NoNode)
+      split(child);
+  }
+}
+
+SpatialIndex::NodeIndex SpatialIndex::createChild(const NodeIndex parent, const uint32_t octant)
+{
+  const float halfSize = _nodes[parent].halfSize * 0.5f;
+  const glm::vec3 center = _nodes[parent].center + glm::vec3(
+    (octant & 1u) != 0 ? halfSize : -halfSize,
+    (octant & 2u) != 0 ? halfSize : -halfSize,
+    (octant & 4u) != 0 ? halfSize : -halfSize);
+
+  NodeIndex child = NoNode;
+  if (!_nodeFreeList.empty())
+  {
+    child = _nodeFreeList.back();
+    _nodeFreeList.pop_back();
+  } else
+  {
+    child = static_cast<NodeIndex>(_nodes.size());
+    _nodes.push_back({
+      .center = center,
+      .halfSize = halfSize,
+      .depth = 0,
+      .parent = NoNode,
+      .children = {},
+      .objectCount = 0,
+      .split = false,
+      .entries = std::pmr::vector<Entry>(_resource)});
+  }
+
+  // Released nodes keep the capacity of their entries.
+  auto& node = _nodes[child];
+  node.center = center;
+  node.halfSize = halfSize;
+  node.depth = _nodes[parent].depth + 1;
+  node.parent = parent;
+  node.children.fill(NoNode);
+  node.objectCount = 0;
+  node.split = false;
+
+  _nodes[parent].children[octant] = child;
+  return child;
+}
+
+template<typename Classify, typename Test>
+void SpatialIndex::collect(Classify&& classify, Test&& test, std::vector<SpatialHandle>& objects) const
+{
+  std::array<NodeIndex, 8 * MaxDepth + 1> stack {};
+  size_t stackSize = 0;
+  stack[stackSize++] = RootNode;
+  while (stackSize > 0)
+  {
+    const NodeIndex index = stack[--stackSize];
+    const auto& node = _nodes[index];
+
+    // The root node holds objects outside of the world too, so it is never rejected.
+    if (index != RootNode)
+    {
+      const Containment containment = classify(looseBounds(node));
+      if (containment == Containment::Outside)
+        continue;
+      if (containment == Containment::Inside)
+      {
+        collectSubtree(index, objects);
+        continue;
+      }
+    }
+
+    for (const auto& entry: node.entries)
+    {
+      if (test(entry.bounds))
+        objects.push_back(entry.object);
+    }
+    for (const NodeIndex child: node.children)
+    {
+      if (child != NoNode)
+        stack[stackSize++] = child;
+    }
+  }
+}
+
+void SpatialIndex::collectSubtree(const NodeIndex node, std::vector<SpatialHandle>& objects) const
+{
+  std::array<NodeIndex, 8 * MaxDepth + 1> stack {};
+  size_t stackSize = 0;
+  stack[stackSize++] = node;
+  while (stackSize > 0)
+  {
+    const auto& current = _nodes[stack[--stackSize]];
+    for (const auto& entry: current.entries)
+      objects.push_back(entry.object);
+    for (const NodeIndex child: current.children)
+    {
+      if (child != NoNode)
+        stack[stackSize++] = child;
+    }
+  }
+}
+
+} // namespace arete::hcs
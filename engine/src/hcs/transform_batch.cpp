@@ -0,0 +1,346 @@
+#include "arete/hcs/transform_batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ARETE_TRANSFORM_BATCH_X86
+#include <immintrin.h>
+#endif
+
+namespace arete::hcs
+{
+
+namespace
+{
+
+//! Composes world and clip matrices of the transforms in range [begin, end) one at a time.
+void composeScalar(
+  const TransformBatch& batch,
+  const glm::mat4& viewProjection,
+  glm::mat4* worlds,
+  glm::mat4* clips,
+  const size_t begin,
+  const size_t end) noexcept
+{
+  for (size_t i = begin; i < end; ++i)
+  {
+    const float x = batch.rotationX[i];
+    const float y = batch.rotationY[i];
+    const float z = batch.rotationZ[i];
+    const float w = batch.rotationW[i];
+    const float sx = batch.scaleX[i];
+    const float sy = batch.scaleY[i];
+    const float sz = batch.scaleZ[i];
+
+    glm::mat4& world = worlds[i];
+    world[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f) * sx;
+    world[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f) * sy;
+    world[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f) * sz;
+    world[3] = glm::vec4(batch.positionX[i], batch.positionY[i], batch.positionZ[i], 1.0f);
+
+    clips[i] = viewProjection * world;
+  }
+}
+
+#if defined(ARETE_TRANSFORM_BATCH_X86)
+
+//! @returns True if the pointer is aligned to the alignment.
+bool aligned(const void* pointer, const size_t alignment) noexcept
+{
+  return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+__attribute__((target("avx2,fma"), always_inline))
+//! Transposes 8x8 matrix of the rows in place.
+inline void transpose8(__m256* rows) noexcept
+{
+  const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+  const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+  const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+  const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+  const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+  const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+  const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+  const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  rows[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  rows[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  rows[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  rows[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  rows[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  rows[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  rows[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  rows[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+template<bool Stream>
+__attribute__((target("avx2,fma"), always_inline))
+//! Stores the matrices of 8 transforms given as a vector per column-major entry.
+//! Streaming stores bypass the cache, the matrices must be aligned to 32 bytes then.
+inline void storeMatrices8(__m256 (&entries)[16], glm::mat4* matrices) noexcept
+{
+  // Every half of a matrix is a 8x8 transposition of the entries.
+  for (size_t half = 0; half < 2; ++half)
+  {
+    __m256* rows = &entries[half * 8];
+    transpose8(rows);
+    for (size_t transform = 0; transform < 8; ++transform)
+    {
+      if constexpr (Stream)
+        _mm256_stream_ps(&matrices[transform][half * 2][0], rows[transform]);
+      else
+        _mm256_storeu_ps(&matrices[transform][half * 2][0], rows[transform]);
+    }
+  }
+}
+
+template<bool Stream>
+__attribute__((target("avx2,fma")))
+//! Composes world and clip matrices of 8 transforms at a time, the rest one at a time.
+void composeAvx2(
+  const TransformBatch& batch,
+  const glm::mat4& viewProjection,
+  glm::mat4* worlds,
+  glm::mat4* clips,
+  const size_t count) noexcept
+{
+  __m256 projection[4][4];
+  for (size_t column = 0; column < 4; ++column)
+  {
+    for (size_t row = 0; row < 4; ++row)
+      projection[column][row] = _mm256_set1_ps(viewProjection[column][row]);
+  }
+
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 two = _mm256_set1_ps(2.0f);
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256 x = _mm256_loadu_ps(&batch.rotationX[i]);
+    const __m256 y = _mm256_loadu_ps(&batch.rotationY[i]);
+    const __m256 z = _mm256_loadu_ps(&batch.rotationZ[i]);
+    const __m256 w = _mm256_loadu_ps(&batch.rotationW[i]);
+    const __m256 sx = _mm256_loadu_ps(&batch.scaleX[i]);
+    const __m256 sy = _mm256_loadu_ps(&batch.scaleY[i]);
+    const __m256 sz = _mm256_loadu_ps(&batch.scaleZ[i]);
+
+    const __m256 xx = _mm256_mul_ps(x, x);
+    const __m256 yy = _mm256_mul_ps(y, y);
+    const __m256 zz = _mm256_mul_ps(z, z);
+    const __m256 xy = _mm256_mul_ps(x, y);
+    const __m256 xz = _mm256_mul_ps(x, z);
+    const __m256 yz = _mm256_mul_ps(y, z);
+    const __m256 wx = _mm256_mul_ps(w, x);
+    const __m256 wy = _mm256_mul_ps(w, y);
+    const __m256 wz = _mm256_mul_ps(w, z);
+
+    // Upper 3 rows of the world matrices, the last row is implicit.
+    __m256 world[4][3];
+    world[0][0] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx);
+    world[0][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+    world[0][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+    world[1][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+    world[1][1] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy);
+    world[1][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+    world[2][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+    world[2][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+    world[2][2] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz);
+    world[3][0] = _mm256_loadu_ps(&batch.positionX[i]);
+    world[3][1] = _mm256_loadu_ps(&batch.positionY[i]);
+    world[3][2] = _mm256_loadu_ps(&batch.positionZ[i]);
+
+    __m256 worldEntries[16];
+    __m256 clipEntries[16];
+    for (size_t column = 0; column < 4; ++column)
+    {
+      worldEntries[column * 4 + 0] = world[column][0];
+      worldEntries[column * 4 + 1] = world[column][1];
+      worldEntries[column * 4 + 2] = world[column][2];
+      worldEntries[column * 4 + 3] = column == 3 ? one : zero;
+
+      for (size_t row = 0; row < 4; ++row)
+      {
+        __m256 entry = _mm256_mul_ps(projection[0][row], world[column][0]);
+        entry = _mm256_fmadd_ps(projection[1][row], world[column][1], entry);
+        entry = _mm256_fmadd_ps(projection[2][row], world[column][2], entry);
+        if (column == 3)
+          entry = _mm256_add_ps(entry, projection[3][row]);
+        clipEntries[column * 4 + row] = entry;
+      }
+    }
+
+    storeMatrices8<Stream>(worldEntries, &worlds[i]);
+    storeMatrices8<Stream>(clipEntries, &clips[i]);
+  }
+  if constexpr (Stream)
+    _mm_sfence();
+
+  composeScalar(batch, viewProjection, worlds, clips, i, count);
+}
+
+template<bool Stream>
+__attribute__((target("sse4.1"), always_inline))
+//! Stores the matrices of 4 transforms given as a vector per column-major entry.
+//! Streaming stores bypass the cache, the matrices must be aligned to 16 bytes then.
+inline void storeMatrices4(__m128 (&entries)[16], glm::mat4* matrices) noexcept
+{
+  // Every column of a matrix is a 4x4 transposition of the entries.
+  for (size_t column = 0; column < 4; ++column)
+  {
+    __m128* rows = &entries[column * 4];
+    _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+    for (size_t transform = 0; transform < 4; ++transform)
+    {
+      if constexpr (Stream)
+        _mm_stream_ps(&matrices[transform][column][0], rows[transform]);
+      else
+        _mm_storeu_ps(&matrices[transform][column][0], rows[transform]);
+    }
+  }
+}
+
+template<bool Stream>
+__attribute__((target("sse4.1")))
+//! Composes world and clip matrices of 4 transforms at a time, the rest one at a time.
+void composeSse41(
+  const TransformBatch& batch,
+  const glm::mat4& viewProjection,
+  glm::mat4* worlds,
+  glm::mat4* clips,
+  const size_t count) noexcept
+{
+  __m128 projection[4][4];
+  for (size_t column = 0; column < 4; ++column)
+  {
+    for (size_t row = 0; row < 4; ++row)
+      projection[column][row] = _mm_set1_ps(viewProjection[column][row]);
+  }
+
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128 x = _mm_loadu_ps(&batch.rotationX[i]);
+    const __m128 y = _mm_loadu_ps(&batch.rotationY[i]);
+    const __m128 z = _mm_loadu_ps(&batch.rotationZ[i]);
+    const __m128 w = _mm_loadu_ps(&batch.rotationW[i]);
+    const __m128 sx = _mm_loadu_ps(&batch.scaleX[i]);
+    const __m128 sy = _mm_loadu_ps(&batch.scaleY[i]);
+    const __m128 sz = _mm_loadu_ps(&batch.scaleZ[i]);
+
+    const __m128 xx = _mm_mul_ps(x, x);
+    const __m128 yy = _mm_mul_ps(y, y);
+    const __m128 zz = _mm_mul_ps(z, z);
+    const __m128 xy = _mm_mul_ps(x, y);
+    const __m128 xz = _mm_mul_ps(x, z);
+    const __m128 yz = _mm_mul_ps(y, z);
+    const __m128 wx = _mm_mul_ps(w, x);
+    const __m128 wy = _mm_mul_ps(w, y);
+    const __m128 wz = _mm_mul_ps(w, z);
+
+    // Upper 3 rows of the world matrices, the last row is implicit.
+    __m128 world[4][3];
+    world[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    world[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    world[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    world[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    world[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    world[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    world[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    world[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    world[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+    world[3][0] = _mm_loadu_ps(&batch.positionX[i]);
+    world[3][1] = _mm_loadu_ps(&batch.positionY[i]);
+    world[3][2] = _mm_loadu_ps(&batch.positionZ[i]);
+
+    __m128 worldEntries[16];
+    __m128 clipEntries[16];
+    for (size_t column = 0; column < 4; ++column)
+    {
+      worldEntries[column * 4 + 0] = world[column][0];
+      worldEntries[column * 4 + 1] = world[column][1];
+      worldEntries[column * 4 + 2] = world[column][2];
+      worldEntries[column * 4 + 3] = column == 3 ? one : zero;
+
+      for (size_t row = 0; row < 4; ++row)
+      {
+        __m128 entry = _mm_mul_ps(projection[0][row], world[column][0]);
+        entry = _mm_add_ps(entry, _mm_mul_ps(projection[1][row], world[column][1]));
+        entry = _mm_add_ps(entry, _mm_mul_ps(projection[2][row], world[column][2]));
+        if (column == 3)
+          entry = _mm_add_ps(entry, projection[3][row]);
+        clipEntries[column * 4 + row] = entry;
+      }
+    }
+
+    storeMatrices4<Stream>(worldEntries, &worlds[i]);
+    storeMatrices4<Stream>(clipEntries, &clips[i]);
+  }
+  if constexpr (Stream)
+    _mm_sfence();
+
+  composeScalar(batch, viewProjection, worlds, clips, i, count);
+}
+
+#endif
+
+} // namespace
+
+void composeTransforms(
+  const TransformBatch& batch,
+  const glm::mat4& viewProjection,
+  const std::span<glm::mat4> worlds,
+  const std::span<glm::mat4> clips,
+  const SimdLevel level)
+{
+  const size_t count = batch.size();
+  for (const auto& array: {
+         batch.positionY, batch.positionZ,
+         batch.rotationX, batch.rotationY, batch.rotationZ, batch.rotationW,
+         batch.scaleX, batch.scaleY, batch.scaleZ})
+  {
+    if (array.size() != count)
+      throw std::invalid_argument("Transform batch arrays differ in size.");
+  }
+  if (worlds.size() != count || clips.size() != count)
+    throw std::invalid_argument("Transform batch output arrays differ in size.");
+
+  switch (std::min(level, detectSimdLevel()))
+  {
+#if defined(ARETE_TRANSFORM_BATCH_X86)
+    case SimdLevel::Avx2:
+      if (aligned(worlds.data(), 32) && aligned(clips.data(), 32))
+        composeAvx2<true>(batch, viewProjection, worlds.data(), clips.data(), count);
+      else
+        composeAvx2<false>(batch, viewProjection, worlds.data(), clips.data(), count);
+      return;
+    case SimdLevel::Sse41:
+      if (aligned(worlds.data(), 16) && aligned(clips.data(), 16))
+        composeSse41<true>(batch, viewProjection, worlds.data(), clips.data(), count);
+      else
+        composeSse41<false>(batch, viewProjection, worlds.data(), clips.data(), count);
+      return;
+#endif
+    default:
+      composeScalar(batch, viewProjection, worlds.data(), clips.data(), 0, count);
+      return;
+  }
+}
+
+} // namespace arete::hcs
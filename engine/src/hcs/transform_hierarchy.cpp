@@ -0,0 +1,324 @@
+#include "arete/hcs/transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace arete::hcs
+{
+
+TransformHierarchy::TransformHierarchy(std::pmr::memory_resource* resource)
+  : _handles(resource)
+  , _parents(resource)
+  , _firstChildren(resource)
+  , _childCounts(resource)
+  , _locals(resource)
+  , _worlds(resource)
+  , _dirty(resource)
+  , _levels(resource)
+  , _slots(resource)
+  , _slotFreeList(resource)
+  , _dirtyIndices(resource)
+  , _levelIndices(resource)
+  , _childIndices(resource)
+  , _order(resource)
+  , _updatedTransforms(resource)
+{}
+
+TransformHandle TransformHierarchy::create(const SpatialComponent& local, const TransformHandle parent)
+{
+  const Index parentIndex = parent == NoTransform ? NoIndex : indexOf(parent);
+
+  TransformHandle slotIndex = 0;
+  if (!_slotFreeList.empty())
+  {
+    slotIndex = _slotFreeList.back();
+    _slotFreeList.pop_back();
+  } else
+  {
+    if (_slots.size() >= Handle::MaxSlots)
+      throw std::length_error("Ran out of addressable transform slots.");
+    slotIndex = static_cast<TransformHandle>(_slots.size());
+    _slots.push_back({.index = NoIndex, .generation = 0});
+  }
+
+  // Appended out of order, sorted by the next update.
+  auto& slot = _slots[slotIndex];
+  slot.index = static_cast<Index>(_handles.size());
+
+  const TransformHandle handle = Handle::make(slotIndex, slot.generation);
+  _handles.push_back(handle);
+  _parents.push_back(parentIndex);
+  _firstChildren.push_back(0);
+  _childCounts.push_back(0);
+  _locals.push_back(local);
+  _worlds.emplace_back(1.0f);
+  _dirty.push_back(0);
+  markDirty(slot.index);
+
+  _structureChanged = true;
+  return handle;
+}
+
+void TransformHierarchy::destroy(const TransformHandle transform)
+{
+  static_cast<void>(indexOf(transform));
+  if (_structureChanged)
+    rebuild();
+
+  // Children of every transform are contiguous.
+  _levelIndices.assign(1, indexOf(transform));
+  for (size_t next = 0; next < _levelIndices.size(); ++next)
+  {
+    const Index destroyed = _levelIndices[next];
+    for (Index child = 0; child < _childCounts[destroyed]; ++child)
+      _levelIndices.push_back(_firstChildren[destroyed] + child);
+
+    auto& slot = _slots[Handle::index(_handles[destroyed])];
+    slot.index = NoIndex;
+    slot.generation = Handle::nextGeneration(slot.generation);
+    _slotFreeList.push_back(Handle::index(_handles[destroyed]));
+
+    _handles[destroyed] = NoTransform;
+    ++_destroyedCount;
+  }
+  _levelIndices.clear();
+  _structureChanged = true;
+}
+
+void TransformHierarchy::setParent(const TransformHandle transform, const TransformHandle parent)
+{
+  const Index index = indexOf(transform);
+  const Index parentIndex = parent == NoTransform ? NoIndex : indexOf(parent);
+
+  for (Index ancestor = parentIndex; ancestor != NoIndex; ancestor = _parents[ancestor])
+  {
+    if (ancestor == index)
+      throw std::invalid_argument("Transform can't be attached to itself or its descendant.");
+  }
+
+  _parents[index] = parentIndex;
+  markDirty(index);
+  _structureChanged = true;
+}
+
+TransformHandle TransformHierarchy::parent(const TransformHandle transform) const
+{
+  const Index parentIndex = _parents[indexOf(transform)];
+  return parentIndex == NoIndex ? NoTransform : _handles[parentIndex];
+}
+
+bool TransformHierarchy::contains(const TransformHandle transform) const noexcept
+{
+  const TransformHandle slotIndex = Handle::index(transform);
+  if (transform == NoTransform || slotIndex >= _slots.size())
+    return false;
+
+  const auto& slot = _slots[slotIndex];
+  return slot.index != NoIndex && slot.generation == Handle::generation(transform);
+}
+
+const SpatialComponent& TransformHierarchy::local(const TransformHandle transform) const
+{
+  return _locals[indexOf(transform)];
+}
+
+SpatialComponent& TransformHierarchy::modify(const TransformHandle transform)
+{
+  const Index index = indexOf(transform);
+  markDirty(index);
+  return _locals[index];
+}
+
+const glm::mat4& TransformHierarchy::world(const TransformHandle transform) const
+{
+  return _worlds[indexOf(transform)];
+}
+
+void TransformHierarchy::update()
+{
+  update(nullptr);
+}
+
+void TransformHierarchy::update(threading::JobSystem& jobs)
+{
+  update(&jobs);
+}
+
+TransformHierarchy::Index TransformHierarchy::indexOf(const TransformHandle transform) const
+{
+  if (!contains(transform))
+    throw std::invalid_argument("Transform does not exist.");
+  return _slots[Handle::index(transform)].index;
+}
+
+void TransformHierarchy::markDirty(const Index index)
+{
+  if (_dirty[index] != 0)
+    return;
+  _dirty[index] = 1;
+  _dirtyIndices.push_back(index);
+}
+
+void TransformHierarchy::rebuild()
+{
+  const auto count = static_cast<Index>(_handles.size());
+
+  // Children of every transform in the current order, as ranges of a single array.
+  _childCounts.assign(count, 0);
+  for (Index index = 0; index < count; ++index)
+  {
+    if (_handles[index] != NoTransform && _parents[index] != NoIndex)
+      ++_childCounts[_parents[index]];
+  }
+  _firstChildren.resize(count);
+  Index childOffset = 0;
+  for (Index index = 0; index < count; ++index)
+  {
+    _firstChildren[index] = childOffset;
+    childOffset += _childCounts[index];
+  }
+  _childIndices.resize(childOffset);
+  for (Index index = 0; index < count; ++index)
+  {
+    if (_handles[index] != NoTransform && _parents[index] != NoIndex)
+      _childIndices[_firstChildren[_parents[index]]++] = index;
+  }
+  for (Index index = 0; index < count; ++index)
+    _firstChildren[index] -= _childCounts[index];
+
+  // Breadth-first order of the live transforms, roots first.
+  // Descendants of destroyed transforms were destroyed with them, so every live transform is reached.
+  _order.clear();
+  for (Index index = 0; index < count; ++index)
+  {
+    if (_handles[index] != NoTransform && _parents[index] == NoIndex)
+      _order.push_back(index);
+  }
+  for (size_t next = 0; next < _order.size(); ++next)
+  {
+    const Index index = _order[next];
+    const auto children = std::span(_childIndices).subspan(_firstChildren[index], _childCounts[index]);
+    _order.insert(_order.end(), children.begin(), children.end());
+  }
+
+  // Map of the current indices to the sorted ones, reusing the child array.
+  _childIndices.assign(count, NoIndex);
+  for (Index sorted = 0; sorted < _order.size(); ++sorted)
+    _childIndices[_order[sorted]] = sorted;
+
+  const auto permute = [this](auto& array) {
+    using Array = std::remove_reference_t<decltype(array)>;
+    Array sorted(array.get_allocator());
+    sorted.reserve(_order.size());
+    for (const Index index: _order)
+      sorted.push_back(array[index]);
+    array = std::move(sorted);
+  };
+  permute(_handles);
+  permute(_parents);
+  permute(_locals);
+  permute(_worlds);
+  permute(_dirty);
+  for (Index& parent: _parents)
+  {
+    if (parent != NoIndex)
+      parent = _childIndices[parent];
+  }
+
+  const auto sortedCount = static_cast<Index>(_order.size());
+  for (Index index = 0; index < sortedCount; ++index)
+    _slots[Handle::index(_handles[index])].index = index;
+
+  // Children are contiguous now, levels as well. Depths never decrease in breadth-first order,
+  // the depth of every transform is kept in the order array which is not needed anymore.
+  _firstChildren.assign(sortedCount, 0);
+  _childCounts.assign(sortedCount, 0);
+  _levels.clear();
+  for (Index index = 0; index < sortedCount; ++index)
+  {
+    const Index parent = _parents[index];
+    _order[index] = parent == NoIndex ? 0 : _order[parent] + 1;
+    if (parent != NoIndex && _childCounts[parent]++ == 0)
+      _firstChildren[parent] = index;
+
+    if (_levels.size() == _order[index])
+      _levels.push_back(index);
+  }
+  _levels.push_back(sortedCount);
+
+  _dirtyIndices.clear();
+  for (Index index = 0; index < sortedCount; ++index)
+  {
+    if (_dirty[index] != 0)
+      _dirtyIndices.push_back(index);
+  }
+
+  _destroyedCount = 0;
+  _structureChanged = false;
+}
+
+void TransformHierarchy::update(threading::JobSystem* jobs)
+{
+  if (_structureChanged)
+    rebuild();
+
+  std::sort(_dirtyIndices.begin(), _dirtyIndices.end());
+
+  _updatedTransforms.clear();
+  _childIndices.clear();
+  auto dirty = _dirtyIndices.begin();
+  for (size_t level = 0; level + 1 < _levels.size(); ++level)
+  {
+    if (_childIndices.empty() && dirty == _dirtyIndices.end())
+      break;
+
+    // Transforms of the level marked dirty, merged with the children of the transforms
+    // recomputed on the previous level. Both are sorted, children ranges follow the order of their parents.
+    const auto dirtyEnd = std::lower_bound(dirty, _dirtyIndices.end(), _levels[level + 1]);
+    _levelIndices.clear();
+    std::set_union(
+      dirty, dirtyEnd,
+      _childIndices.begin(), _childIndices.end(),
+      std::back_inserter(_levelIndices));
+    dirty = dirtyEnd;
+
+    const size_t levelCount = _levelIndices.size();
+    if (jobs != nullptr && levelCount > ParallelBatchSize)
+    {
+      const size_t batchCount = (levelCount + ParallelBatchSize - 1) / ParallelBatchSize;
+      jobs->parallelFor(batchCount, [this, levelCount](const size_t batch) {
+        const size_t end = std::min(levelCount, (batch + 1) * ParallelBatchSize);
+        for (size_t i = batch * ParallelBatchSize; i < end; ++i)
+          computeWorld(_levelIndices[i]);
+      });
+    } else
+    {
+      for (const Index index: _levelIndices)
+        computeWorld(index);
+    }
+
+    _childIndices.clear();
+    for (const Index index: _levelIndices)
+    {
+      _dirty[index] = 0;
+      _updatedTransforms.push_back(_handles[index]);
+      for (Index child = 0; child < _childCounts[index]; ++child)
+        _childIndices.push_back(_firstChildren[index] + child);
+    }
+  }
+
+  _dirtyIndices.clear();
+  _childIndices.clear();
+}
+
+void TransformHierarchy::computeWorld(const Index index) noexcept
+{
+  const Index parent = _parents[index];
+  if (parent == NoIndex)
+    _worlds[index] = _locals[index].localMatrix();
+  else
+    _worlds[index] = _worlds[parent] * _locals[index].localMatrix();
+}
+
+} // namespace arete::hcs
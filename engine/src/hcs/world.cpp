@@ -0,0 +1,235 @@
+#include "arete/hcs/world.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace arete::hcs
+{
+
+namespace
+{
+
+//! Registry of component types.
+struct ComponentRegistry
+{
+  std::mutex mutex;
+  std::array<ComponentInfo, MaxComponentTypes> infos {};
+  ComponentTypeId count = 0;
+};
+
+ComponentRegistry& componentRegistry()
+{
+  static ComponentRegistry registry;
+  return registry;
+}
+
+//! Alignment of the column storage.
+constexpr size_t ColumnAlignment = 64;
+
+//! Initial capacity of the archetype columns.
+constexpr size_t InitialCapacity = 64;
+
+} // namespace
+
+ComponentTypeId registerComponentType(const ComponentInfo& info)
+{
+  auto& registry = componentRegistry();
+  std::scoped_lock lock(registry.mutex);
+  if (registry.count == MaxComponentTypes)
+    throw std::length_error("Ran out of component type identifiers.");
+
+  registry.infos[registry.count] = info;
+  return registry.count++;
+}
+
+const ComponentInfo& componentInfo(const ComponentTypeId type)
+{
+  return componentRegistry().infos[type];
+}
+
+Archetype::Archetype(const ComponentMask mask)
+    : _mask(mask)
+{
+  _columnIndex.fill(InvalidColumn);
+
+  // Columns are ordered by the component type identifier.
+  for (ComponentMask remaining = mask; remaining != 0; remaining &= remaining - 1)
+  {
+    const auto type = static_cast<ComponentTypeId>(std::countr_zero(remaining));
+    _columnIndex[type] = static_cast<uint8_t>(_columns.size());
+    _columns.push_back({type, &componentInfo(type), nullptr});
+  }
+}
+
+Archetype::~Archetype()
+{
+  for (auto& column: _columns)
+  {
+    for (size_t row = 0; row < _actors.size(); ++row)
+      column.info->destroy(column.data + row * column.info->size);
+    ::operator delete(column.data, std::align_val_t{ColumnAlignment});
+  }
+}
+
+void* Archetype::component(const ComponentTypeId type, const size_t row) noexcept
+{
+  const auto& column = _columns[_columnIndex[type]];
+  return column.data + row * column.info->size;
+}
+
+size_t Archetype::appendRow(const ActorHandle actor)
+{
+  if (_actors.size() == _capacity)
+    grow();
+
+  _actors.push_back(actor);
+  return _actors.size() - 1;
+}
+
+void Archetype::popRow() noexcept
+{
+  _actors.pop_back();
+}
+
+std::optional<ActorHandle> Archetype::removeRow(const size_t row)
+{
+  for (auto& column: _columns)
+    column.info->destroy(column.data + row * column.info->size);
+  return fillRow(row);
+}
+
+std::optional<ActorHandle> Archetype::moveRow(
+  const size_t row,
+  Archetype& target,
+  const size_t targetRow)
+{
+  for (auto& column: _columns)
+  {
+    void* source = column.data + row * column.info->size;
+    if (target.hasComponent(column.type))
+      column.info->relocate(target.component(column.type, targetRow), source);
+    else
+      column.info->destroy(source);
+  }
+
+  return fillRow(row);
+}
+
+std::optional<ActorHandle> Archetype::fillRow(const size_t row)
+{
+  const size_t lastRow = _actors.size() - 1;
+  std::optional<ActorHandle> movedActor;
+  if (row != lastRow)
+  {
+    for (auto& column: _columns)
+    {
+      const auto size = column.info->size;
+      column.info->relocate(column.data + row * size, column.data + lastRow * size);
+    }
+    _actors[row] = _actors[lastRow];
+    movedActor = _actors[row];
+  }
+
+  _actors.pop_back();
+  return movedActor;
+}
+
+void Archetype::grow()
+{
+  const size_t capacity = std::max(InitialCapacity, _capacity * 2);
+  for (auto& column: _columns)
+  {
+    const auto size = column.info->size;
+    auto* data = static_cast<std::byte*>(
+      ::operator new(capacity * size, std::align_val_t{ColumnAlignment}));
+
+    for (size_t row = 0; row < _actors.size(); ++row)
+      column.info->relocate(data + row * size, column.data + row * size);
+
+    ::operator delete(column.data, std::align_val_t{ColumnAlignment});
+    column.data = data;
+  }
+
+  _capacity = capacity;
+}
+
+World::World()
+{
+  // Actors without any components live in the empty archetype.
+  getOrCreateArchetype(0);
+}
+
+bool World::destroyActor(const ActorHandle actor)
+{
+  const auto index = _actorIndex.find(actor);
+  if (!index)
+    return false;
+
+  const auto record = _actorRecords[*index];
+  if (const auto movedActor = record.archetype->removeRow(record.row))
+    _actorRecords[*_actorIndex.find(*movedActor)].row = record.row;
+
+  // Records are co-indexed with the sparse index, fill the hole the same way.
+  [[maybe_unused]] const auto erasedIndex = _actorIndex.erase(actor);
+  _actorRecords[*index] = _actorRecords.back();
+  _actorRecords.pop_back();
+
+  return true;
+}
+
+World::ActorRecord& World::actorRecord(const ActorHandle actor)
+{
+  const auto index = _actorIndex.find(actor);
+  if (!index)
+    throw std::invalid_argument("Actor handle is stale.");
+  return _actorRecords[*index];
+}
+
+void World::moveActor(ActorRecord& record, Archetype& target, const size_t targetRow)
+{
+  if (const auto movedActor = record.archetype->moveRow(record.row, target, targetRow))
+    _actorRecords[*_actorIndex.find(*movedActor)].row = record.row;
+
+  record.archetype = &target;
+  record.row = targetRow;
+}
+
+Archetype& World::getOrCreateArchetype(const ComponentMask mask)
+{
+  const auto iterator = _archetypesByMask.find(mask);
+  if (iterator != _archetypesByMask.end())
+    return *iterator->second;
+
+  auto* archetype = _archetypes.emplace_back(
+    std::make_unique<Archetype>(mask)).get();
+  _archetypesByMask.emplace(mask, archetype);
+
+  // Update cached queries with the new archetype.
+  for (auto& [queryMask, cache]: _queries)
+  {
+    if ((mask & queryMask) == queryMask)
+      cache.archetypes.push_back(archetype);
+  }
+
+  return *archetype;
+}
+
+const QueryCache& World::queryCache(const ComponentMask mask)
+{
+  const auto [iterator, inserted] = _queries.try_emplace(mask, QueryCache{mask, {}});
+  auto& cache = iterator->second;
+  if (inserted)
+  {
+    for (const auto& archetype: _archetypes)
+    {
+      if ((archetype->mask() & mask) == mask)
+        cache.archetypes.push_back(archetype.get());
+    }
+  }
+
+  return cache;
+}
+
+} // namespace arete::hcs
@@ -0,0 +1,92 @@
+#include "arete/task.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace arete
+{
+
+namespace
+{
+
+//! Counter of the jobs resuming tasks, nobody waits for it.
+threading::JobCounter resumeJobs;
+
+} // namespace
+
+std::pmr::memory_resource& taskFrameResource() noexcept
+{
+  static std::pmr::synchronized_pool_resource resource(std::pmr::pool_options {
+    .max_blocks_per_chunk = 64,
+    .largest_required_pool_block = MaxPooledTaskFrameSize});
+  return resource;
+}
+
+namespace detail
+{
+
+bool resumeAsJob(threading::JobSystem& jobs, const std::coroutine_handle<> coroutine)
+{
+  if (jobs.threadCount() <= 1)
+    return false;
+
+  jobs.run(resumeJobs, [coroutine]() {
+    coroutine.resume();
+  });
+  return true;
+}
+
+} // namespace detail
+
+Task<> waitFor(const threading::JobCounter& counter, threading::JobSystem& jobs)
+{
+  co_await resumeOn(jobs);
+  jobs.wait(counter);
+}
+
+Task<std::vector<uint8_t>> readFile(const std::filesystem::path path, threading::JobSystem& jobs)
+{
+  co_await resumeOn(jobs);
+
+  std::ifstream input(path, std::ios::binary);
+  if (!input.is_open())
+    throw std::runtime_error("Couldn't open file '" + path.string() + "'.");
+
+  co_return std::vector<uint8_t>(
+    std::istreambuf_iterator<char>(input),
+    std::istreambuf_iterator<char>());
+}
+
+void FrameScheduler::resume()
+{
+  {
+    std::scoped_lock lock(_mutex);
+    std::swap(_waiting, _resuming);
+  }
+
+  for (const Waiter& waiter: _resuming)
+  {
+    if (waiter.poll != nullptr && !waiter.poll(waiter.condition))
+    {
+      enqueue(waiter);
+      continue;
+    }
+    waiter.coroutine.resume();
+  }
+  _resuming.clear();
+}
+
+size_t FrameScheduler::size() const
+{
+  std::scoped_lock lock(_mutex);
+  return _waiting.size();
+}
+
+void FrameScheduler::enqueue(const Waiter& waiter)
+{
+  std::scoped_lock lock(_mutex);
+  _waiting.push_back(waiter);
+}
+
+} // namespace arete
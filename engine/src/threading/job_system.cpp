@@ -0,0 +1,269 @@
+#include "arete/threading/job_system.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace arete::threading
+{
+
+namespace
+{
+
+//! Job system of the current thread.
+thread_local const JobSystem* currentSystem = nullptr;
+//! Index of the current thread within its job system.
+thread_local size_t currentThread = 0;
+
+//! Count of failed attempts to find a job before an idle worker goes to sleep.
+constexpr size_t IdleSpinCount = 256;
+
+//! Hints the processor that the thread is spinning.
+void spinPause() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+//! @returns Logical processors available to the process, one per physical core.
+std::vector<int> physicalCores()
+{
+  std::vector<int> cores;
+#if defined(__linux__)
+  cpu_set_t available;
+  CPU_ZERO(&available);
+  if (sched_getaffinity(0, sizeof(available), &available) != 0)
+    return cores;
+
+  // Pick the first logical processor of every core, skipping its hyper-threads.
+  std::set<std::pair<int, int>> seenCores;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+  {
+    if (!CPU_ISSET(cpu, &available))
+      continue;
+
+    const std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+    int package = -1;
+    int core = cpu;
+    std::ifstream(topology + "physical_package_id") >> package;
+    std::ifstream(topology + "core_id") >> core;
+
+    if (seenCores.emplace(package, core).second)
+      cores.push_back(cpu);
+  }
+#endif
+  return cores;
+}
+
+//! Pins the thread to the logical processor.
+void pinThread([[maybe_unused]] std::thread& thread, [[maybe_unused]] const int cpu) noexcept
+{
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#endif
+}
+
+} // namespace
+
+bool JobDeque::push(Job* job) noexcept
+{
+  const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+  const int64_t top = _top.load(std::memory_order_acquire);
+  if (bottom - top >= static_cast<int64_t>(Capacity))
+    return false;
+
+  _jobs[bottom & Mask].store(job, std::memory_order_relaxed);
+  _bottom.store(bottom + 1, std::memory_order_release);
+  return true;
+}
+
+Job* JobDeque::pop() noexcept
+{
+  const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+  _bottom.store(bottom, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t top = _top.load(std::memory_order_relaxed);
+
+  if (top > bottom)
+  {
+    // Deque is empty.
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Job* job = _jobs[bottom & Mask].load(std::memory_order_relaxed);
+  if (top == bottom)
+  {
+    // Last job, race the thieves for it.
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      job = nullptr;
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return job;
+}
+
+Job* JobDeque::steal() noexcept
+{
+  int64_t top = _top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const int64_t bottom = _bottom.load(std::memory_order_acquire);
+  if (top >= bottom)
+    return nullptr;
+
+  Job* job = _jobs[top & Mask].load(std::memory_order_relaxed);
+  if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return nullptr;
+  return job;
+}
+
+JobSystem::JobSystem(const size_t threadCount, const bool pinThreads)
+{
+  const size_t contextCount = std::max<size_t>(threadCount, 1);
+  _contexts.reserve(contextCount);
+  for (size_t index = 0; index < contextCount; ++index)
+    _contexts.emplace_back(std::make_unique<Context>());
+
+  const auto cores = pinThreads ? physicalCores() : std::vector<int>{};
+
+  // Context 0 is shared by the threads outside of the system.
+  _workers.reserve(contextCount - 1);
+  for (size_t index = 1; index < contextCount; ++index)
+  {
+    _workers.emplace_back([this, index]() {
+      workerLoop(index);
+    });
+    if (!cores.empty())
+      pinThread(_workers.back(), cores[index % cores.size()]);
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  _stopping.store(true, std::memory_order_relaxed);
+  _wakeEpoch.fetch_add(1, std::memory_order_release);
+  _wakeEpoch.notify_all();
+
+  for (auto& worker: _workers)
+    worker.join();
+}
+
+void JobSystem::wait(const JobCounter& counter) noexcept
+{
+  Context& context = currentContext();
+  while (!counter.done())
+  {
+    if (Job* job = findJob(context))
+      execute(job);
+    else
+      spinPause();
+  }
+}
+
+size_t JobSystem::currentThreadIndex() noexcept
+{
+  return currentThread;
+}
+
+size_t JobSystem::localThreadIndex() const noexcept
+{
+  return currentSystem == this ? currentThread : 0;
+}
+
+size_t JobSystem::physicalCoreCount()
+{
+  static const size_t count = []() {
+    const size_t cores = physicalCores().size();
+    return cores != 0 ? cores : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }();
+  return count;
+}
+
+JobSystem& JobSystem::shared()
+{
+  static JobSystem system;
+  return system;
+}
+
+JobSystem::Context& JobSystem::currentContext() noexcept
+{
+  return *_contexts[localThreadIndex()];
+}
+
+Job* JobSystem::findJob(Context& context) noexcept
+{
+  {
+    const auto lock = lockContext(context);
+    if (Job* job = context.deque.pop())
+      return job;
+  }
+
+  // Steal from the other contexts, starting after the own one to spread the thieves.
+  const size_t ownIndex = localThreadIndex();
+  for (size_t offset = 1; offset < _contexts.size(); ++offset)
+  {
+    if (Job* job = _contexts[(ownIndex + offset) % _contexts.size()]->deque.steal())
+      return job;
+  }
+  return nullptr;
+}
+
+void JobSystem::execute(Job* job) noexcept
+{
+  JobCounter* counter = job->counter;
+  job->function(*job);
+  job->inFlight.store(false, std::memory_order_release);
+  counter->_pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::wake() noexcept
+{
+  _wakeEpoch.fetch_add(1, std::memory_order_release);
+  _wakeEpoch.notify_one();
+}
+
+void JobSystem::workerLoop(const size_t threadIndex) noexcept
+{
+  currentSystem = this;
+  currentThread = threadIndex;
+  Context& context = *_contexts[threadIndex];
+
+  size_t idleSpins = 0;
+  while (true)
+  {
+    const uint32_t epoch = _wakeEpoch.load(std::memory_order_acquire);
+    if (_stopping.load(std::memory_order_relaxed))
+      return;
+
+    if (Job* job = findJob(context))
+    {
+      execute(job);
+      idleSpins = 0;
+      continue;
+    }
+
+    if (++idleSpins < IdleSpinCount)
+    {
+      spinPause();
+      continue;
+    }
+
+    // Sleep until a job is started after the epoch was read.
+    _wakeEpoch.wait(epoch, std::memory_order_acquire);
+    idleSpins = 0;
+  }
+}
+
+} // namespace arete::threading
@@ -1,34 +1,222 @@
 #include "arete/tickClock.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
 namespace arete {
 
-TickClock::TickClock(float tickPeriod)
-    : tickPeriod(tickPeriod)
-{}
+namespace {
 
-TickClock::Tick TickClock::tick() noexcept
+using FloatingPointDuration = std::chrono::duration<
+  float,
+  std::chrono::seconds::period>;
+
+//! Count of sleeps measured by the spin threshold calibration.
+constexpr size_t CalibrationSampleCount = 16;
+//! Duration of a sleep measured by the spin threshold calibration.
+constexpr auto CalibrationSleep = std::chrono::microseconds(500);
+
+//! Hints the processor that the thread is spinning.
+void spinPause() noexcept
 {
-  using FloatingPointDuration = std::chrono::duration<
-    float,
-    std::chrono::seconds::period>;
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
 
+//! Sleeps until the time point, may overshoot it by the timer slack of the system.
+void sleepUntil(const TickClock::Clock::time_point time) noexcept
+{
+#if defined(__linux__)
+  // Steady clock is the monotonic clock on Linux.
+  const auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch());
+  const timespec deadline {
+    .tv_sec = static_cast<time_t>(sinceEpoch.count() / 1'000'000'000),
+    .tv_nsec = static_cast<long>(sinceEpoch.count() % 1'000'000'000)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+  {
+  }
+#else
+  std::this_thread::sleep_until(time);
+#endif
+}
+
+} // namespace
+
+TickClock::TickClock(float tickRate, uint32_t maxStepCount)
+    : curentTickTime(Clock::now())
+    , lastTickTime(curentTickTime)
+    , tickRate(tickRate)
+    , maxStepCount(std::max(maxStepCount, 1u))
+{
+  if (tickRate > 0.0f)
+  {
+    stepPeriod = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / tickRate));
+
+    // Calibrate up front rather than on the first paced tick.
+    static_cast<void>(spinThreshold());
+  }
+}
+
+TickClock::Tick TickClock::tick() noexcept
+{
   lastTickTime = curentTickTime;
   curentTickTime = Clock::now();
 
-  tickTimeDelta = FloatingPointDuration(curentTickTime - lastTickTime).count();
+  tickTimeDelta += FloatingPointDuration(curentTickTime - lastTickTime).count();
 
-  if (tickPeriod == 0.0f)
+  if (tickRate == 0.0f)
   {
-    return {true, tickTimeDelta};
+    const float deltaTime = tickTimeDelta;
+    tickTimeDelta = 0;
+    return {true, deltaTime};
   }
 
-  if (tickTimeDelta >= 1/tickPeriod)
+  const float period = 1 / tickRate;
+  if (tickTimeDelta >= period)
   {
-    tickTimeDelta = 0;
-    return {true, tickTimeDelta};
+    // Keep the remainder, but never more than a period so a hitch does not fire back-to-back ticks.
+    // Remainder is reported by the next tick, so this one reports a single period.
+    tickTimeDelta = std::min(tickTimeDelta - period, period);
+    return {true, period};
   }
 
   return {false, tickTimeDelta};
 }
 
-} // namespace arete
\ No newline at end of file
+TickClock::Tick TickClock::waitForTick() noexcept
+{
+  if (stepPeriod == Clock::duration::zero())
+    return tick();
+
+  const auto now = Clock::now();
+  if (pacedTickCount == 0 || now > nextPacedTickTime + stepPeriod)
+  {
+    // First tick, or fell behind by more than a period. Start over instead of
+    // catching up with a burst of ticks.
+    nextPacedTickTime = now;
+  }
+
+  // Sleep through most of the wait, spin for the stretch the sleep might overshoot.
+  const auto sleepDeadline = nextPacedTickTime - spinThreshold();
+  if (now < sleepDeadline)
+    sleepUntil(sleepDeadline);
+  while (Clock::now() < nextPacedTickTime)
+    spinPause();
+
+  lastTickTime = curentTickTime;
+  curentTickTime = Clock::now();
+  tickTimeDelta = 0;
+
+  const double jitter = std::abs(std::chrono::duration<double>(curentTickTime - nextPacedTickTime).count());
+  if (pacedTickCount == 0)
+  {
+    firstPacedTickTime = curentTickTime;
+    pacingJitterSum = 0;
+    pacingJitterMax = 0;
+  }
+  pacingJitterSum += jitter;
+  pacingJitterMax = std::max(pacingJitterMax, jitter);
+  ++pacedTickCount;
+
+  nextPacedTickTime += stepPeriod;
+  return {true, FloatingPointDuration(curentTickTime - lastTickTime).count()};
+}
+
+TickClock::PacingStats TickClock::pacingStats() const noexcept
+{
+  PacingStats stats {
+    .tickCount = pacedTickCount,
+    .targetPeriod = FloatingPointDuration(stepPeriod).count(),
+    .meanPeriod = 0,
+    .meanJitter = 0,
+    .maxJitter = static_cast<float>(pacingJitterMax)};
+
+  if (pacedTickCount > 0)
+    stats.meanJitter = static_cast<float>(pacingJitterSum / static_cast<double>(pacedTickCount));
+  if (pacedTickCount > 1)
+  {
+    stats.meanPeriod = FloatingPointDuration(curentTickTime - firstPacedTickTime).count()
+      / static_cast<float>(pacedTickCount - 1);
+  }
+  return stats;
+}
+
+TickClock::Clock::duration TickClock::spinThreshold() noexcept
+{
+  static const Clock::duration threshold = []() {
+    // Spin for twice the typical overshoot of a short sleep. The worst case is dominated
+    // by preemption, which spinning could not hide either.
+    std::array<Clock::duration, CalibrationSampleCount> overshoots {};
+    for (auto& overshoot: overshoots)
+    {
+      const auto deadline = Clock::now() + CalibrationSleep;
+      sleepUntil(deadline);
+      overshoot = Clock::now() - deadline;
+    }
+    std::nth_element(overshoots.begin(), overshoots.begin() + CalibrationSampleCount / 2, overshoots.end());
+
+    return std::clamp<Clock::duration>(
+      overshoots[CalibrationSampleCount / 2] * 2,
+      std::chrono::microseconds(20),
+      std::chrono::milliseconds(2));
+  }();
+  return threshold;
+}
+
+TickClock::FixedStep TickClock::fixedStep() noexcept
+{
+  lastTickTime = curentTickTime;
+  curentTickTime = Clock::now();
+
+  if (stepPeriod == Clock::duration::zero())
+  {
+    return {
+      .stepCount = 1,
+      .stepDelta = FloatingPointDuration(curentTickTime - lastTickTime).count(),
+      .alpha = 0,
+      .droppedStepCount = 0};
+  }
+
+  stepAccumulator += curentTickTime - lastTickTime;
+
+  auto stepCount = static_cast<uint64_t>(stepAccumulator / stepPeriod);
+  stepAccumulator -= stepPeriod * stepCount;
+
+  // Steps take real time as well, running all of them after a hitch
+  // only leaves more time behind for the next frame.
+  uint32_t droppedStepCount = 0;
+  if (stepCount > maxStepCount)
+  {
+    droppedStepCount = static_cast<uint32_t>(stepCount - maxStepCount);
+    stepCount = maxStepCount;
+  }
+
+  return {
+    .stepCount = static_cast<uint32_t>(stepCount),
+    .stepDelta = FloatingPointDuration(stepPeriod).count(),
+    .alpha = static_cast<float>(
+      static_cast<double>(stepAccumulator.count()) / static_cast<double>(stepPeriod.count())),
+    .droppedStepCount = droppedStepCount};
+}
+
+void TickClock::reset() noexcept
+{
+  curentTickTime = Clock::now();
+  lastTickTime = curentTickTime;
+  tickTimeDelta = 0;
+  stepAccumulator = {};
+  pacedTickCount = 0;
+}
+
+} // namespace arete
@@ -0,0 +1,283 @@
+#include "arete/tlsf.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace arete
+{
+
+TlsfAllocator::TlsfAllocator(const Size capacity, std::pmr::memory_resource* resource)
+  : _capacity(capacity)
+  , _ranges(resource)
+  , _rangeFreeList(resource)
+{
+  if (capacity == 0)
+    throw std::invalid_argument("Allocator capacity must not be zero.");
+
+  for (auto& lists: _freeLists)
+    lists.fill(NoRange);
+  insertFree(createRange(0, capacity, NoRange, NoRange));
+}
+
+std::optional<TlsfAllocator::Allocation> TlsfAllocator::allocate(const Size size, const Size alignment)
+{
+  if (size == 0)
+    throw std::invalid_argument("Allocation size must not be zero.");
+  if (!std::has_single_bit(alignment))
+    throw std::invalid_argument("Allocation alignment must be a power of two.");
+
+  if (size > _capacity)
+    return std::nullopt;
+  const RangeIndex range = findRange(size, alignment);
+  if (range == NoRange)
+    return std::nullopt;
+  removeFree(range);
+
+  // Neighbors of a free range are allocated, the split off parts do not need merging.
+  const Size offset = _ranges[range].offset;
+  const Size alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+  if (alignedOffset != offset)
+  {
+    const Size padding = alignedOffset - offset;
+    const RangeIndex front = createRange(offset, padding, _ranges[range].previous, range);
+    if (_ranges[front].previous != NoRange)
+      _ranges[_ranges[front].previous].next = front;
+    _ranges[range].previous = front;
+    _ranges[range].offset = alignedOffset;
+    _ranges[range].size -= padding;
+    insertFree(front);
+  }
+
+  if (_ranges[range].size > size)
+  {
+    const RangeIndex back = createRange(
+      alignedOffset + size, _ranges[range].size - size, range, _ranges[range].next);
+    if (_ranges[back].next != NoRange)
+      _ranges[_ranges[back].next].previous = back;
+    _ranges[range].next = back;
+    _ranges[range].size = size;
+    insertFree(back);
+  }
+
+  _usedSize += size;
+  ++_allocationCount;
+  return Allocation {
+    .offset = alignedOffset,
+    .size = size,
+    .range = range};
+}
+
+void TlsfAllocator::free(const Allocation& allocation)
+{
+  RangeIndex range = allocation.range;
+  if (range >= _ranges.size()
+    || _ranges[range].free
+    || _ranges[range].size == 0
+    || _ranges[range].offset != allocation.offset
+    || _ranges[range].size != allocation.size)
+    throw std::invalid_argument("Range is not allocated.");
+
+  _usedSize -= allocation.size;
+  --_allocationCount;
+
+  const RangeIndex next = _ranges[range].next;
+  if (next != NoRange && _ranges[next].free)
+  {
+    removeFree(next);
+    mergeNext(range);
+  }
+
+  const RangeIndex previous = _ranges[range].previous;
+  if (previous != NoRange && _ranges[previous].free)
+  {
+    removeFree(previous);
+    mergeNext(previous);
+    range = previous;
+  }
+
+  insertFree(range);
+}
+
+TlsfAllocator::Stats TlsfAllocator::stats() const noexcept
+{
+  Stats stats {
+    .capacity = _capacity,
+    .usedSize = _usedSize,
+    .largestFreeSize = 0,
+    .allocationCount = _allocationCount,
+    .freeRangeCount = _freeRangeCount};
+
+  // Largest free range is in the list of the highest non-empty class.
+  if (_firstLevelMask != 0)
+  {
+    const auto firstLevel = static_cast<uint32_t>(63 - std::countl_zero(_firstLevelMask));
+    const auto secondLevel = static_cast<uint32_t>(31 - std::countl_zero(_secondLevelMasks[firstLevel]));
+    for (RangeIndex range = _freeLists[firstLevel][secondLevel]; range != NoRange; range = _ranges[range].nextFree)
+      stats.largestFreeSize = std::max(stats.largestFreeSize, _ranges[range].size);
+  }
+  return stats;
+}
+
+TlsfAllocator::SizeClass TlsfAllocator::classOf(const Size size) noexcept
+{
+  if (size < SecondLevelCount)
+    return {.firstLevel = 0, .secondLevel = static_cast<uint32_t>(size)};
+
+  const auto power = static_cast<uint32_t>(std::bit_width(size) - 1);
+  return {
+    .firstLevel = power - SecondLevelBits + 1,
+    .secondLevel = static_cast<uint32_t>(size >> (power - SecondLevelBits)) - SecondLevelCount};
+}
+
+std::optional<TlsfAllocator::SizeClass> TlsfAllocator::findClass(Size size) const noexcept
+{
+  // Rounded up to the next class, whose every range is at least as large as the size.
+  if (size >= SecondLevelCount)
+  {
+    const Size classStep = (Size {1} << (std::bit_width(size) - 1 - SecondLevelBits)) - 1;
+    if (size > std::numeric_limits<Size>::max() - classStep)
+      return std::nullopt;
+    size += classStep;
+  }
+  SizeClass sizeClass = classOf(size);
+
+  const uint32_t secondLevelMask = _secondLevelMasks[sizeClass.firstLevel] & (~0u << sizeClass.secondLevel);
+  if (secondLevelMask != 0)
+  {
+    sizeClass.secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMask));
+    return sizeClass;
+  }
+
+  const uint64_t firstLevelMask = _firstLevelMask & (~uint64_t {0} << (sizeClass.firstLevel + 1));
+  if (firstLevelMask == 0)
+    return std::nullopt;
+
+  sizeClass.firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMask));
+  sizeClass.secondLevel = static_cast<uint32_t>(std::countr_zero(_secondLevelMasks[sizeClass.firstLevel]));
+  return sizeClass;
+}
+
+TlsfAllocator::RangeIndex TlsfAllocator::findRange(const Size size, const Size alignment) const noexcept
+{
+  // Any range of the found class fits the size at any alignment of its offset.
+  if (alignment - 1 <= std::numeric_limits<Size>::max() - size)
+  {
+    if (const auto sizeClass = findClass(size + alignment - 1))
+      return _freeLists[sizeClass->firstLevel][sizeClass->secondLevel];
+  }
+
+  // Otherwise the ranges of the classes below it might still fit, tested one by one.
+  const auto fits = [&](const Range& range) {
+    const Size padding = (alignment - range.offset % alignment) % alignment;
+    return range.size >= size && range.size - size >= padding;
+  };
+  const SizeClass sizeClass = classOf(size);
+  for (uint32_t firstLevel = sizeClass.firstLevel; firstLevel < FirstLevelCount; ++firstLevel)
+  {
+    uint32_t mask = _secondLevelMasks[firstLevel];
+    if (firstLevel == sizeClass.firstLevel)
+      mask &= ~0u << sizeClass.secondLevel;
+    for (; mask != 0; mask &= mask - 1)
+    {
+      const auto secondLevel = static_cast<uint32_t>(std::countr_zero(mask));
+      for (RangeIndex range = _freeLists[firstLevel][secondLevel]; range != NoRange; range = _ranges[range].nextFree)
+      {
+        if (fits(_ranges[range]))
+          return range;
+      }
+    }
+  }
+  return NoRange;
+}
+
+TlsfAllocator::RangeIndex TlsfAllocator::createRange(
+  const Size offset,
+  const Size size,
+  const RangeIndex previous,
+  const RangeIndex next)
+{
+  const Range range {
+    .offset = offset,
+    .size = size,
+    .previous = previous,
+    .next = next,
+    .previousFree = NoRange,
+    .nextFree = NoRange,
+    .free = false};
+
+  if (!_rangeFreeList.empty())
+  {
+    const RangeIndex index = _rangeFreeList.back();
+    _rangeFreeList.pop_back();
+    _ranges[index] = range;
+    return index;
+  }
+
+  if (_ranges.size() >= NoRange)
+    throw std::length_error("Allocator ran out of addressable ranges.");
+  _ranges.push_back(range);
+  return static_cast<RangeIndex>(_ranges.size() - 1);
+}
+
+void TlsfAllocator::destroyRange(const RangeIndex range)
+{
+  // Zero size marks the range as neither free nor allocated.
+  _ranges[range].size = 0;
+  _ranges[range].free = false;
+  _rangeFreeList.push_back(range);
+}
+
+void TlsfAllocator::insertFree(const RangeIndex range) noexcept
+{
+  const auto [firstLevel, secondLevel] = classOf(_ranges[range].size);
+  RangeIndex& head = _freeLists[firstLevel][secondLevel];
+
+  _ranges[range].free = true;
+  _ranges[range].previousFree = NoRange;
+  _ranges[range].nextFree = head;
+  if (head != NoRange)
+    _ranges[head].previousFree = range;
+  head = range;
+
+  _firstLevelMask |= uint64_t {1} << firstLevel;
+  _secondLevelMasks[firstLevel] |= 1u << secondLevel;
+  ++_freeRangeCount;
+}
+
+void TlsfAllocator::removeFree(const RangeIndex range) noexcept
+{
+  const auto [firstLevel, secondLevel] = classOf(_ranges[range].size);
+  Range& removed = _ranges[range];
+
+  if (removed.previousFree != NoRange)
+    _ranges[removed.previousFree].nextFree = removed.nextFree;
+  else
+    _freeLists[firstLevel][secondLevel] = removed.nextFree;
+  if (removed.nextFree != NoRange)
+    _ranges[removed.nextFree].previousFree = removed.previousFree;
+
+  if (_freeLists[firstLevel][secondLevel] == NoRange)
+  {
+    _secondLevelMasks[firstLevel] &= ~(1u << secondLevel);
+    if (_secondLevelMasks[firstLevel] == 0)
+      _firstLevelMask &= ~(uint64_t {1} << firstLevel);
+  }
+
+  removed.free = false;
+  removed.previousFree = NoRange;
+  removed.nextFree = NoRange;
+  --_freeRangeCount;
+}
+
+void TlsfAllocator::mergeNext(const RangeIndex range)
+{
+  const RangeIndex next = _ranges[range].next;
+  _ranges[range].size += _ranges[next].size;
+  _ranges[range].next = _ranges[next].next;
+  if (_ranges[next].next != NoRange)
+    _ranges[_ranges[next].next].previous = range;
+  destroyRange(next);
+}
+
+} // namespace arete
@@ -1,9 +1,13 @@
 #include "arete/vulkan.hpp"
 #include "arete/input/glfwInput.hpp"
+#include "arete/threading/triple_buffer.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <thread>
 #include <iostream>
 #include <chrono>
@@ -11,39 +15,9 @@
 namespace arete
 {
 
-//! Finds memory type satisfying memory requirements.
-//! @param memoryProperties Memory properties.
-//! @param memoryRequirements Memory requirements.
-//! @param memoryFlags Memory flags.
-//! @returns Memory type index.
-//! @throws If no appropriate memory was found.
-uint32_t vulkanFindMemoryType(
-  const vk::PhysicalDeviceMemoryProperties& memoryProperties,
-  const vk::MemoryRequirements& memoryRequirements,
-  const vk::MemoryPropertyFlags memoryFlags)
-{
-  int memoryTypeIndex = 0;
-
-  for (; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
-  {
-    const auto memoryTypeBit = 1 << memoryTypeIndex;
-    if (memoryRequirements.memoryTypeBits & memoryTypeBit)
-    {
-      const auto memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
-      if (memoryType.propertyFlags & memoryFlags)
-      {
-        // we found the right memory, yippie!!
-        return memoryTypeIndex;
-      }
-    }
-  }
-
-  throw std::runtime_error("Couldn't find the right memory type");
-}
-
 void VulkanMesh::indexBuffer(
   const vkr::Device& device,
-  const vkr::PhysicalDevice& physicalDevice,
+  VulkanMemoryAllocator& memory,
   const Mesh& mesh)
 {
   const auto& indices = mesh.indices();
@@ -58,31 +32,15 @@ void VulkanMesh::indexBuffer(
     }
   );
 
-  const auto memoryProperties = physicalDevice.getMemoryProperties();
-  const auto memoryRequirements = _indexBuffer.getMemoryRequirements();
-  const uint32_t memoryTypeIndex = vulkanFindMemoryType(
-    memoryProperties,
-    memoryRequirements,
-    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
-    );
-
-  _indexBufferMemory = vkr::DeviceMemory(
-    device,
-    vk::MemoryAllocateInfo {
-      .allocationSize = memoryRequirements.size,
-      .memoryTypeIndex = memoryTypeIndex
-    });
-
-  auto memory = static_cast<uint8_t*>(
-    _indexBufferMemory.mapMemory(0, memoryRequirements.size));
-  std::memcpy(memory,indices.data(), indicesSize);
-  _indexBufferMemory.unmapMemory();
-  _indexBuffer.bindMemory(*_indexBufferMemory, 0);
+  _indexBufferMemory = memory.bind(
+    _indexBuffer,
+    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+  std::memcpy(_indexBufferMemory.mapped(), indices.data(), indicesSize);
 }
 
 void VulkanMesh::vertexBuffer(
   const vkr::Device& device,
-  const vkr::PhysicalDevice& physicalDevice,
+  VulkanMemoryAllocator& memory,
   const Mesh& mesh)
 {
   const auto& vertices = mesh.vertices();
@@ -96,25 +54,10 @@ void VulkanMesh::vertexBuffer(
       .sharingMode = vk::SharingMode::eExclusive
     });
 
-  const auto memoryProperties = physicalDevice.getMemoryProperties();
-  const auto memoryRequirements = _vertexBuffer.getMemoryRequirements();
-  const uint32_t memoryTypeIndex = vulkanFindMemoryType(
-    memoryProperties,
-    memoryRequirements,
+  _vertexBufferMemory = memory.bind(
+    _vertexBuffer,
     vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
-
-  _vertexBufferMemory = vkr::DeviceMemory(
-    device,
-    vk::MemoryAllocateInfo {
-      .allocationSize = memoryRequirements.size,
-      .memoryTypeIndex = memoryTypeIndex
-    });
-
-  auto memory = static_cast<uint8_t*>(
-    _vertexBufferMemory.mapMemory(0, memoryRequirements.size));
-  std::memcpy(memory, vertices.data(), verticesSize);
-  _vertexBufferMemory.unmapMemory();
-  _vertexBuffer.bindMemory(*_vertexBufferMemory, 0);
+  std::memcpy(_vertexBufferMemory.mapped(), vertices.data(), verticesSize);
 }
 
 } // namespace arete
@@ -314,19 +257,88 @@ void VulkanEngine::run()
   const auto& mesh = getMesh(_renderer._mesh._mesh);
   _renderer._mesh.indexBuffer(
     _renderer._device,
-    _renderer._physicalDevice,
+    *_renderer._memory,
     mesh
   );
   _renderer._mesh.vertexBuffer(
     _renderer._device,
-    _renderer._physicalDevice,
+    *_renderer._memory,
     mesh
   );
 
-  InFlightRendering rendering(_renderer, *this);
+  // Resources of every heap share a few device memory blocks.
+  const auto heapStats = _renderer._memory->heapStats();
+  for (size_t heap = 0; heap < heapStats.size(); ++heap)
+  {
+    const auto& stats = heapStats[heap];
+    if (stats.blockCount == 0)
+      continue;
+    printf(
+      "Memory heap %zu: %zu allocations in %u blocks, %llu of %llu bytes used, fragmentation %.2f\n",
+      heap, stats.allocationCount, stats.blockCount,
+      static_cast<unsigned long long>(stats.usedSize), static_cast<unsigned long long>(stats.blockSize),
+      stats.fragmentation());
+  }
+
+  // Bounding sphere of the mesh around the center of its bounds.
+  glm::vec3 meshMin(std::numeric_limits<float>::max());
+  glm::vec3 meshMax(std::numeric_limits<float>::lowest());
+  for (const auto& vertex: mesh.vertices())
+  {
+    meshMin = glm::min(meshMin, vertex);
+    meshMax = glm::max(meshMax, vertex);
+  }
+  const glm::vec3 meshCenter = (meshMin + meshMax) * 0.5f;
+  float meshRadius = 0.0f;
+  for (const auto& vertex: mesh.vertices())
+    meshRadius = std::max(meshRadius, glm::length(vertex - meshCenter));
+
+  InFlightRendering rendering(_renderer);
+
+  // Simulation hands frames over to the rendering through the triple buffer,
+  // so neither waits for the other.
+  arete::threading::TripleBuffer<arete::FrameState> frames({
+    .pushConstants = _pushConstants});
+  std::atomic<bool> renderingStopped {false};
+
+  // Stops and joins the render thread when the loop ends, also when it throws,
+  // as destroying a joinable thread terminates the process.
+  struct RenderThreadGuard
+  {
+    std::thread& thread;
+    std::atomic<bool>& stopped;
+    arete::threading::TripleBuffer<arete::FrameState>& frames;
+
+    ~RenderThreadGuard()
+    {
+      if (!thread.joinable())
+        return;
+      stopped.store(true, std::memory_order_relaxed);
+      frames.publish();
+      thread.join();
+    }
+  };
+
+  std::thread renderThread;
+  RenderThreadGuard renderThreadGuard {renderThread, renderingStopped, frames};
+  if (_pipelinedRendering)
+  {
+    renderThread = std::thread([&frames, &renderingStopped, &rendering]() {
+      while (true)
+      {
+        frames.wait();
+        frames.acquire();
+        // Stop is published as a frame of its own, acquiring it makes the flag visible.
+        if (renderingStopped.load(std::memory_order_relaxed))
+          break;
+        rendering.draw(frames.front());
+      }
+    });
+  }
 
   // Engine ticking
-  arete::TickClock tickClock(0);
+  // Pipelined simulation is not paced by the rendering anymore, cap it instead of spinning.
+  arete::TickClock tickClock(_pipelinedRendering ? 240.0f : 0.0f);
   arete::TickClock physicsTickClock(60);
 
 //  arete::Composer composer;
@@ -334,18 +346,40 @@ void VulkanEngine::run()
 //  _physicsSystems.tick();
 //  _drawSystems.tick(composer);
 
+  // Transform of the rendered mesh.
+  const auto meshTransform = _transforms.create();
+
+  // Camera position moves in physics steps and is interpolated for rendering.
+  glm::vec3 previousCamPos = cam.pos;
+
+  // World bounding spheres of the meshes, culled before every frame is handed to the rendering.
+  std::vector<float> meshSphereX(1);
+  std::vector<float> meshSphereY(1);
+  std::vector<float> meshSphereZ(1);
+  std::vector<float> meshSphereRadius(1);
+
   while(!glfwWindowShouldClose(_display._window))
   {
     _glfwInput.processInput();
+    _frameTasks.resume();
+
+    const auto physicsTick = physicsTickClock.fixedStep();
+    for (uint32_t step = 0; step < physicsTick.stepCount; ++step)
+    {
+      previousCamPos = cam.pos;
+      cam.pos += (cameraMoveInput * cam.rot) * physicsTick.stepDelta * speed;
 
-    const auto engineTick = tickClock.tick();
+      _scheduler.run(physicsTick.stepDelta);
+      _transforms.update(arete::threading::JobSystem::shared());
+    }
+
+    const auto engineTick = tickClock.waitForTick();
     // tick
     if (engineTick.shouldTick)
     {
       // update
       _pushConstants.time += engineTick.deltaTime;
 
-      cam.pos += (cameraMoveInput * cam.rot) * engineTick.deltaTime * speed;
       if (cameraDragInput)
       {
         cam.rot = 
@@ -358,16 +392,50 @@ void VulkanEngine::run()
       // _pushConstantsCore.cameraPos = cam.pos;
       // _pushConstantsCore.cameraDir = glm::vec3(0, 0, 1) * cam.rot;
 
+      _shaderMatrices.model = _transforms.world(meshTransform);
+      _pushConstants.model = _shaderMatrices.model;
+
+      const glm::vec3 renderCamPos = glm::mix(previousCamPos, cam.pos, physicsTick.alpha);
       _shaderMatrices.view = glm::lookAt(
-        cam.pos,
-        cam.pos + glm::vec3(0, 0, 1) * cam.rot,
+        renderCamPos,
+        renderCamPos + glm::vec3(0, 0, 1) * cam.rot,
         glm::vec3(0, 1, 0) * cam.rot
       );
 
       _pushConstants.mvp = _shaderMatrices.clip * _shaderMatrices.proj * _shaderMatrices.view * _shaderMatrices.model;
     }
 
-    rendering.draw();
+    // Cull meshes outside of the camera frustum
+    {
+      const glm::mat4& model = _shaderMatrices.model;
+      const glm::vec3 center(model * glm::vec4(meshCenter, 1.0f));
+      const float scale = std::max({
+        glm::length(glm::vec3(model[0])),
+        glm::length(glm::vec3(model[1])),
+        glm::length(glm::vec3(model[2]))});
+      meshSphereX[0] = center.x;
+      meshSphereY[0] = center.y;
+      meshSphereZ[0] = center.z;
+      meshSphereRadius[0] = meshRadius * scale;
+
+      _culler.cull(
+        arete::hcs::Frustum::fromMatrix(_shaderMatrices.clip * _shaderMatrices.proj * _shaderMatrices.view),
+        {meshSphereX, meshSphereY, meshSphereZ, meshSphereRadius},
+        arete::threading::JobSystem::shared());
+    }
+
+    // Back frame keeps the capacity of its visible list.
+    auto& frame = frames.back();
+    frame.pushConstants = _pushConstants;
+    frame.visibleMeshes.assign(_culler.visible().begin(), _culler.visible().end());
+    frame.culling = _culler.stats();
+    frames.publish();
+
+    if (!_pipelinedRendering)
+    {
+      frames.acquire();
+      rendering.draw(frames.front());
+    }
 
     if(glfwGetKey(_display._window, GLFW_KEY_ESCAPE))
     {
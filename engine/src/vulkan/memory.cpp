@@ -0,0 +1,227 @@
+#include "arete/vulkan_memory.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace arete
+{
+
+VulkanAllocation::VulkanAllocation(VulkanAllocation&& other) noexcept
+  : _allocator(std::exchange(other._allocator, nullptr))
+  , _memory(std::exchange(other._memory, vk::DeviceMemory {}))
+  , _mapped(std::exchange(other._mapped, nullptr))
+  , _range(other._range)
+  , _pool(other._pool)
+  , _block(other._block)
+{}
+
+VulkanAllocation& VulkanAllocation::operator=(VulkanAllocation&& other) noexcept
+{
+  if (this != &other)
+  {
+    reset();
+    _allocator = std::exchange(other._allocator, nullptr);
+    _memory = std::exchange(other._memory, vk::DeviceMemory {});
+    _mapped = std::exchange(other._mapped, nullptr);
+    _range = other._range;
+    _pool = other._pool;
+    _block = other._block;
+  }
+  return *this;
+}
+
+VulkanAllocation::~VulkanAllocation()
+{
+  reset();
+}
+
+void VulkanAllocation::reset() noexcept
+{
+  if (_allocator == nullptr)
+    return;
+
+  _allocator->free(*this);
+  _allocator = nullptr;
+  _memory = vk::DeviceMemory {};
+  _mapped = nullptr;
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(
+  const vkr::Device& device,
+  const vkr::PhysicalDevice& physicalDevice,
+  const vk::DeviceSize blockSize)
+  : _device(&device)
+  , _memoryProperties(physicalDevice.getMemoryProperties())
+  , _bufferImageGranularity(physicalDevice.getProperties().limits.bufferImageGranularity)
+  , _blockSize(blockSize)
+{
+  _pools.resize(_memoryProperties.memoryTypeCount * 2);
+  for (uint32_t pool = 0; pool < _pools.size(); ++pool)
+    _pools[pool].memoryType = pool / 2;
+}
+
+VulkanAllocation VulkanMemoryAllocator::allocate(
+  const vk::MemoryRequirements& requirements,
+  const vk::MemoryPropertyFlags flags,
+  const VulkanResourceKind kind)
+{
+  const uint32_t memoryType = memoryTypeOf(requirements, flags);
+  const bool separateOptimal = _bufferImageGranularity > 1 && kind == VulkanResourceKind::Optimal;
+  const uint32_t poolIndex = memoryType * 2 + (separateOptimal ? 1 : 0);
+  const vk::DeviceSize alignment = std::max<vk::DeviceSize>(requirements.alignment, 1);
+
+  std::scoped_lock lock(_mutex);
+  Pool& pool = _pools[poolIndex];
+
+  const auto allocationOf = [&](const uint32_t blockIndex, const TlsfAllocator::Allocation& range) {
+    const Block& block = *pool.blocks[blockIndex];
+    VulkanAllocation allocation;
+    allocation._allocator = this;
+    allocation._memory = *block.memory;
+    allocation._mapped = block.mapped != nullptr ? static_cast<std::byte*>(block.mapped) + range.offset : nullptr;
+    allocation._range = range;
+    allocation._pool = poolIndex;
+    allocation._block = blockIndex;
+    return allocation;
+  };
+
+  const vk::DeviceSize blockSize = blockSizeOf(memoryType);
+  const bool dedicated = requirements.size > blockSize / 2;
+  if (!dedicated)
+  {
+    for (uint32_t blockIndex = 0; blockIndex < pool.blocks.size(); ++blockIndex)
+    {
+      if (pool.blocks[blockIndex] == nullptr)
+        continue;
+      if (const auto range = pool.blocks[blockIndex]->ranges.allocate(requirements.size, alignment))
+        return allocationOf(blockIndex, *range);
+    }
+  }
+
+  // No block has space, or the resource is too large to share one, which is released once it is freed.
+  // Such a block is sized to the resource, rounded up to its alignment and to the buffer-image granularity.
+  const vk::DeviceSize granularity = std::max(alignment, _bufferImageGranularity);
+  const vk::DeviceSize capacity = dedicated
+    ? (requirements.size + granularity - 1) / granularity * granularity
+    : blockSize;
+  vkr::DeviceMemory memory(
+    *_device,
+    vk::MemoryAllocateInfo {
+      .allocationSize = capacity,
+      .memoryTypeIndex = memoryType});
+  const bool hostVisible = static_cast<bool>(
+    _memoryProperties.memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible);
+  void* mapped = hostVisible ? memory.mapMemory(0, VK_WHOLE_SIZE) : nullptr;
+
+  auto block = std::make_unique<Block>(Block {
+    .memory = std::move(memory),
+    .ranges = TlsfAllocator(capacity),
+    .mapped = mapped});
+  const auto range = block->ranges.allocate(requirements.size, alignment);
+  ++_deviceAllocationCount;
+
+  const auto freeSlot = std::find(pool.blocks.begin(), pool.blocks.end(), nullptr);
+  const auto blockIndex = static_cast<uint32_t>(freeSlot - pool.blocks.begin());
+  if (freeSlot != pool.blocks.end())
+    *freeSlot = std::move(block);
+  else
+    pool.blocks.push_back(std::move(block));
+  return allocationOf(blockIndex, *range);
+}
+
+VulkanAllocation VulkanMemoryAllocator::bind(const vkr::Buffer& buffer, const vk::MemoryPropertyFlags flags)
+{
+  auto allocation = allocate(buffer.getMemoryRequirements(), flags, VulkanResourceKind::Linear);
+  buffer.bindMemory(allocation.memory(), allocation.offset());
+  return allocation;
+}
+
+VulkanAllocation VulkanMemoryAllocator::bind(
+  const vkr::Image& image,
+  const vk::ImageTiling tiling,
+  const vk::MemoryPropertyFlags flags)
+{
+  auto allocation = allocate(
+    image.getMemoryRequirements(),
+    flags,
+    tiling == vk::ImageTiling::eLinear ? VulkanResourceKind::Linear : VulkanResourceKind::Optimal);
+  image.bindMemory(allocation.memory(), allocation.offset());
+  return allocation;
+}
+
+std::vector<VulkanHeapStats> VulkanMemoryAllocator::heapStats() const
+{
+  std::vector<VulkanHeapStats> heaps(_memoryProperties.memoryHeapCount);
+  for (uint32_t heap = 0; heap < heaps.size(); ++heap)
+    heaps[heap].heapSize = _memoryProperties.memoryHeaps[heap].size;
+
+  std::scoped_lock lock(_mutex);
+  for (const auto& pool: _pools)
+  {
+    auto& heap = heaps[_memoryProperties.memoryTypes[pool.memoryType].heapIndex];
+    for (const auto& block: pool.blocks)
+    {
+      if (block == nullptr)
+        continue;
+
+      const auto stats = block->ranges.stats();
+      heap.blockSize += stats.capacity;
+      heap.usedSize += stats.usedSize;
+      heap.largestFreeSize = std::max(heap.largestFreeSize, stats.largestFreeSize);
+      heap.allocationCount += stats.allocationCount;
+      ++heap.blockCount;
+    }
+  }
+  return heaps;
+}
+
+uint32_t VulkanMemoryAllocator::deviceAllocationCount() const
+{
+  std::scoped_lock lock(_mutex);
+  return _deviceAllocationCount;
+}
+
+uint32_t VulkanMemoryAllocator::memoryTypeOf(
+  const vk::MemoryRequirements& requirements,
+  const vk::MemoryPropertyFlags flags) const
+{
+  for (uint32_t memoryType = 0; memoryType < _memoryProperties.memoryTypeCount; ++memoryType)
+  {
+    if ((requirements.memoryTypeBits & (1u << memoryType)) == 0)
+      continue;
+    if ((_memoryProperties.memoryTypes[memoryType].propertyFlags & flags) == flags)
+      return memoryType;
+  }
+
+  throw std::runtime_error("No memory type satisfies the memory requirements.");
+}
+
+vk::DeviceSize VulkanMemoryAllocator::blockSizeOf(const uint32_t memoryType) const noexcept
+{
+  const uint32_t heap = _memoryProperties.memoryTypes[memoryType].heapIndex;
+  return std::min(_blockSize, _memoryProperties.memoryHeaps[heap].size / 8);
+}
+
+void VulkanMemoryAllocator::free(const VulkanAllocation& allocation) noexcept
+{
+  std::scoped_lock lock(_mutex);
+  Pool& pool = _pools[allocation._pool];
+  auto& block = pool.blocks[allocation._block];
+  block->ranges.free(allocation._range);
+  if (!block->ranges.empty())
+    return;
+
+  // Last block of the pool is kept to avoid reallocating it when resources are recreated,
+  // unless it was allocated for a single large resource.
+  const bool lastBlock = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const auto& other) {
+    return other != nullptr;
+  }) == 1;
+  if (lastBlock && block->ranges.capacity() == blockSizeOf(pool.memoryType))
+    return;
+
+  block.reset();
+  --_deviceAllocationCount;
+}
+
+} // namespace arete
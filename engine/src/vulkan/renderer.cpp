@@ -77,6 +77,8 @@ void VulkanRenderer::logicalDevice()
       .pQueueCreateInfos = &deviceQueueCreateInfo,
       .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
       .ppEnabledExtensionNames = extensions.data()});
+
+  _memory.emplace(_device, _physicalDevice);
 }
 
 void VulkanRenderer::swapChain()
@@ -217,31 +219,7 @@ void VulkanRenderer::depthBuffer()
       .sharingMode = vk::SharingMode::eExclusive,
     });
 
-  const vk::PhysicalDeviceMemoryProperties memoryProperties = _physicalDevice.getMemoryProperties();
-  const vk::MemoryRequirements memoryRequirements = _depthImage.getMemoryRequirements();
-
-  uint32_t memoryTypeBits = memoryRequirements.memoryTypeBits;
-  uint32_t memoryTypeIndex = ~0;
-  for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
-  {
-    const auto& memoryType = memoryProperties.memoryTypes[i];
-    if ((memoryTypeBits & 1) && (memoryType.propertyFlags & vk::MemoryPropertyFlagBits::eDeviceLocal) == vk::MemoryPropertyFlagBits::eDeviceLocal)
-    {
-      memoryTypeIndex = i;
-      break;
-    }
-    memoryTypeBits >>= 1;
-  }
-  assert(memoryTypeIndex != ~0);
-
-  _depthMemory = vkr::DeviceMemory(
-    _device,
-    vk::MemoryAllocateInfo{
-      .allocationSize = memoryRequirements.size,
-      .memoryTypeIndex = memoryTypeIndex,
-    });
-
-  _depthImage.bindMemory(*_depthMemory, 0);
+  _depthMemory = _memory->bind(_depthImage, imageTiling, vk::MemoryPropertyFlagBits::eDeviceLocal);
 
   _depthImageView = vkr::ImageView(
     _device,
@@ -268,33 +246,9 @@ void VulkanRenderer::uniformBuffer()
     }
   );
 
-  const auto memoryProperties = _physicalDevice.getMemoryProperties();
-  const auto memoryRequirements = _uniformBuffer.getMemoryRequirements();
-  uint32_t memoryTypeIndex = 0;
-
-  // Find the right memory for the uniform buffer.
-  for (; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
-  {
-    const auto memoryTypeBit = 1 << memoryTypeIndex;
-    if (memoryRequirements.memoryTypeBits & memoryTypeBit)
-    {
-      const auto memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
-      if (memoryType.propertyFlags & (vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent))
-      {
-        // we found the right memory, yippie!!
-        break;
-      }
-    }
-  }
-
-  _uniformBufferMemory = vkr::DeviceMemory(
-    _device,
-    vk::MemoryAllocateInfo{
-      .allocationSize = memoryRequirements.size,
-      .memoryTypeIndex = memoryTypeIndex,
-    });
-
-  _uniformBuffer.bindMemory(*_uniformBufferMemory, 0);
+  _uniformBufferMemory = _memory->bind(
+    _uniformBuffer,
+    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
 }
 
 void VulkanRenderer::renderPass()
@@ -672,8 +626,8 @@ void VulkanRenderer::setup()
 }
 
 
-InFlightRendering::InFlightRendering(const VulkanRenderer& renderer, const VulkanEngine& engine)
-    : _renderer(renderer), _engine(engine)
+InFlightRendering::InFlightRendering(const VulkanRenderer& renderer)
+    : _renderer(renderer)
 {
   const auto& device = _renderer._device;
   // Image available semaphores
@@ -727,14 +681,39 @@ InFlightRendering::~InFlightRendering()
 }
 
 
-void InFlightRendering::draw()
+void InFlightRendering::draw(const arete::FrameState& frame)
 {
-  render();
+  render(frame);
   present();
   _inFlightFrameIndex = (_inFlightFrameIndex + 1) % MaxFramesInFlight;
+  reportCulling(frame.culling);
+}
+
+void InFlightRendering::reportCulling(const hcs::CullingStats& culling)
+{
+  _culling.visibleCount += culling.visibleCount;
+  _culling.culledCount += culling.culledCount;
+  _culling.duration += culling.duration;
+  ++_cullingFrameCount;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - _cullingReportTime < CullingReportInterval)
+    return;
+
+  const auto frameCount = static_cast<double>(_cullingFrameCount);
+  printf(
+    "Culling: %.1f visible and %.1f culled meshes per frame, %.3f ms per cull over %zu frames\n",
+    static_cast<double>(_culling.visibleCount) / frameCount,
+    static_cast<double>(_culling.culledCount) / frameCount,
+    std::chrono::duration<double, std::milli>(_culling.duration).count() / frameCount,
+    _cullingFrameCount);
+
+  _culling = {};
+  _cullingFrameCount = 0;
+  _cullingReportTime = now;
 }
 
-void InFlightRendering::render()
+void InFlightRendering::render(const arete::FrameState& frame)
 {
   const auto& device = _renderer._device;
   const auto& frameFence
@@ -800,14 +779,14 @@ void InFlightRendering::render()
     pipelineLayout,
     vk::ShaderStageFlagBits::eVertex,
     0,
-    vk::ArrayProxy<const arete::PushConstants>({_engine._pushConstants})
+    vk::ArrayProxy<const arete::PushConstants>({frame.pushConstants})
   );
 
   commandBuffer.pushConstants(
     pipelineLayout,
     vk::ShaderStageFlagBits::eFragment,
     sizeof(arete::PushConstants),
-    vk::ArrayProxy<const float>({_engine._pushConstants.time})
+    vk::ArrayProxy<const float>({frame.pushConstants.time})
   );
 
   // commandBuffer.pushConstants(
@@ -825,37 +804,41 @@ void InFlightRendering::render()
     nullptr
   );
 
-  // Bind VBOs
-  const auto& vertexBuffer = *_renderer._mesh._vertexBuffer;
-  commandBuffer.bindVertexBuffers(
-    0, {vertexBuffer}, {0}
-  );
-
-  // Bind IBO
-  const auto& indexBuffer = *_renderer._mesh._indexBuffer;
-  commandBuffer.bindIndexBuffer(
-    indexBuffer, 0, vk::IndexType::eUint16
-  );
-
-  // Scissor
-  commandBuffer.setScissor(
-    0, vk::Rect2D(vk::Offset2D( 0, 0 ), _renderer._surfaceCapabilities.currentExtent));
-
-  // Viewport
-  commandBuffer.setViewport(
-    0, vk::Viewport(
-         0.0f,
-         0.0f,
-         static_cast<float>(_renderer._surfaceCapabilities.currentExtent.width),
-         static_cast<float>(_renderer._surfaceCapabilities.currentExtent.height),
-         0.0f,
-         1.0f
-         )
-  );
-
-  commandBuffer.drawIndexed(
-    36, 1, 0, 0, 0
-  );
+  // The renderer holds a single mesh, drawn unless it was culled.
+  if (!frame.visibleMeshes.empty())
+  {
+    // Bind VBOs
+    const auto& vertexBuffer = *_renderer._mesh._vertexBuffer;
+    commandBuffer.bindVertexBuffers(
+      0, {vertexBuffer}, {0}
+    );
+
+    // Bind IBO
+    const auto& indexBuffer = *_renderer._mesh._indexBuffer;
+    commandBuffer.bindIndexBuffer(
+      indexBuffer, 0, vk::IndexType::eUint16
+    );
+
+    // Scissor
+    commandBuffer.setScissor(
+      0, vk::Rect2D(vk::Offset2D( 0, 0 ), _renderer._surfaceCapabilities.currentExtent));
+
+    // Viewport
+    commandBuffer.setViewport(
+      0, vk::Viewport(
+           0.0f,
+           0.0f,
+           static_cast<float>(_renderer._surfaceCapabilities.currentExtent.width),
+           static_cast<float>(_renderer._surfaceCapabilities.currentExtent.height),
+           0.0f,
+           1.0f
+           )
+    );
+
+    commandBuffer.drawIndexed(
+      36, 1, 0, 0, 0
+    );
+  }
 
   commandBuffer.endRenderPass();
   commandBuffer.end();
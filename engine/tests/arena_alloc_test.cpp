@@ -0,0 +1,206 @@
+#include <arete/hcs/hcs.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+//! Count of calls to the global operator new.
+std::atomic<size_t> globalAllocations = 0;
+
+} // namespace
+
+void* operator new(const size_t size)
+{
+  globalAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size == 0 ? 1 : size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment)
+{
+  globalAllocations.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<size_t>(alignment);
+  if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+namespace
+{
+
+//! Component of the test.
+struct TestComponent
+{
+  float values[8] {};
+  uint32_t id = 0;
+};
+
+} // namespace
+
+template<>
+struct std::hash<TestComponent>
+{
+  size_t operator()(const TestComponent& component) const noexcept
+  {
+    return component.id;
+  }
+};
+
+namespace
+{
+
+using TestArena = arete::hcs::Arena<uint32_t, TestComponent>;
+
+constexpr size_t LiveCount = 4096;
+constexpr size_t ChurnRounds = 64;
+
+//! Creates and destroys objects one by one and in bulk.
+void churn(TestArena& arena, std::pmr::vector<uint32_t>& handles)
+{
+  for (size_t round = 0; round < ChurnRounds; ++round)
+  {
+    // Replace every other object one by one.
+    for (size_t i = round % 2; i < handles.size(); i += 2)
+    {
+      arena.destroyObject(handles[i]);
+      handles[i] = arena.createObject().first;
+    }
+
+    // Replace a quarter of the objects in bulk.
+    const size_t bulkCount = handles.size() / 4;
+    arena.destroyObjects(std::span(handles).first(bulkCount));
+    const auto created = arena.createObjects(bulkCount);
+    std::copy(created.begin(), created.end(), handles.begin());
+
+    arena.forEachChanged([](uint32_t, TestComponent& component) {
+      ++component.id;
+    });
+    arena.clearChanges();
+  }
+}
+
+//! Reports allocations made by the churn after the warm-up.
+//! @returns True if the churn did not allocate.
+bool testSteadyState(const char* name, TestArena& arena)
+{
+  arena.trackChanges(true);
+
+  std::pmr::vector<uint32_t> handles(LiveCount, arena.resource());
+  for (auto& handle: handles)
+    handle = arena.createObject().first;
+
+  // Warm up, so the storage grows to its peak.
+  churn(arena, handles);
+
+  const size_t before = globalAllocations.load();
+  churn(arena, handles);
+  const size_t allocations = globalAllocations.load() - before;
+
+  std::printf("%s: %zu global allocations during churn\n", name, allocations);
+  return allocations == 0 && arena.size() == LiveCount;
+}
+
+//! System of the test components.
+class TestSystem
+  : public arete::hcs::SystemBase<TestComponent>
+{
+public:
+  using SystemBase::SystemBase;
+
+  void destroyComponent(const arete::hcs::ComponentHandle component) override
+  {
+    _arena.destroyObject(component);
+  }
+
+  TestComponent& getComponent(const arete::hcs::ComponentHandle component) override
+  {
+    return _arena.getObject(component)->get();
+  }
+};
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+
+  {
+    TestArena arena;
+    passed &= testSteadyState("default resource", arena);
+  }
+
+  {
+    // Level storage carved from a fixed buffer, the global heap is never touched.
+    static std::array<std::byte, 8 * 1024 * 1024> buffer;
+    std::pmr::monotonic_buffer_resource level(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    std::pmr::unsynchronized_pool_resource pool(&level);
+
+    const size_t before = globalAllocations.load();
+    {
+      TestArena arena(&pool);
+      passed &= testSteadyState("pool resource", arena);
+    }
+    const size_t allocations = globalAllocations.load() - before;
+    std::printf("pool resource: %zu global allocations in total\n", allocations);
+    passed &= allocations == 0;
+
+    // Release the whole level at once.
+    pool.release();
+    level.release();
+  }
+
+  {
+    std::pmr::unsynchronized_pool_resource pool;
+    TestSystem system(&pool);
+    const auto component = system.createComponent();
+    system.getComponent(component).id = 7;
+
+    const auto replace = [&system]() {
+      for (size_t i = 0; i < 1024; ++i)
+        system.destroyComponent(system.createComponent());
+    };
+
+    // Slots are reused once the minimum of free slots is reached, warm up past it.
+    for (size_t warmUp = 0; warmUp < 3; ++warmUp)
+      replace();
+    const size_t before = globalAllocations.load();
+    replace();
+    const size_t allocations = globalAllocations.load() - before;
+    std::printf("system: %zu global allocations during churn\n", allocations);
+    passed &= allocations == 0 && system.getComponent(component).id == 7;
+  }
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
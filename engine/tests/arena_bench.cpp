@@ -0,0 +1,183 @@
+#include <arete/hcs/arena.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+//! Component sized like a typical spatial component.
+struct BenchComponent
+{
+  float values[12] {};
+};
+
+using Clock = std::chrono::steady_clock;
+
+//! Measures lookup of live objects through generational handles in random order.
+//! @param count Count of live objects.
+//! @returns Nanoseconds per lookup.
+double benchArenaLookup(const size_t count, const std::vector<size_t>& order)
+{
+  arete::hcs::Arena<uint32_t, BenchComponent> arena;
+  std::vector<uint32_t> handles;
+  handles.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const auto [handle, object] = arena.createObject();
+    object.values[0] = static_cast<float>(i);
+    handles.push_back(handle);
+  }
+
+  float sum = 0;
+  const auto start = Clock::now();
+  for (const auto index: order)
+  {
+    if (const auto object = arena.getObject(handles[index]))
+      sum += object->get().values[0];
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  // Keep the sum observable so the loop is not optimized out.
+  std::printf("  (checksum %f)\n", sum);
+  return elapsed / static_cast<double>(order.size());
+}
+
+//! Measures lookup through the previous hash map index for comparison.
+//! @param count Count of live objects.
+//! @returns Nanoseconds per lookup.
+double benchHashMapLookup(const size_t count, const std::vector<size_t>& order)
+{
+  std::vector<BenchComponent> objects(count);
+  std::unordered_map<uint32_t, int64_t> index;
+  for (size_t i = 0; i < count; ++i)
+  {
+    objects[i].values[0] = static_cast<float>(i);
+    index[static_cast<uint32_t>(i)] = static_cast<int64_t>(i);
+  }
+
+  float sum = 0;
+  const auto start = Clock::now();
+  for (const auto handle: order)
+  {
+    const auto iterator = index.find(static_cast<uint32_t>(handle));
+    if (iterator != index.end())
+      sum += objects[iterator->second].values[0];
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  std::printf("  (checksum %f)\n", sum);
+  return elapsed / static_cast<double>(order.size());
+}
+
+//! Measures creating and destroying objects one by one and in bulk.
+//! @param count Count of objects.
+void benchBulk(const size_t count)
+{
+  using Arena = arete::hcs::Arena<uint32_t, BenchComponent>;
+
+  double singleCreateMs = 0;
+  double singleDestroyMs = 0;
+  {
+    Arena arena;
+    std::vector<uint32_t> handles;
+    handles.reserve(count);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i)
+      handles.push_back(arena.createObject().first);
+    singleCreateMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (const auto handle: handles)
+      arena.destroyObject(handle);
+    singleDestroyMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  double bulkCreateMs = 0;
+  double bulkDestroyMs = 0;
+  {
+    Arena arena;
+
+    auto start = Clock::now();
+    const auto created = arena.createObjects(count, [](const size_t index) {
+      BenchComponent component;
+      component.values[0] = static_cast<float>(index);
+      return component;
+    });
+    const std::vector<uint32_t> handles(created.begin(), created.end());
+    bulkCreateMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    arena.destroyObjects(handles);
+    bulkDestroyMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  std::printf(
+    "objects=%zu create single=%.2f ms bulk=%.2f ms, destroy single=%.2f ms bulk=%.2f ms\n",
+    count, singleCreateMs, bulkCreateMs, singleDestroyMs, bulkDestroyMs);
+}
+
+//! Measures snapshot, restore and delta of an arena with a fraction of objects changed.
+//! @param count Count of objects.
+void benchSnapshot(const size_t count)
+{
+  arete::hcs::Arena<uint32_t, BenchComponent> arena;
+  const auto created = arena.createObjects(count, [](const size_t index) {
+    BenchComponent component;
+    component.values[0] = static_cast<float>(index);
+    return component;
+  });
+  const std::vector<uint32_t> handles(created.begin(), created.end());
+
+  auto start = Clock::now();
+  const auto base = arena.snapshot();
+  const double snapshotMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  // Change every hundredth object.
+  for (size_t i = 0; i < count; i += 100)
+    arena.getObject(handles[i])->get().values[1] = 1.0f;
+  const auto target = arena.snapshot();
+
+  start = Clock::now();
+  const auto delta = arete::hcs::diffSnapshots(base, target);
+  const double diffMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  start = Clock::now();
+  arena.restore(base);
+  const double restoreMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  std::printf(
+    "objects=%zu snapshot=%.2f ms (%zu bytes) restore=%.2f ms diff=%.2f ms (%zu bytes, %zu runs)\n",
+    count, snapshotMs, base.data.size(), restoreMs, diffMs, delta.bytes.size(), delta.runs.size());
+}
+
+} // namespace
+
+int main()
+{
+  constexpr size_t LookupCount = 4'000'000;
+
+  std::mt19937 random(0xA7E7E);
+  for (const size_t count: {10'000, 100'000, 1'000'000})
+  {
+    std::vector<size_t> order(LookupCount);
+    std::uniform_int_distribution<size_t> distribution(0, count - 1);
+    std::generate(order.begin(), order.end(), [&]() { return distribution(random); });
+
+    const double arenaNs = benchArenaLookup(count, order);
+    const double mapNs = benchHashMapLookup(count, order);
+    std::printf(
+      "live=%zu arena=%.2f ns/lookup hashmap=%.2f ns/lookup\n",
+      count, arenaNs, mapNs);
+  }
+
+  benchBulk(200'000);
+  benchSnapshot(1'000'000);
+
+  return 0;
+}
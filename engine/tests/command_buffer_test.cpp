@@ -0,0 +1,241 @@
+#include <arete/hcs/command_buffer.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+//! Component of the recorded actors.
+struct Spawned
+{
+  uint32_t id = 0;
+};
+
+//! Component added by a recorded command.
+struct Tagged
+{
+  uint32_t id = 0;
+};
+
+//! Object of the recorded arena objects.
+struct Particle
+{
+  uint32_t id = 0;
+};
+
+using Arena = arete::hcs::Arena<uint32_t, Particle>;
+
+constexpr uint32_t TaskCount = 10'000;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! @returns Sum of the ids of the particles in the arena.
+uint64_t particleIdSum(Arena& arena)
+{
+  uint64_t sum = 0;
+  for (const auto& particle: arena.objects())
+    sum += particle.id;
+  return sum;
+}
+
+//! Records commands from the tasks of a parallel for, and from threads outside of the job system.
+bool recordInParallel()
+{
+  arete::threading::JobSystem jobs(4);
+  arete::hcs::CommandQueue queue(jobs);
+  arete::hcs::World world;
+  Arena arena;
+
+  // Actors destroyed and tagged by the recorded commands.
+  std::vector<arete::hcs::ActorHandle> existing;
+  for (uint32_t id = 0; id < TaskCount; ++id)
+    existing.push_back(world.createActor(Spawned{id}));
+
+  jobs.parallelFor(TaskCount, [&](const size_t task) {
+    const auto id = static_cast<uint32_t>(task);
+    auto local = queue.local();
+    local->createActor(world, Spawned{TaskCount + id});
+    local->createObject(arena, Particle{id});
+    if (id % 2 == 0)
+      local->destroyActor(world, existing[id]);
+    else
+      local->addComponent(world, existing[id], Tagged{id});
+  });
+
+  // Threads outside of the job system share a buffer, as do the threads of another job system.
+  std::vector<std::thread> threads;
+  for (uint32_t thread = 0; thread < 4; ++thread)
+  {
+    threads.emplace_back([&queue, &arena, thread]() {
+      for (uint32_t id = 0; id < TaskCount; ++id)
+        queue.local()->createObject(arena, Particle{thread});
+    });
+  }
+  arete::threading::JobSystem otherJobs(8);
+  otherJobs.parallelFor(TaskCount, [&](const size_t) {
+    queue.local()->createObject(arena, Particle{1});
+  });
+  for (auto& thread: threads)
+    thread.join();
+
+  bool passed = true;
+  passed &= check(queue.size() == 3 * TaskCount + 5 * TaskCount, "every recorded command is queued");
+  passed &= check(world.size() == TaskCount, "nothing is applied before the flush");
+
+  queue.flush();
+  passed &= check(queue.size() == 0, "flush empties the queue");
+  passed &= check(world.size() == TaskCount + TaskCount / 2, "actors are created and destroyed");
+  passed &= check(world.query<Spawned>().size() == TaskCount + TaskCount / 2, "created actors are queried");
+  passed &= check(world.query<Spawned, Tagged>().size() == TaskCount / 2, "components are added");
+  passed &= check(arena.objects().size() == 6 * TaskCount, "objects are created");
+
+  const uint64_t jobIds = uint64_t{TaskCount} * (TaskCount - 1) / 2;
+  const uint64_t threadIds = uint64_t{TaskCount} * (0 + 1 + 2 + 3);
+  passed &= check(particleIdSum(arena) == jobIds + threadIds + TaskCount, "objects hold the recorded values");
+
+  uint32_t taggedMismatches = 0;
+  world.query<Spawned, Tagged>().forEach([&taggedMismatches](const Spawned& spawned, const Tagged& tagged) {
+    taggedMismatches += spawned.id != tagged.id;
+  });
+  passed &= check(taggedMismatches == 0, "components are added to their actors");
+  return passed;
+}
+
+//! Records commands on actors and objects created in the same phase.
+bool pendingHandles()
+{
+  arete::threading::JobSystem jobs(4);
+  arete::hcs::CommandQueue queue(jobs);
+  arete::hcs::World world;
+  Arena arena;
+
+  jobs.parallelFor(TaskCount, [&](const size_t task) {
+    const auto id = static_cast<uint32_t>(task);
+    auto local = queue.local(task);
+    const auto actor = local->createActor(world, Spawned{id});
+    if (id % 2 == 0)
+      local->addComponent(world, actor, Tagged{id});
+    else
+      local->destroyActor(world, actor);
+
+    const auto object = local->createObject(arena, Particle{id});
+    if (id % 2 == 0)
+      local->destroyObject(arena, object);
+  });
+  queue.flush();
+
+  bool passed = true;
+  passed &= check(world.size() == TaskCount / 2, "pending actors are destroyed");
+  passed &= check(world.query<Spawned, Tagged>().size() == TaskCount / 2, "components are added to pending actors");
+  passed &= check(arena.objects().size() == TaskCount / 2, "pending objects are destroyed");
+
+  uint32_t mismatches = 0;
+  world.query<Spawned, Tagged>().forEach([&mismatches](const Spawned& spawned, const Tagged& tagged) {
+    mismatches += spawned.id != tagged.id || spawned.id % 2 != 0;
+  });
+  for (const auto& particle: arena.objects())
+    mismatches += particle.id % 2 == 0;
+  passed &= check(mismatches == 0, "commands resolve the pending handles of their creations");
+  return passed;
+}
+
+//! @returns Ids of the particles created by keyed commands, in the order of the arena.
+std::vector<uint32_t> recordKeyed(arete::threading::JobSystem& jobs)
+{
+  arete::hcs::CommandQueue queue(jobs);
+  Arena arena;
+  jobs.parallelFor(TaskCount, [&](const size_t task) {
+    queue.local(task)->createObject(arena, Particle{static_cast<uint32_t>(task)});
+  });
+  queue.flush();
+
+  std::vector<uint32_t> ids;
+  for (const auto& particle: arena.objects())
+    ids.push_back(particle.id);
+  return ids;
+}
+
+//! Commands are applied ordered by their key, whichever thread recorded them.
+bool deterministicOrder()
+{
+  arete::threading::JobSystem jobs(4);
+  const auto first = recordKeyed(jobs);
+  const auto second = recordKeyed(jobs);
+
+  bool ordered = first.size() == TaskCount;
+  for (uint32_t task = 0; task < first.size(); ++task)
+    ordered &= first[task] == task;
+
+  bool passed = true;
+  passed &= check(ordered, "creations are applied in the order of the keys");
+  passed &= check(first == second, "runs create the same objects in the same order");
+  return passed;
+}
+
+//! Flushes a buffer whose command throws.
+bool flushThrowing()
+{
+  arete::hcs::CommandBuffer buffer;
+  Arena arena;
+  const auto capture = std::make_shared<int>(0);
+
+  // Enough commands to span several blocks, failing in the middle of them.
+  constexpr size_t CommandCount = 20'000;
+  size_t applied = 0;
+  for (size_t command = 0; command < CommandCount; ++command)
+  {
+    buffer.record([capture, command, &applied]() {
+      if (command == CommandCount / 2)
+        throw std::runtime_error("Command failed.");
+      ++applied;
+    });
+  }
+
+  bool passed = true;
+  bool thrown = false;
+  try
+  {
+    buffer.flush();
+  } catch (const std::runtime_error&)
+  {
+    thrown = true;
+  }
+  passed &= check(thrown, "exception of the command propagates");
+  passed &= check(applied == CommandCount / 2, "commands before the failed one are applied");
+  passed &= check(capture.use_count() == 1, "every command is destroyed exactly once");
+  passed &= check(buffer.size() == 0, "buffer is empty after the failed flush");
+
+  // Buffer stays usable.
+  const auto [handle, particle] = arena.createObject(Particle{7});
+  buffer.destroyObject(arena, handle);
+  buffer.createObject(arena, Particle{9});
+  buffer.flush();
+  passed &= check(!arena.contains(handle), "recorded object is destroyed");
+  passed &= check(arena.objects().size() == 1 && arena.objects()[0].id == 9, "recorded object is created");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= recordInParallel();
+  passed &= pendingHandles();
+  passed &= deterministicOrder();
+  passed &= flushThrowing();
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
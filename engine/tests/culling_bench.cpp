@@ -0,0 +1,104 @@
+#include <arete/hcs/culling.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::FrustumCuller;
+using arete::hcs::SimdLevel;
+
+constexpr size_t SphereCount = 1'000'000;
+constexpr size_t RoundCount = 50;
+
+//! Culls the spheres repeatedly.
+//! @returns Milliseconds per cull as reported by the culler.
+template<typename Cull>
+double measure(FrustumCuller& culler, Cull&& cull)
+{
+  std::chrono::nanoseconds elapsed {0};
+  for (size_t round = 0; round < RoundCount; ++round)
+  {
+    cull();
+    elapsed += culler.stats().duration;
+  }
+  return std::chrono::duration<double, std::milli>(elapsed).count() / RoundCount;
+}
+
+} // namespace
+
+int main()
+{
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+  std::uniform_real_distribution<float> radius(0.5f, 4.0f);
+
+  std::vector<float> centerX(SphereCount);
+  std::vector<float> centerY(SphereCount);
+  std::vector<float> centerZ(SphereCount);
+  std::vector<float> radii(SphereCount);
+  for (size_t i = 0; i < SphereCount; ++i)
+  {
+    centerX[i] = position(random);
+    centerY[i] = position(random);
+    centerZ[i] = position(random);
+    radii[i] = radius(random);
+  }
+  const arete::hcs::BoundingSpheres spheres {centerX, centerY, centerZ, radii};
+
+  // Camera in the middle of the spheres, projected as the engine projects it.
+  glm::mat4 clip(1.0f);
+  clip[1][1] = -1.0f;
+  clip[2][2] = 0.5f;
+  clip[3][2] = 0.5f;
+  const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+  const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.3f, 0.1f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  const auto frustum = arete::hcs::Frustum::fromMatrix(clip * projection * view);
+
+  FrustumCuller reference;
+  const double scalarMs = measure(reference, [&]() {
+    reference.cull(frustum, spheres, SimdLevel::Scalar);
+  });
+  std::printf(
+    "spheres=%zu visible=%zu culled=%zu\nscalar cull=%.3f ms\n",
+    SphereCount, reference.stats().visibleCount, reference.stats().culledCount, scalarMs);
+
+  bool matches = true;
+  auto& jobs = arete::threading::JobSystem::shared();
+  const auto supported = arete::hcs::detectSimdLevel();
+  for (const auto level: {SimdLevel::Sse41, SimdLevel::Avx2})
+  {
+    if (level > supported)
+      continue;
+
+    FrustumCuller culler;
+    const double serialMs = measure(culler, [&]() {
+      culler.cull(frustum, spheres, level);
+    });
+    const double parallelMs = measure(culler, [&]() {
+      culler.cull(frustum, spheres, jobs, level);
+    });
+
+    // Fused multiply-add may round spheres touching a plane differently.
+    const auto visible = culler.visible();
+    const auto expected = reference.visible();
+    const size_t visibleCount = std::max(visible.size(), expected.size());
+    const size_t difference = visibleCount - std::min(visible.size(), expected.size());
+    if (!std::is_sorted(visible.begin(), visible.end()) || difference > visibleCount / 10'000)
+      matches = false;
+
+    std::printf(
+      "%s cull=%.3f ms speedup=%.2fx parallel cull=%.3f ms on %zu threads, visible differs by %zu\n",
+      arete::hcs::simdLevelName(level), serialMs, scalarMs / serialMs, parallelMs, jobs.threadCount(), difference);
+  }
+
+  std::printf(matches ? "passed\n" : "failed\n");
+  return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
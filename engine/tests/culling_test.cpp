@@ -0,0 +1,166 @@
+#include <arete/hcs/culling.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::FrustumCuller;
+using arete::hcs::SimdLevel;
+
+//! Spheres closer to a plane than this may be classified differently by fused multiply-add.
+constexpr float BoundaryTolerance = 1e-3f;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Random bounding spheres as structure of arrays.
+struct RandomSpheres
+{
+  std::vector<float> centerX;
+  std::vector<float> centerY;
+  std::vector<float> centerZ;
+  std::vector<float> radius;
+
+  [[nodiscard]] arete::hcs::BoundingSpheres view() const noexcept
+  {
+    return {centerX, centerY, centerZ, radius};
+  }
+};
+
+RandomSpheres randomSpheres(const size_t count, std::mt19937& random)
+{
+  std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+  std::uniform_real_distribution<float> radius(0.1f, 8.0f);
+
+  RandomSpheres spheres;
+  for (size_t i = 0; i < count; ++i)
+  {
+    spheres.centerX.push_back(position(random));
+    spheres.centerY.push_back(position(random));
+    spheres.centerZ.push_back(position(random));
+    spheres.radius.push_back(radius(random));
+  }
+  return spheres;
+}
+
+//! @returns True if the sphere touches a plane of the frustum within the tolerance.
+bool onBoundary(const arete::hcs::Frustum& frustum, const RandomSpheres& spheres, const uint32_t index)
+{
+  const glm::vec3 center(spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index]);
+  for (const auto& plane: frustum.planes)
+  {
+    if (std::abs(glm::dot(glm::vec3(plane), center) + plane.w + spheres.radius[index]) < BoundaryTolerance)
+      return true;
+  }
+  return false;
+}
+
+//! @returns True if the visible lists differ only in spheres on the boundary of the frustum.
+bool matchesScalar(
+  const arete::hcs::Frustum& frustum,
+  const RandomSpheres& spheres,
+  std::span<const uint32_t> visible,
+  std::span<const uint32_t> expected)
+{
+  std::vector<uint32_t> difference;
+  std::set_symmetric_difference(
+    visible.begin(), visible.end(), expected.begin(), expected.end(), std::back_inserter(difference));
+  return std::all_of(difference.begin(), difference.end(), [&](const uint32_t index) {
+    return onBoundary(frustum, spheres, index);
+  });
+}
+
+//! Culls the spheres with every supported instruction set, serially and in parallel,
+//! and compares the results with the scalar cull.
+bool cullMatchesScalar(const size_t sphereCount, const arete::hcs::Frustum& frustum, std::mt19937& random)
+{
+  const auto spheres = randomSpheres(sphereCount, random);
+  arete::threading::JobSystem jobs(4);
+
+  FrustumCuller reference;
+  const auto expected = reference.cull(frustum, spheres.view(), SimdLevel::Scalar);
+
+  bool passed = true;
+  passed &= check(std::is_sorted(expected.begin(), expected.end()), "scalar visible list is sorted");
+  passed &= check(
+    reference.stats().visibleCount + reference.stats().culledCount == sphereCount,
+    "scalar cull counts every sphere");
+  if (sphereCount >= 100)
+  {
+    passed &= check(
+      reference.stats().visibleCount != 0 && reference.stats().culledCount != 0,
+      "spheres are both visible and culled");
+  }
+
+  const auto supported = arete::hcs::detectSimdLevel();
+  for (const auto level: {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2})
+  {
+    if (level > supported)
+      continue;
+
+    FrustumCuller culler;
+    for (const bool parallel: {false, true})
+    {
+      const auto visible = parallel
+        ? culler.cull(frustum, spheres.view(), jobs, level)
+        : culler.cull(frustum, spheres.view(), level);
+
+      const bool sorted = std::is_sorted(visible.begin(), visible.end())
+        && std::adjacent_find(visible.begin(), visible.end()) == visible.end();
+      const bool counted = culler.stats().visibleCount == visible.size()
+        && culler.stats().visibleCount + culler.stats().culledCount == sphereCount;
+      const bool matches = matchesScalar(frustum, spheres, visible, expected);
+      passed &= check(sorted && counted && matches, "cull matches the scalar cull");
+      if (!sorted || !counted || !matches)
+      {
+        std::printf(
+          "%s %s cull of %zu spheres: %zu visible, %zu expected\n",
+          arete::hcs::simdLevelName(level), parallel ? "parallel" : "serial",
+          sphereCount, visible.size(), expected.size());
+      }
+    }
+  }
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  // Camera in the middle of the spheres, projected as the engine projects it.
+  glm::mat4 clip(1.0f);
+  clip[1][1] = -1.0f;
+  clip[2][2] = 0.5f;
+  clip[3][2] = 0.5f;
+  const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+  const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.3f, 0.1f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  const auto frustum = arete::hcs::Frustum::fromMatrix(clip * projection * view);
+
+  // Counts below a batch, with tails of every length, and spanning several chunks.
+  constexpr size_t Chunk = FrustumCuller::ChunkSize;
+  std::mt19937 random(11);
+  bool passed = true;
+  for (const size_t sphereCount: {size_t {0}, size_t {1}, size_t {3}, size_t {7}, size_t {8}, size_t {13},
+                                  size_t {100}, size_t {1021}, Chunk, Chunk + 1, 3 * Chunk + 5, 5 * Chunk + 7})
+  {
+    passed &= cullMatchesScalar(sphereCount, frustum, random);
+  }
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
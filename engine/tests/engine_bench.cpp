@@ -0,0 +1,301 @@
+#include <arete/hcs/hcs.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+//! Count of calls to the global operator new.
+std::atomic<size_t> globalAllocations = 0;
+
+} // namespace
+
+void* operator new(const size_t size)
+{
+  globalAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size == 0 ? 1 : size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment)
+{
+  globalAllocations.fetch_add(1, std::memory_order_relaxed);
+  const auto align = static_cast<size_t>(alignment);
+  if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+namespace
+{
+
+template<size_t Bytes>
+//! Benchmarked object of the specified size.
+struct BenchObject
+{
+  static_assert(Bytes >= sizeof(uint32_t));
+
+  uint32_t value = 0;
+  std::byte padding[Bytes - sizeof(uint32_t)] {};
+};
+
+} // namespace
+
+template<size_t Bytes>
+struct std::hash<BenchObject<Bytes>>
+{
+  size_t operator()(const BenchObject<Bytes>& object) const noexcept
+  {
+    return object.value;
+  }
+};
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+//! Minimal count of operations of a single measurement.
+constexpr size_t MinOperations = 1'000'000;
+
+//! Keeps results observable so the measured loops are not optimized out.
+volatile uint64_t sink = 0;
+
+//! Result of a single measurement.
+struct Result
+{
+  const char* name;
+  size_t objectSize;
+  size_t count;
+  size_t operations;
+  double nanoseconds;
+  size_t allocations;
+};
+
+//! Collected results.
+std::vector<Result> results;
+
+template<typename Setup, typename Body>
+//! Measures the body repeated until at least MinOperations operations were made.
+//! Setup runs before every repetition and is excluded from the measurement.
+//! @param name Name of the measurement.
+//! @param objectSize Size of the benchmarked object.
+//! @param count Count of operations of a single repetition.
+void measure(const char* name, const size_t objectSize, const size_t count, Setup&& setup, Body&& body)
+{
+  const size_t repetitions = std::max<size_t>(1, MinOperations / count);
+
+  double nanoseconds = 0;
+  size_t allocations = 0;
+  for (size_t repetition = 0; repetition < repetitions; ++repetition)
+  {
+    auto state = setup();
+
+    const size_t allocationsBefore = globalAllocations.load(std::memory_order_relaxed);
+    const auto start = Clock::now();
+    body(*state);
+    nanoseconds += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    allocations += globalAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+  }
+
+  results.push_back({name, objectSize, count, count * repetitions, nanoseconds, allocations});
+}
+
+template<class Object>
+//! Arena with its live handles and a random lookup order.
+struct ArenaState
+{
+  arete::hcs::Arena<uint32_t, Object> arena;
+  std::vector<uint32_t> handles;
+  std::vector<uint32_t> order;
+
+  explicit ArenaState(const size_t count)
+  {
+    handles.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+      handles.push_back(arena.createObject().first);
+
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(0xA7E7E));
+  }
+};
+
+template<class Object>
+//! System of the benchmarked objects.
+class BenchSystem
+  : public arete::hcs::SystemBase<Object>
+{
+public:
+  void destroyComponent(const arete::hcs::ComponentHandle component) override
+  {
+    this->_arena.destroyObject(component);
+  }
+
+  Object& getComponent(const arete::hcs::ComponentHandle component) override
+  {
+    return this->_arena.getObject(component)->get();
+  }
+};
+
+template<class Object>
+//! System with its live components.
+struct SystemState
+{
+  BenchSystem<Object> system;
+  std::vector<arete::hcs::ComponentHandle> handles;
+
+  explicit SystemState(const size_t count)
+  {
+    handles.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+      handles.push_back(system.createComponent());
+  }
+};
+
+template<size_t Bytes>
+//! Measures arena and system operations with objects of the specified size.
+void benchObjectSize(const size_t count)
+{
+  using Object = BenchObject<Bytes>;
+  using Arena = arete::hcs::Arena<uint32_t, Object>;
+
+  const auto empty = []() {
+    return std::make_unique<Arena>();
+  };
+  const auto populated = [count]() {
+    return std::make_unique<ArenaState<Object>>(count);
+  };
+
+  measure("arena.create", Bytes, count, empty, [count](Arena& arena) {
+    for (size_t i = 0; i < count; ++i)
+      sink = sink + arena.createObject().first;
+  });
+
+  measure("arena.createObjects", Bytes, count, empty, [count](Arena& arena) {
+    sink = sink + arena.createObjects(count).size();
+  });
+
+  measure("arena.destroy", Bytes, count, populated, [](ArenaState<Object>& state) {
+    for (const auto index: state.order)
+      state.arena.destroyObject(state.handles[index]);
+  });
+
+  measure("arena.destroyObjects", Bytes, count, populated, [](ArenaState<Object>& state) {
+    sink = sink + state.arena.destroyObjects(state.handles);
+  });
+
+  measure("arena.lookup", Bytes, count, populated, [](ArenaState<Object>& state) {
+    uint64_t sum = 0;
+    for (const auto index: state.order)
+      sum += std::as_const(state.arena).getObject(state.handles[index])->get().value;
+    sink = sink + sum;
+  });
+
+  measure("arena.iterate", Bytes, count, populated, [](ArenaState<Object>& state) {
+    state.arena.objects().forEachPage([](std::span<Object> page) {
+      for (auto& object: page)
+        ++object.value;
+    });
+  });
+
+  measure("arena.churn", Bytes, count, populated, [](ArenaState<Object>& state) {
+    // Replace every object, one destroy and one create per operation.
+    for (const auto index: state.order)
+    {
+      state.arena.destroyObject(state.handles[index]);
+      state.handles[index] = state.arena.createObject().first;
+    }
+  });
+
+  const auto system = [count]() {
+    return std::make_unique<SystemState<Object>>(count);
+  };
+
+  measure("system.create", Bytes, count, system, [count](SystemState<Object>& state) {
+    for (size_t i = 0; i < count; ++i)
+      sink = sink + state.system.createComponent();
+  });
+
+  measure("system.get", Bytes, count, system, [](SystemState<Object>& state) {
+    uint64_t sum = 0;
+    for (const auto handle: state.handles)
+      sum += state.system.getComponent(handle).value;
+    sink = sink + sum;
+  });
+
+  measure("system.destroy", Bytes, count, system, [](SystemState<Object>& state) {
+    for (const auto handle: state.handles)
+      state.system.destroyComponent(handle);
+  });
+}
+
+//! Prints results as JSON.
+void printResults()
+{
+  std::printf("{\n  \"results\": [\n");
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const auto& result = results[i];
+    const double nsPerOp = result.nanoseconds / static_cast<double>(result.operations);
+    std::printf(
+      "    {\"name\": \"%s\", \"objectSize\": %zu, \"count\": %zu, \"operations\": %zu, "
+      "\"nsPerOp\": %.3f, \"opsPerSecond\": %.0f, \"allocations\": %zu, \"allocationsPerOp\": %.6f}%s\n",
+      result.name,
+      result.objectSize,
+      result.count,
+      result.operations,
+      nsPerOp,
+      1e9 / nsPerOp,
+      result.allocations,
+      static_cast<double>(result.allocations) / static_cast<double>(result.operations),
+      i + 1 < results.size() ? "," : "");
+  }
+  std::printf("  ]\n}\n");
+}
+
+} // namespace
+
+int main()
+{
+  for (const size_t count: {1'000, 10'000, 100'000})
+  {
+    benchObjectSize<16>(count);
+    benchObjectSize<64>(count);
+    benchObjectSize<256>(count);
+  }
+
+  printResults();
+  return 0;
+}
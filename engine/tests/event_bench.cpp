@@ -0,0 +1,117 @@
+#include <arete/hcs/event_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory_resource>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t WarmUpFrameCount = 4;
+constexpr size_t FrameCount = 50;
+constexpr size_t EventsPerFrame = 1 << 20;
+
+//! Event of the benchmark.
+struct HitEvent
+{
+  uint32_t source;
+  uint32_t target;
+  float damage;
+  float time;
+};
+
+//! Memory resource counting the allocations of the upstream resource.
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+  //! @returns Count of allocations so far.
+  [[nodiscard]] size_t allocations() const noexcept
+  {
+    return _allocations.load(std::memory_order_relaxed);
+  }
+
+private:
+  void* do_allocate(const size_t bytes, const size_t alignment) override
+  {
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* memory, const size_t bytes, const size_t alignment) override
+  {
+    std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+  }
+
+  [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+  std::atomic<size_t> _allocations {0};
+};
+
+//! Posts events from every thread of the job system, flips and reads them once per frame.
+void benchThroughput(const size_t threadCount)
+{
+  arete::threading::JobSystem jobs(threadCount);
+  CountingResource resource;
+  arete::hcs::EventQueue<HitEvent> events(jobs, 1024, &resource);
+
+  const size_t producerCount = jobs.threadCount();
+  const size_t eventsPerProducer = EventsPerFrame / producerCount;
+
+  double elapsedNs = 0;
+  size_t steadyAllocations = 0;
+  size_t readEvents = 0;
+  for (size_t frame = 0; frame < WarmUpFrameCount + FrameCount; ++frame)
+  {
+    // Warm-up frames grow the buffers to their peak size and are not measured.
+    const size_t allocationsBefore = resource.allocations();
+    const auto start = Clock::now();
+
+    jobs.parallelFor(producerCount, [&events, eventsPerProducer](const size_t producer) {
+      for (size_t event = 0; event < eventsPerProducer; ++event)
+      {
+        events.post({
+          .source = static_cast<uint32_t>(producer),
+          .target = static_cast<uint32_t>(event),
+          .damage = 1.0f,
+          .time = 0.0f});
+      }
+    });
+    events.flip();
+
+    size_t frameEvents = 0;
+    events.forEachBatch([&frameEvents](const std::span<const HitEvent> batch) {
+      frameEvents += batch.size();
+    });
+
+    if (frame < WarmUpFrameCount)
+      continue;
+    elapsedNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    steadyAllocations += resource.allocations() - allocationsBefore;
+    readEvents += frameEvents;
+  }
+
+  std::printf(
+    "threads=%zu events=%zu %.1f ns/event %.1f M events/s steady allocations=%zu\n",
+    threadCount,
+    readEvents,
+    elapsedNs / static_cast<double>(readEvents),
+    static_cast<double>(readEvents) / elapsedNs * 1e3,
+    steadyAllocations);
+}
+
+} // namespace
+
+int main()
+{
+  for (const size_t threadCount: {1, 2, 4, 8})
+    benchThroughput(threadCount);
+
+  return 0;
+}
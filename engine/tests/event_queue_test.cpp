@@ -0,0 +1,190 @@
+#include <arete/hcs/event_queue.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::EventQueue;
+
+//! Count of tasks posting events from the job system.
+constexpr uint32_t TaskCount = 64;
+//! Events posted by every task and by the external thread per frame.
+constexpr uint32_t EventsPerProducer = 256;
+//! Producer identifier of the thread outside of the job system.
+constexpr uint32_t ExternalProducer = TaskCount;
+
+//! Event of the test.
+struct TestEvent
+{
+  //! Task or external thread which posted the event.
+  uint32_t producer;
+  //! Order of the event within its producer.
+  uint32_t sequence;
+  //! Index of the posting thread within the job system.
+  uint32_t thread;
+  //! Frame the event was posted in.
+  uint32_t frame;
+};
+
+//! Memory resource counting the allocations of the upstream resource.
+class CountingResource final : public std::pmr::memory_resource
+{
+public:
+  //! @returns Count of allocations so far.
+  [[nodiscard]] size_t allocations() const noexcept
+  {
+    return _allocations.load(std::memory_order_relaxed);
+  }
+
+private:
+  void* do_allocate(const size_t bytes, const size_t alignment) override
+  {
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* memory, const size_t bytes, const size_t alignment) override
+  {
+    std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+  }
+
+  [[nodiscard]] bool do_is_equal(const memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+  std::atomic<size_t> _allocations {0};
+};
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Posts the events of a frame from the tasks of the job system and from an external thread at the same time.
+void postFrame(arete::threading::JobSystem& jobs, EventQueue<TestEvent>& events, const uint32_t frame)
+{
+  std::thread external([&events, frame]() {
+    for (uint32_t sequence = 0; sequence < EventsPerProducer; ++sequence)
+      events.post({ExternalProducer, sequence, 0, frame});
+  });
+
+  jobs.parallelFor(TaskCount, [&jobs, &events, frame](const size_t task) {
+    const auto thread = static_cast<uint32_t>(jobs.localThreadIndex());
+    for (uint32_t sequence = 0; sequence < EventsPerProducer; ++sequence)
+      events.post({static_cast<uint32_t>(task), sequence, thread, frame});
+  });
+  external.join();
+}
+
+//! @returns True if every event of the frame is readable exactly once, in the order of its producer,
+//! and every batch holds the events of a single thread.
+bool readsFrame(const EventQueue<TestEvent>& events, const uint32_t frame)
+{
+  std::vector<uint32_t> nextSequence(TaskCount + 1, 0);
+  bool inOrder = true;
+  bool currentFrame = true;
+  bool singleThread = true;
+  events.forEachBatch([&](const std::span<const TestEvent> batch) {
+    for (const auto& event: batch)
+    {
+      currentFrame &= event.frame == frame;
+      singleThread &= event.thread == batch.front().thread;
+      inOrder &= event.producer <= TaskCount && event.sequence == nextSequence[event.producer]++;
+    }
+  });
+
+  bool complete = events.size() == (TaskCount + 1) * EventsPerProducer;
+  for (const auto count: nextSequence)
+    complete &= count == EventsPerProducer;
+
+  bool passed = true;
+  passed &= check(currentFrame, "only the events of the flipped frame are readable");
+  passed &= check(inOrder, "events of a producer are read once in the order they were posted");
+  passed &= check(complete, "every posted event is readable");
+  passed &= check(singleThread, "every batch holds the events of a single thread");
+  return passed;
+}
+
+//! Posts from job threads and an external thread, reads after every flip.
+bool postAndRead()
+{
+  arete::threading::JobSystem jobs(4);
+  CountingResource resource;
+  // Capacity covers every event of a frame, so no buffer has to grow.
+  EventQueue<TestEvent> events(jobs, (TaskCount + 1) * EventsPerProducer, &resource);
+  const size_t allocations = resource.allocations();
+
+  bool passed = true;
+  passed &= check(events.empty(), "new queue is empty");
+
+  postFrame(jobs, events, 0);
+  passed &= check(events.empty(), "posted events are not readable before the flip");
+
+  for (uint32_t frame = 0; frame < 8; ++frame)
+  {
+    events.flip();
+    passed &= readsFrame(events, frame);
+
+    // Events posted after the flip wait for the next one.
+    postFrame(jobs, events, frame + 1);
+    passed &= readsFrame(events, frame);
+  }
+
+  events.flip();
+  events.flip();
+  passed &= check(events.empty(), "flip drops the events read so far");
+  passed &= check(resource.allocations() == allocations, "frames within the capacity do not allocate");
+  return passed;
+}
+
+//! Grows the buffers during the first frames and reuses them afterwards.
+bool steadyFramesDoNotAllocate()
+{
+  arete::threading::JobSystem jobs(4);
+  CountingResource resource;
+  EventQueue<TestEvent> events(jobs, 0, &resource);
+
+  bool passed = true;
+  size_t steadyAllocations = 0;
+  for (uint32_t frame = 0; frame < 16; ++frame)
+  {
+    // Posting from the thread outside of the job system fills the same pair of buffers in turns,
+    // the peaks of the third and sixth frame grow both of them to the peak event count.
+    const size_t allocations = resource.allocations();
+    for (uint32_t sequence = 0; sequence < EventsPerProducer * (frame % 3 + 1); ++sequence)
+      events.emplace(ExternalProducer, sequence, 0u, frame);
+    std::vector<TestEvent> bulk(EventsPerProducer, TestEvent{ExternalProducer, 0, 0, frame});
+    events.post(std::span<const TestEvent>(bulk));
+    events.flip();
+
+    passed &= check(events.size() == EventsPerProducer * (frame % 3 + 2), "every posted event is readable");
+    if (frame >= 6)
+      steadyAllocations += resource.allocations() - allocations;
+  }
+  passed &= check(steadyAllocations == 0, "steady frames do not allocate");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= postAndRead();
+  passed &= steadyFramesDoNotAllocate();
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,116 @@
+#include <arete/hcs/arena.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+using Arena = arete::hcs::Arena<uint32_t, uint64_t>;
+using Index = arete::hcs::SparseIndex<uint32_t>;
+
+//! Generations of a slot of 32-bit handles.
+constexpr size_t GenerationCount = size_t{1} << Index::Handle::GenerationBits;
+//! Create and destroy cycles, past the count of generations of a slot.
+constexpr size_t CycleCount = GenerationCount + 64;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Creates and destroys a single object, a stale handle never resolves to a later object.
+bool singleObjectChurn()
+{
+  Arena arena;
+  const uint32_t first = arena.createObject(uint64_t{0}).first;
+  [[maybe_unused]] const bool destroyed = arena.destroyObject(first);
+
+  bool firstStale = true;
+  bool resolves = true;
+  for (uint64_t cycle = 1; cycle <= CycleCount; ++cycle)
+  {
+    const uint32_t handle = arena.createObject(cycle).first;
+    firstStale &= !arena.contains(first) && !arena.getObject(first);
+    resolves &= arena.contains(handle) && arena.getObject(handle)->get() == cycle;
+    [[maybe_unused]] const bool cycled = arena.destroyObject(handle);
+  }
+
+  bool passed = true;
+  passed &= check(firstStale, "stale handle stays stale past the generations of a slot");
+  passed &= check(resolves, "live handles resolve to their objects");
+  return passed;
+}
+
+//! Cycles a single slot through all of its generations, its stale handles are rejected until the generation wraps.
+bool slotGenerations()
+{
+  Index index;
+  std::vector<uint32_t> cycled;
+  bool passed = true;
+  bool bounded = true;
+  for (size_t cycle = 0; cycle < (Index::MinimumFreeSlots + 1) * CycleCount; ++cycle)
+  {
+    const uint32_t handle = index.insert();
+    if (Index::Handle::index(handle) == 0)
+      cycled.push_back(handle);
+    bounded &= index.freeCount() <= Index::MinimumFreeSlots;
+    [[maybe_unused]] const auto erased = index.erase(handle);
+  }
+  passed &= check(bounded, "free slots are bounded by the minimum kept free");
+  passed &= check(cycled.size() > GenerationCount, "slot is cycled past its generations");
+
+  // Every generation of the slot is distinct until the generation counter wraps.
+  bool distinct = true;
+  for (size_t generation = 0; generation < cycled.size(); ++generation)
+  {
+    distinct &= Index::Handle::generation(cycled[generation]) == generation % GenerationCount;
+    distinct &= generation < GenerationCount || cycled[generation] == cycled[generation - GenerationCount];
+  }
+  passed &= check(distinct, "slot goes through every generation before it wraps");
+  return passed;
+}
+
+//! Bulk destruction sorts the free list, the most recently freed slots are still not reused early.
+bool bulkChurn()
+{
+  Arena arena;
+  [[maybe_unused]] const auto created = arena.createObjects(2 * Index::MinimumFreeSlots);
+
+  // Fill the free list past the minimum, so destroyed slots are reused right away.
+  const auto handles = arena.handles();
+  std::vector<uint32_t> stale(handles.begin(), handles.begin() + Index::MinimumFreeSlots + 64);
+  arena.destroyObjects(stale);
+
+  uint32_t handle = arena.createObject(uint64_t{0}).first;
+  for (uint64_t cycle = 1; cycle <= CycleCount; ++cycle)
+  {
+    // Sorting moves the lowest free slots to the front, the slot freed last must still wait for its turn.
+    arena.destroyObjects(std::span(&handle, 1));
+    stale.push_back(handle);
+    handle = arena.createObject(cycle).first;
+  }
+
+  bool staleRejected = true;
+  for (const auto staleHandle: stale)
+    staleRejected &= !arena.contains(staleHandle);
+  return check(staleRejected, "stale handles stay stale across bulk destruction");
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= singleObjectChurn();
+  passed &= slotGenerations();
+  passed &= bulkChurn();
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,103 @@
+#include <arete/threading/job_system.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t RoundCount = 100;
+constexpr size_t FanOutCount = 2048;
+constexpr size_t WorkIterations = 200;
+
+//! Keeps results observable so the jobs are not optimized out.
+std::atomic<uint64_t> sink = 0;
+
+//! Simulates work of a job.
+void work(const size_t seed)
+{
+  float value = static_cast<float>(seed);
+  for (size_t i = 0; i < WorkIterations; ++i)
+    value = std::sin(value) + 1.0f;
+  sink.fetch_add(static_cast<uint64_t>(value), std::memory_order_relaxed);
+}
+
+//! Starts jobs from the calling thread and waits for all of them.
+//! @returns Nanoseconds per job.
+double benchFanOut(arete::threading::JobSystem& jobs, const bool withWork)
+{
+  const auto start = Clock::now();
+  for (size_t round = 0; round < RoundCount; ++round)
+  {
+    arete::threading::JobCounter counter;
+    for (size_t jobIndex = 0; jobIndex < FanOutCount; ++jobIndex)
+    {
+      jobs.run(counter, [jobIndex, withWork]() {
+        if (withWork)
+          work(jobIndex);
+      });
+    }
+    jobs.wait(counter);
+  }
+  const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return elapsed / static_cast<double>(RoundCount * FanOutCount);
+}
+
+//! Starts jobs which start and wait for jobs of their own.
+//! @returns Nanoseconds per leaf job.
+double benchNested(arete::threading::JobSystem& jobs)
+{
+  constexpr size_t BranchCount = 32;
+  constexpr size_t LeafCount = FanOutCount / BranchCount;
+
+  const auto start = Clock::now();
+  for (size_t round = 0; round < RoundCount; ++round)
+  {
+    arete::threading::JobCounter branches;
+    for (size_t branch = 0; branch < BranchCount; ++branch)
+    {
+      jobs.run(branches, [&jobs, branch]() {
+        arete::threading::JobCounter leaves;
+        for (size_t leaf = 0; leaf < LeafCount; ++leaf)
+        {
+          jobs.run(leaves, [branch, leaf]() {
+            work(branch * LeafCount + leaf);
+          });
+        }
+        jobs.wait(leaves);
+      });
+    }
+    jobs.wait(branches);
+  }
+  const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return elapsed / static_cast<double>(RoundCount * FanOutCount);
+}
+
+} // namespace
+
+int main()
+{
+  std::printf("physical cores=%zu\n", arete::threading::JobSystem::physicalCoreCount());
+
+  double baselineWorkNs = 0;
+  for (const size_t threadCount: {1, 2, 4, 8, 16})
+  {
+    arete::threading::JobSystem jobs(threadCount);
+
+    const double emptyNs = benchFanOut(jobs, false);
+    const double workNs = benchFanOut(jobs, true);
+    const double nestedNs = benchNested(jobs);
+    if (threadCount == 1)
+      baselineWorkNs = workNs;
+
+    std::printf(
+      "threads=%zu empty=%.1f ns/job work=%.1f ns/job (speedup %.2fx) nested=%.1f ns/job\n",
+      threadCount, emptyNs, workNs, baselineWorkNs / workNs, nestedNs);
+  }
+
+  return 0;
+}
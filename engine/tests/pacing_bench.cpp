@@ -0,0 +1,51 @@
+#include <arete/tickClock.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace
+{
+
+using Clock = arete::TickClock::Clock;
+
+//! Duration of every measurement in seconds.
+constexpr float MeasurementSeconds = 2.0f;
+
+//! Paces ticks at the rate and reports the achieved pacing and the CPU time used.
+void benchPacing(const float tickRate)
+{
+  arete::TickClock clock(tickRate);
+  const auto tickCount = static_cast<size_t>(tickRate * MeasurementSeconds);
+
+  const std::clock_t cpuStart = std::clock();
+  const auto start = Clock::now();
+  for (size_t tick = 0; tick < tickCount; ++tick)
+    clock.waitForTick();
+  const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  const double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+  const auto stats = clock.pacingStats();
+  std::printf(
+    "rate=%.0f Hz target=%.3f ms achieved=%.3f ms jitter mean=%.1f us max=%.1f us cpu=%.1f%%\n",
+    tickRate,
+    stats.targetPeriod * 1e3f,
+    stats.meanPeriod * 1e3f,
+    stats.meanJitter * 1e6f,
+    stats.maxJitter * 1e6f,
+    100.0 * cpu / elapsed);
+}
+
+} // namespace
+
+int main()
+{
+  std::printf(
+    "spin threshold=%.1f us\n",
+    std::chrono::duration<double, std::micro>(arete::TickClock::spinThreshold()).count());
+
+  for (const float tickRate: {30.0f, 60.0f, 144.0f, 240.0f})
+    benchPacing(tickRate);
+
+  return 0;
+}
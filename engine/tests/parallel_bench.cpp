@@ -0,0 +1,67 @@
+#include <arete/hcs/parallel.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+
+//! Particle updated by the benchmark.
+struct Particle
+{
+  float position[3] {};
+  float velocity[3] {};
+  float age = 0;
+  float drag = 0.1f;
+};
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ParticleCount = 500'000;
+constexpr size_t StepCount = 50;
+constexpr float DeltaTime = 1.0f / 60.0f;
+
+//! Updates single particle.
+void updateParticle(Particle& particle)
+{
+  const float damping = std::exp(-particle.drag * DeltaTime);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    particle.velocity[axis] = particle.velocity[axis] * damping + std::sin(particle.age + axis) * DeltaTime;
+    particle.position[axis] += particle.velocity[axis] * DeltaTime;
+  }
+  particle.age += DeltaTime;
+}
+
+} // namespace
+
+int main()
+{
+  arete::hcs::Arena<uint32_t, Particle> arena;
+  for (size_t i = 0; i < ParticleCount; ++i)
+  {
+    auto [handle, particle] = arena.createObject();
+    particle.age = static_cast<float>(i % 1000) * 0.01f;
+  }
+
+  double baselineMs = 0;
+  for (const size_t threadCount: {1, 2, 4, 8, 16})
+  {
+    arete::threading::JobSystem jobs(threadCount);
+
+    const auto start = Clock::now();
+    for (size_t step = 0; step < StepCount; ++step)
+      arete::hcs::parallelForEach(arena, updateParticle, arete::hcs::DefaultGrainSize, jobs);
+    const double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / StepCount;
+
+    if (threadCount == 1)
+      baselineMs = elapsedMs;
+
+    std::printf(
+      "threads=%zu objects=%zu %.3f ms/step speedup=%.2fx\n",
+      threadCount, ParticleCount, elapsedMs, baselineMs / elapsedMs);
+  }
+
+  return 0;
+}
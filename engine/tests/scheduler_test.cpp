@@ -0,0 +1,167 @@
+#include <arete/hcs/scheduler.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::FramePhase;
+using arete::hcs::Scheduler;
+using arete::hcs::SystemAccess;
+using arete::hcs::SystemId;
+
+using Clock = std::chrono::steady_clock;
+
+struct Health
+{
+  float value;
+};
+
+struct Velocity
+{
+  float value;
+};
+
+struct Sprite
+{
+  uint32_t frame;
+};
+
+//! Duration of every system of the conflicting chain.
+constexpr auto ChainDuration = std::chrono::milliseconds(20);
+//! Time the overlapping systems wait for each other before giving up.
+constexpr auto OverlapTimeout = std::chrono::seconds(2);
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! @returns True if the system finished before the other one started.
+bool finishedBefore(const Scheduler& scheduler, const SystemId system, const SystemId other)
+{
+  const auto& timeline = scheduler.timeline();
+  return timeline[system].start + timeline[system].duration <= timeline[other].start;
+}
+
+} // namespace
+
+int main()
+{
+  arete::threading::JobSystem jobs(4);
+  Scheduler scheduler;
+
+  // Order in which the systems of the conflicting chain ran.
+  std::atomic<uint32_t> sequence {0};
+  std::vector<uint32_t> order(3);
+  const auto chainSystem = [&sequence, &order](const size_t index) {
+    return [&sequence, &order, index](float) {
+      order[index] = sequence.fetch_add(1);
+      std::this_thread::sleep_for(ChainDuration);
+    };
+  };
+
+  // Systems which do not conflict wait until both of them run, they only finish if they overlap.
+  std::atomic<uint32_t> arrived {0};
+  std::atomic<bool> overlapped {true};
+  const auto overlappingSystem = [&arrived, &overlapped](float) {
+    arrived.fetch_add(1);
+    const auto deadline = Clock::now() + OverlapTimeout;
+    while (arrived.load() < 2)
+    {
+      if (Clock::now() > deadline)
+      {
+        overlapped.store(false);
+        return;
+      }
+      std::this_thread::yield();
+    }
+  };
+
+  const SystemId writeHealth = scheduler.addSystem(
+    "writeHealth", FramePhase::Simulation, SystemAccess{}.write<Health>(), chainSystem(0));
+  const SystemId readHealth = scheduler.addSystem(
+    "readHealth", FramePhase::Simulation, SystemAccess{}.read<Health>(), chainSystem(1));
+  const SystemId writeHealthAgain = scheduler.addSystem(
+    "writeHealthAgain", FramePhase::Simulation, SystemAccess{}.write<Health>(), chainSystem(2));
+  const SystemId writeVelocity = scheduler.addSystem(
+    "writeVelocity", FramePhase::Simulation, SystemAccess{}.write<Velocity>(), overlappingSystem);
+  const SystemId writeSprite = scheduler.addSystem(
+    "writeSprite", FramePhase::Simulation, SystemAccess{}.read<Sprite>().write<Sprite>(), overlappingSystem);
+
+  // Reads of the same component do not conflict, yet a later phase waits for the whole earlier phase.
+  std::atomic<uint32_t> drawSequence {0};
+  const SystemId drawHealth = scheduler.addSystem(
+    "drawHealth", FramePhase::DrawExtraction, SystemAccess{}.read<Health>(), [&](float) {
+      drawSequence.store(sequence.load());
+    });
+
+  bool passed = true;
+  passed &= check(scheduler.systemDependencies(writeHealth).empty(), "first writer has no dependency");
+  passed &= check(
+    scheduler.systemDependencies(readHealth) == std::vector<SystemId>{writeHealth},
+    "reader depends on the earlier writer");
+  passed &= check(
+    scheduler.systemDependencies(writeHealthAgain) == std::vector<SystemId>{writeHealth, readHealth},
+    "writer depends on the earlier reader and writer");
+  passed &= check(
+    scheduler.systemDependencies(writeVelocity).empty() && scheduler.systemDependencies(writeSprite).empty(),
+    "writers of other components are independent");
+  passed &= check(scheduler.systemDependencies(drawHealth).empty(), "systems of other phases are no dependencies");
+
+  // Runs more than once, dependencies are counted again every frame.
+  for (size_t frame = 0; frame < 3; ++frame)
+  {
+    sequence.store(0);
+    arrived.store(0);
+    overlapped.store(true);
+    scheduler.run(1.0f / 60.0f, jobs);
+
+    passed &= check(order[0] == 0 && order[1] == 1 && order[2] == 2, "conflicting systems run in declaration order");
+    passed &= check(finishedBefore(scheduler, writeHealth, readHealth), "reader starts after the writer finished");
+    passed &= check(
+      finishedBefore(scheduler, readHealth, writeHealthAgain),
+      "writer starts after the reader finished");
+    passed &= check(overlapped.load(), "systems which do not conflict overlap");
+    passed &= check(drawSequence.load() == 3, "later phase runs after the earlier phase");
+    passed &= check(
+      finishedBefore(scheduler, writeHealthAgain, drawHealth) && finishedBefore(scheduler, writeVelocity, drawHealth),
+      "later phase starts after the earlier phase finished");
+
+    const auto& timeline = scheduler.timeline();
+    bool timelineValid = timeline.size() == scheduler.size();
+    for (SystemId system = 0; system < timeline.size(); ++system)
+    {
+      timelineValid &= timeline[system].system == system;
+      timelineValid &= timeline[system].threadIndex < jobs.threadCount();
+    }
+    passed &= check(timelineValid, "timeline holds every system");
+    passed &= check(timeline[writeHealth].duration >= ChainDuration, "timeline measures the duration");
+
+    const auto path = scheduler.criticalPath();
+    passed &= check(
+      path == std::vector<SystemId>{writeHealth, readHealth, writeHealthAgain, drawHealth},
+      "critical path follows the conflicting chain of every phase");
+  }
+
+  std::printf("timeline of the last frame:\n");
+  for (const auto& timing: scheduler.timeline())
+  {
+    std::printf(
+      "  %-16s thread %zu start %8.3f ms duration %8.3f ms\n",
+      scheduler.systemName(timing.system).c_str(), timing.threadIndex,
+      std::chrono::duration<double, std::milli>(timing.start).count(),
+      std::chrono::duration<double, std::milli>(timing.duration).count());
+  }
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+#include <arete/hcs/arena.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+//! Component of the test.
+struct TestComponent
+{
+  float values[8] {};
+  uint32_t id = 0;
+};
+
+using Arena = arete::hcs::Arena<uint32_t, TestComponent>;
+
+constexpr size_t ObjectCount = 100'000;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Diffs the snapshots and applies the delta to the base.
+//! @returns True if the delta is at most the size and reproduces the target.
+bool roundTrip(
+  const char* name,
+  const arete::hcs::Snapshot& base,
+  const arete::hcs::Snapshot& target,
+  const size_t maxDeltaSize)
+{
+  const auto delta = arete::hcs::diffSnapshots(base, target);
+  std::printf(
+    "%s: delta of %zu bytes in %zu runs for a snapshot of %zu bytes\n",
+    name, delta.bytes.size(), delta.runs.size(), target.data.size());
+
+  auto applied = base;
+  arete::hcs::applySnapshotDelta(applied, delta);
+
+  bool passed = true;
+  passed &= check(delta.bytes.size() <= maxDeltaSize, "delta is compact");
+  passed &= check(applied.data == target.data, "delta reproduces the target bytes");
+  passed &= check(applied.sections == target.sections, "delta reproduces the target sections");
+  return passed;
+}
+
+//! @returns True if the arena holds the objects of the handles with the ids.
+bool holds(const Arena& arena, const std::vector<uint32_t>& handles)
+{
+  if (arena.size() != handles.size())
+    return false;
+  for (size_t i = 0; i < handles.size(); ++i)
+  {
+    const auto object = arena.getObject(handles[i]);
+    if (!object || object->get().id != handles[i])
+      return false;
+  }
+  return true;
+}
+
+//! Restores snapshots whose index points past its arrays.
+//! @returns True if every corrupt snapshot is rejected and the arena is left intact.
+bool rejectsCorrupt(const arete::hcs::Snapshot& snapshot, const std::vector<uint32_t>& handles)
+{
+  // Layout: object size and count, handle, slot and free counts, then the arrays.
+  uint64_t counts[5] {};
+  std::memcpy(counts, snapshot.data.data(), sizeof(counts));
+  const size_t handlesOffset = sizeof(counts);
+  const size_t slotsOffset = handlesOffset + counts[2] * sizeof(uint32_t);
+  const size_t freeOffset = slotsOffset + counts[3] * 2 * sizeof(uint32_t);
+
+  const auto corrupt = [&snapshot](const size_t offset, const uint32_t value) {
+    auto corrupted = snapshot;
+    std::memcpy(corrupted.data.data() + offset, &value, sizeof(value));
+    return corrupted;
+  };
+  const arete::hcs::Snapshot corrupted[] {
+    corrupt(handlesOffset, static_cast<uint32_t>(counts[3])),
+    corrupt(slotsOffset, static_cast<uint32_t>(counts[2])),
+    corrupt(freeOffset, static_cast<uint32_t>(counts[3]))};
+
+  Arena arena;
+  arena.restore(snapshot);
+
+  bool passed = counts[4] != 0;
+  for (const auto& corruptSnapshot: corrupted)
+  {
+    try
+    {
+      arena.restore(corruptSnapshot);
+      passed = false;
+    } catch (const std::invalid_argument&)
+    {
+    }
+  }
+  passed &= holds(arena, handles);
+  return check(passed, "corrupt snapshots are rejected");
+}
+
+} // namespace
+
+int main()
+{
+  Arena arena;
+  std::vector<uint32_t> handles;
+  for (size_t i = 0; i < ObjectCount; ++i)
+  {
+    const auto [handle, object] = arena.createObject();
+    object.id = handle;
+    handles.push_back(handle);
+  }
+
+  bool passed = true;
+  const auto base = arena.snapshot();
+
+  // Blocks of the handle, slot and free list sections and of the object pages touched by the change.
+  constexpr size_t MaxDeltaSize = 16 * arete::hcs::SnapshotDeltaBlockSize;
+
+  const auto [created, createdObject] = arena.createObject();
+  createdObject.id = created;
+  handles.push_back(created);
+  const auto afterCreate = arena.snapshot();
+  passed &= roundTrip("create", base, afterCreate, MaxDeltaSize);
+
+  arena.destroyObject(handles[ObjectCount / 2]);
+  handles[ObjectCount / 2] = handles.back();
+  handles.pop_back();
+  const auto afterDestroy = arena.snapshot();
+  passed &= roundTrip("destroy", afterCreate, afterDestroy, MaxDeltaSize);
+
+  arena.getObject(handles[10])->get().values[3] = 1.0f;
+  const auto afterChange = arena.snapshot();
+  passed &= roundTrip("change", afterDestroy, afterChange, arete::hcs::SnapshotDeltaBlockSize);
+
+  // Deltas chained from the base restore the latest state.
+  auto chained = base;
+  arete::hcs::applySnapshotDelta(chained, arete::hcs::diffSnapshots(base, afterCreate));
+  arete::hcs::applySnapshotDelta(chained, arete::hcs::diffSnapshots(afterCreate, afterDestroy));
+  arete::hcs::applySnapshotDelta(chained, arete::hcs::diffSnapshots(afterDestroy, afterChange));
+  Arena restored;
+  restored.restore(chained);
+  passed &= check(holds(restored, handles), "chained deltas restore the arena");
+  passed &= check(restored.getObject(handles[10])->get().values[3] == 1.0f, "changed object is restored");
+
+  passed &= rejectsCorrupt(afterChange, handles);
+
+  // Snapshot without sections is diffed as a single section.
+  const arete::hcs::Snapshot flatBase {.data = base.data, .sections = {}};
+  const arete::hcs::Snapshot flatTarget {.data = afterChange.data, .sections = {}};
+  auto flat = flatBase;
+  arete::hcs::applySnapshotDelta(flat, arete::hcs::diffSnapshots(flatBase, flatTarget));
+  passed &= check(flat.data == afterChange.data, "delta of unsectioned snapshots reproduces the target");
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
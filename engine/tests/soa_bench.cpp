@@ -0,0 +1,97 @@
+#include <arete/hcs/arena.hpp>
+#include <arete/hcs/soa_arena.hpp>
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+
+//! Body stored as a whole object.
+struct Body
+{
+  glm::vec3 position {0};
+  glm::quat rotation {1, 0, 0, 0};
+  glm::vec3 scale {1};
+  glm::vec3 velocity {0};
+};
+
+//! Body stored as separate fields.
+using BodyFields = std::tuple<glm::vec3, glm::quat, glm::vec3, glm::vec3>;
+constexpr size_t PositionField = 0;
+constexpr size_t VelocityField = 3;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t EntityCount = 1'000'000;
+constexpr size_t StepCount = 100;
+constexpr float DeltaTime = 1.0f / 60.0f;
+
+//! Integrates positions of bodies stored in Arena.
+//! @returns Milliseconds per step.
+double benchArena()
+{
+  arete::hcs::Arena<uint32_t, Body> arena;
+  for (size_t i = 0; i < EntityCount; ++i)
+  {
+    auto [handle, body] = arena.createObject();
+    body.velocity = glm::vec3(static_cast<float>(i % 7), 1, 0);
+  }
+
+  const auto start = Clock::now();
+  for (size_t step = 0; step < StepCount; ++step)
+  {
+    arena.objects().forEachPage([](std::span<Body> bodies) {
+      for (auto& body: bodies)
+        body.position += body.velocity * DeltaTime;
+    });
+  }
+  const auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  std::printf("  (checksum %f)\n", arena.objects()[EntityCount - 1].position.y);
+  return elapsed / StepCount;
+}
+
+//! Integrates positions of bodies stored in SoAArena.
+//! @returns Milliseconds per step.
+double benchSoAArena()
+{
+  arete::hcs::SoAArena<uint32_t, BodyFields> arena;
+  arena.reserve(EntityCount);
+  for (size_t i = 0; i < EntityCount; ++i)
+  {
+    [[maybe_unused]] const auto handle = arena.createObject(
+      glm::vec3(0),
+      glm::quat(1, 0, 0, 0),
+      glm::vec3(1),
+      glm::vec3(static_cast<float>(i % 7), 1, 0));
+  }
+
+  const auto start = Clock::now();
+  for (size_t step = 0; step < StepCount; ++step)
+  {
+    const auto positions = arena.field<PositionField>();
+    const auto velocities = arena.field<VelocityField>();
+    for (size_t i = 0; i < positions.size(); ++i)
+      positions[i] += velocities[i] * DeltaTime;
+  }
+  const auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  std::printf("  (checksum %f)\n", arena.field<PositionField>()[EntityCount - 1].y);
+  return elapsed / StepCount;
+}
+
+} // namespace
+
+int main()
+{
+  const double aosMs = benchArena();
+  const double soaMs = benchSoAArena();
+  std::printf(
+    "entities=%zu arena=%.3f ms/step soa_arena=%.3f ms/step speedup=%.2fx\n",
+    EntityCount, aosMs, soaMs, aosMs / soaMs);
+  return 0;
+}
@@ -0,0 +1,228 @@
+#include <arete/hcs/spatial_index.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using arete::hcs::Aabb;
+using arete::hcs::SpatialHandle;
+using arete::hcs::SpatialIndex;
+
+constexpr size_t ObjectCount = 1'000'000;
+constexpr float WorldHalfSize = 1000.0f;
+constexpr size_t QueryCount = 100;
+
+//! @returns Milliseconds elapsed since the start.
+double millisecondsSince(const Clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//! Runs queries against the index and verifies some of them against every object.
+//! @returns Milliseconds per query of the index.
+template<typename Query, typename Test>
+double benchQuery(
+  const char* name,
+  const std::vector<Aabb>& bounds,
+  std::mt19937& random,
+  Query&& query,
+  Test&& test,
+  bool& matches)
+{
+  std::vector<SpatialHandle> objects;
+  double elapsed = 0;
+  size_t found = 0;
+  for (size_t round = 0; round < QueryCount; ++round)
+  {
+    const auto seed = random();
+    objects.clear();
+
+    const auto start = Clock::now();
+    query(seed, objects);
+    elapsed += millisecondsSince(start);
+    found += objects.size();
+
+    // Verified on a few rounds, scanning every object is slow.
+    if (round % 25 == 0)
+    {
+      size_t expected = 0;
+      for (const auto& object: bounds)
+        expected += test(seed, object) ? 1 : 0;
+      if (expected != objects.size())
+      {
+        std::printf("%s query found %zu objects, expected %zu\n", name, objects.size(), expected);
+        matches = false;
+      }
+    }
+  }
+
+  std::printf(
+    "%s query=%.3f ms (%.0f objects found on average)\n",
+    name, elapsed / QueryCount, static_cast<double>(found) / QueryCount);
+  return elapsed / QueryCount;
+}
+
+} // namespace
+
+int main()
+{
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> position(-WorldHalfSize, WorldHalfSize);
+  std::uniform_real_distribution<float> size(0.25f, 2.0f);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+  std::vector<Aabb> bounds(ObjectCount);
+  for (auto& object: bounds)
+  {
+    object = Aabb::fromCenter(
+      glm::vec3(position(random), position(random), position(random)),
+      glm::vec3(size(random), size(random), size(random)));
+  }
+
+  SpatialIndex index(Aabb::fromCenter(glm::vec3(0.0f), glm::vec3(WorldHalfSize)));
+  std::vector<SpatialHandle> handles(ObjectCount);
+
+  auto start = Clock::now();
+  index.insert(bounds, handles);
+  std::printf(
+    "objects=%zu nodes=%zu insert=%.2f ms\n",
+    index.size(), index.nodeCount(), millisecondsSince(start));
+
+  // Tenth of the objects moves a little, as in a frame.
+  std::vector<SpatialHandle> moved;
+  std::vector<Aabb> movedBounds;
+  for (size_t i = 0; i < ObjectCount; i += 10)
+  {
+    bounds[i] = Aabb::fromCenter(
+      bounds[i].center() + glm::vec3(unit(random), unit(random), unit(random)) * 0.5f,
+      bounds[i].extents());
+    moved.push_back(handles[i]);
+    movedBounds.push_back(bounds[i]);
+  }
+  start = Clock::now();
+  index.refit(moved, movedBounds);
+  std::printf("refit of %zu moved objects=%.2f ms\n", moved.size(), millisecondsSince(start));
+
+  bool matches = true;
+  benchQuery(
+    "aabb", bounds, random,
+    [&index](const uint32_t seed, std::vector<SpatialHandle>& objects) {
+      std::mt19937 queryRandom(seed);
+      std::uniform_real_distribution<float> center(-WorldHalfSize, WorldHalfSize);
+      index.query(Aabb::fromCenter(
+        glm::vec3(center(queryRandom), center(queryRandom), center(queryRandom)), glm::vec3(50.0f)), objects);
+    },
+    [](const uint32_t seed, const Aabb& object) {
+      std::mt19937 queryRandom(seed);
+      std::uniform_real_distribution<float> center(-WorldHalfSize, WorldHalfSize);
+      return Aabb::fromCenter(
+        glm::vec3(center(queryRandom), center(queryRandom), center(queryRandom)), glm::vec3(50.0f)).intersects(object);
+    },
+    matches);
+
+  const auto sphereOf = [](const uint32_t seed) {
+    std::mt19937 queryRandom(seed);
+    std::uniform_real_distribution<float> center(-WorldHalfSize, WorldHalfSize);
+    return arete::hcs::Sphere{
+      .center = glm::vec3(center(queryRandom), center(queryRandom), center(queryRandom)),
+      .radius = 50.0f};
+  };
+  benchQuery(
+    "sphere", bounds, random,
+    [&index, &sphereOf](const uint32_t seed, std::vector<SpatialHandle>& objects) {
+      index.query(sphereOf(seed), objects);
+    },
+    [&sphereOf](const uint32_t seed, const Aabb& object) {
+      return sphereOf(seed).intersects(object);
+    },
+    matches);
+
+  // Camera inside the world looking along a random direction, as the engine projects it.
+  glm::mat4 clip(1.0f);
+  clip[1][1] = -1.0f;
+  clip[2][2] = 0.5f;
+  clip[3][2] = 0.5f;
+  const auto frustumOf = [&clip](const uint32_t seed) {
+    std::mt19937 queryRandom(seed);
+    std::uniform_real_distribution<float> center(-WorldHalfSize, WorldHalfSize);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    const glm::vec3 eye(center(queryRandom), center(queryRandom), center(queryRandom));
+    const glm::vec3 forward(direction(queryRandom), direction(queryRandom), 1.0f);
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    const glm::mat4 view = glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+    return arete::hcs::Frustum::fromMatrix(clip * projection * view);
+  };
+  benchQuery(
+    "frustum", bounds, random,
+    [&index, &frustumOf](const uint32_t seed, std::vector<SpatialHandle>& objects) {
+      index.query(frustumOf(seed), objects);
+    },
+    [&frustumOf](const uint32_t seed, const Aabb& object) {
+      return frustumOf(seed).intersects(object);
+    },
+    matches);
+
+  const auto rayOf = [](const uint32_t seed) {
+    std::mt19937 queryRandom(seed);
+    std::uniform_real_distribution<float> center(-WorldHalfSize, WorldHalfSize);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    return arete::hcs::Ray{
+      .origin = glm::vec3(center(queryRandom), center(queryRandom), center(queryRandom)),
+      .direction = glm::normalize(glm::vec3(direction(queryRandom), direction(queryRandom), direction(queryRandom)))};
+  };
+  benchQuery(
+    "ray", bounds, random,
+    [&index, &rayOf](const uint32_t seed, std::vector<SpatialHandle>& objects) {
+      index.query(rayOf(seed), 500.0f, objects);
+    },
+    [&rayOf](const uint32_t seed, const Aabb& object) {
+      const auto ray = rayOf(seed);
+      return ray.intersect(object, 1.0f / ray.direction, 500.0f).has_value();
+    },
+    matches);
+
+  // Nearest hit must be the nearest of all the hits.
+  double raycastMs = 0;
+  for (size_t round = 0; round < QueryCount; ++round)
+  {
+    const auto ray = rayOf(random());
+    start = Clock::now();
+    const auto hit = index.raycast(ray, 500.0f);
+    raycastMs += millisecondsSince(start);
+
+    if (round % 25 != 0)
+      continue;
+    float nearest = 500.0f;
+    bool hitAny = false;
+    for (const auto& object: bounds)
+    {
+      if (const auto distance = ray.intersect(object, 1.0f / ray.direction, 500.0f))
+      {
+        nearest = std::min(nearest, *distance);
+        hitAny = true;
+      }
+    }
+    if (hitAny != hit.has_value() || (hit && hit->distance != nearest))
+    {
+      std::printf("raycast hit at %.3f, expected %.3f\n", hit ? hit->distance : -1.0f, nearest);
+      matches = false;
+    }
+  }
+  std::printf("raycast=%.3f ms\n", raycastMs / QueryCount);
+
+  index.remove(handles);
+  std::printf("removed all, objects=%zu nodes=%zu\n", index.size(), index.nodeCount());
+  if (index.nodeCount() != 1)
+    matches = false;
+
+  std::printf(matches ? "passed\n" : "failed\n");
+  return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,172 @@
+#include <arete/task.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+
+//! Frames after which a task is considered stuck.
+constexpr size_t MaxFrameCount = 1'000'000;
+
+//! Starts the task and resumes frames until it finished, or got stuck.
+template<class Type>
+void runFrames(arete::Task<Type>& task, arete::FrameScheduler& frames, size_t& frameCount)
+{
+  task.start();
+  for (frameCount = 0; !task.done() && frameCount < MaxFrameCount; ++frameCount)
+  {
+    frames.resume();
+    std::this_thread::yield();
+  }
+}
+
+arete::Task<int> square(const int value)
+{
+  co_return value * value;
+}
+
+arete::Task<int> sumOfSquares(const int count)
+{
+  int sum = 0;
+  for (int value = 1; value <= count; ++value)
+    sum += co_await square(value);
+  co_return sum;
+}
+
+arete::Task<> fail()
+{
+  throw std::runtime_error("Task failed.");
+  co_return;
+}
+
+arete::Task<bool> catchFailure()
+{
+  try
+  {
+    co_await fail();
+  } catch (const std::runtime_error&)
+  {
+    co_return true;
+  }
+  co_return false;
+}
+
+arete::Task<int> waitFrames(arete::FrameScheduler& frames, const int count)
+{
+  for (int frame = 0; frame < count; ++frame)
+    co_await frames.nextFrame();
+  co_return count;
+}
+
+arete::Task<size_t> loadAndComputeOnJobs(
+  arete::FrameScheduler& frames,
+  arete::threading::JobSystem& jobs,
+  const std::filesystem::path& path)
+{
+  const auto content = co_await arete::readFile(path, jobs);
+
+  arete::threading::JobCounter counter;
+  std::atomic<size_t> sum {0};
+  for (const uint8_t byte: content)
+  {
+    jobs.run(counter, [&sum, byte]() {
+      sum.fetch_add(byte, std::memory_order_relaxed);
+    });
+  }
+  co_await arete::waitFor(counter, jobs);
+
+  // Back on the frame thread, once the flag flips.
+  std::atomic<bool> ready {false};
+  jobs.run(counter, [&ready]() {
+    ready.store(true, std::memory_order_release);
+  });
+  co_await frames.until([&ready]() {
+    return ready.load(std::memory_order_acquire);
+  });
+  jobs.wait(counter);
+  co_return sum.load();
+}
+
+arete::Task<size_t> loadOnSingleThread(
+  arete::FrameScheduler& frames,
+  arete::threading::JobSystem& jobs,
+  const std::filesystem::path& path)
+{
+  co_await frames.nextFrame();
+  const auto content = co_await arete::readFile(path, jobs);
+  co_await arete::resumeOn(jobs);
+
+  arete::threading::JobCounter counter;
+  size_t sum = 0;
+  jobs.run(counter, [&sum, &content]() {
+    for (const uint8_t byte: content)
+      sum += byte;
+  });
+  co_await arete::waitFor(counter, jobs);
+  co_return sum;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  arete::FrameScheduler frames;
+  size_t frameCount = 0;
+
+  {
+    auto task = sumOfSquares(10);
+    task.start();
+    passed &= task.done() && task.result() == 385;
+    std::printf("sum of squares: %d\n", task.result());
+  }
+
+  {
+    auto task = catchFailure();
+    task.start();
+    passed &= task.done() && task.result();
+    std::printf("exception propagated: %d\n", task.result());
+  }
+
+  {
+    auto task = waitFrames(frames, 3);
+    runFrames(task, frames, frameCount);
+    passed &= task.result() == 3 && frameCount == 3;
+    std::printf("resumed after %zu frames\n", frameCount);
+  }
+
+  {
+    const auto path = std::filesystem::temp_directory_path() / "arete_task_test.bin";
+    {
+      std::ofstream output(path, std::ios::binary);
+      for (int byte = 0; byte < 100; ++byte)
+        output.put(static_cast<char>(byte));
+    }
+
+    arete::threading::JobSystem jobs(4);
+    auto task = loadAndComputeOnJobs(frames, jobs, path);
+    runFrames(task, frames, frameCount);
+    passed &= task.done() && task.result() == 4950 && frames.size() == 0;
+    std::printf("loaded on jobs: %zu after %zu frames\n", task.done() ? task.result() : 0, frameCount);
+
+    // Without workers the task continues on the frame thread instead of waiting for a worker.
+    arete::threading::JobSystem singleThread(1);
+    auto singleThreadTask = loadOnSingleThread(frames, singleThread, path);
+    runFrames(singleThreadTask, frames, frameCount);
+    passed &= singleThreadTask.done() && singleThreadTask.result() == 4950 && frames.size() == 0;
+    std::printf(
+      "loaded on a single thread: %zu after %zu frames\n",
+      singleThreadTask.done() ? singleThreadTask.result() : 0, frameCount);
+
+    std::filesystem::remove(path);
+  }
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+#include <arete/tickClock.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+
+using Clock = arete::TickClock::Clock;
+
+constexpr float TickRate = 100.0f;
+constexpr size_t TickCount = 50;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Ticks with the interval between calls.
+//! @returns True if the reported deltas add up to the wall time within a period.
+bool ticksMatchWallTime(const std::chrono::microseconds interval)
+{
+  arete::TickClock clock(TickRate);
+  clock.reset();
+  const auto start = Clock::now();
+
+  double simulated = 0;
+  auto lastTick = start;
+  for (size_t ticks = 0; ticks < TickCount;)
+  {
+    std::this_thread::sleep_for(interval);
+    const auto tick = clock.tick();
+    if (!tick.shouldTick)
+      continue;
+    lastTick = Clock::now();
+    simulated += tick.deltaTime;
+    ++ticks;
+  }
+
+  const double wall = std::chrono::duration<double>(lastTick - start).count();
+  const double period = 1.0 / TickRate;
+  std::printf(
+    "interval %lld us: %zu ticks reported %.4f s in %.4f s\n",
+    static_cast<long long>(interval.count()), TickCount, simulated, wall);
+  return std::abs(simulated - wall) <= period;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= check(ticksMatchWallTime(std::chrono::microseconds(500)), "reported time matches wall time");
+  passed &= check(ticksMatchWallTime(std::chrono::microseconds(3700)), "remainders are reported once");
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
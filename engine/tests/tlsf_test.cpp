@@ -0,0 +1,168 @@
+#include <arete/tlsf.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+using arete::TlsfAllocator;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! @returns True if the allocations are aligned, lie in the address space and do not overlap.
+bool valid(std::vector<TlsfAllocator::Allocation> allocations, const TlsfAllocator::Size capacity)
+{
+  std::sort(allocations.begin(), allocations.end(), [](const auto& a, const auto& b) {
+    return a.offset < b.offset;
+  });
+  for (size_t i = 0; i < allocations.size(); ++i)
+  {
+    if (allocations[i].offset + allocations[i].size > capacity)
+      return false;
+    if (i > 0 && allocations[i - 1].offset + allocations[i - 1].size > allocations[i].offset)
+      return false;
+  }
+  return true;
+}
+
+//! Allocates and frees ranges of random sizes and alignments.
+bool churn()
+{
+  constexpr TlsfAllocator::Size Capacity = 64ull << 20;
+  constexpr TlsfAllocator::Size Alignments[] = {1, 4, 16, 256, 4096, 65536};
+
+  TlsfAllocator allocator(Capacity);
+  std::vector<TlsfAllocator::Allocation> allocations;
+  std::mt19937 random(7);
+  std::uniform_int_distribution<TlsfAllocator::Size> size(1, 256 << 10);
+  std::uniform_int_distribution<size_t> alignment(0, std::size(Alignments) - 1);
+
+  bool passed = true;
+  for (size_t round = 0; round < 200'000; ++round)
+  {
+    // Grows until it runs out of space half of the time, shrinks otherwise.
+    if (allocations.empty() || random() % 2 == 0)
+    {
+      const auto requestedAlignment = Alignments[alignment(random)];
+      if (const auto allocation = allocator.allocate(size(random), requestedAlignment))
+      {
+        passed &= check(allocation->offset % requestedAlignment == 0, "offset is aligned");
+        allocations.push_back(*allocation);
+      }
+    } else
+    {
+      const size_t index = random() % allocations.size();
+      allocator.free(allocations[index]);
+      allocations[index] = allocations.back();
+      allocations.pop_back();
+    }
+
+    if (round % 10'000 == 0)
+      passed &= check(valid(allocations, Capacity), "allocations do not overlap");
+  }
+
+  TlsfAllocator::Size usedSize = 0;
+  for (const auto& allocation: allocations)
+    usedSize += allocation.size;
+  const auto stats = allocator.stats();
+  passed &= check(stats.usedSize == usedSize, "used size is the sum of the allocations");
+  passed &= check(stats.allocationCount == allocations.size(), "allocations are counted");
+  passed &= check(stats.largestFreeSize <= stats.freeSize(), "largest free range fits the free space");
+  std::printf(
+    "churn: %zu allocations, %.1f%% used, %zu free ranges, fragmentation %.3f\n",
+    stats.allocationCount, 100.0 * static_cast<double>(stats.usedSize) / Capacity,
+    stats.freeRangeCount, stats.fragmentation());
+
+  for (const auto& allocation: allocations)
+    allocator.free(allocation);
+  const auto emptyStats = allocator.stats();
+  passed &= check(allocator.empty(), "allocator is empty");
+  passed &= check(emptyStats.freeRangeCount == 1, "free ranges merge into one");
+  passed &= check(emptyStats.largestFreeSize == Capacity, "whole space is free");
+  passed &= check(emptyStats.fragmentation() == 0.0f, "empty allocator is not fragmented");
+  return passed;
+}
+
+//! Fills the space exactly and frees it in an order merging from both sides.
+bool exactFit()
+{
+  constexpr TlsfAllocator::Size Capacity = 1 << 20;
+  constexpr TlsfAllocator::Size RangeSize = 4096;
+
+  TlsfAllocator allocator(Capacity);
+  std::vector<TlsfAllocator::Allocation> allocations;
+  while (const auto allocation = allocator.allocate(RangeSize, RangeSize))
+    allocations.push_back(*allocation);
+
+  bool passed = true;
+  passed &= check(allocations.size() == Capacity / RangeSize, "whole space is allocated");
+  passed &= check(allocator.stats().freeRangeCount == 0, "no free range is left");
+  passed &= check(!allocator.allocate(1).has_value(), "full allocator fails");
+
+  // Every other range first, then the rest merging with both neighbors.
+  for (size_t i = 0; i < allocations.size(); i += 2)
+    allocator.free(allocations[i]);
+  const auto halfStats = allocator.stats();
+  passed &= check(halfStats.largestFreeSize == RangeSize, "freed ranges are not adjacent");
+  passed &= check(halfStats.fragmentation() > 0.99f, "alternating ranges are fragmented");
+  passed &= check(!allocator.allocate(2 * RangeSize).has_value(), "fragmented space fails large request");
+
+  for (size_t i = 1; i < allocations.size(); i += 2)
+    allocator.free(allocations[i]);
+  passed &= check(allocator.stats().freeRangeCount == 1, "free ranges merge into one");
+  passed &= check(allocator.allocate(Capacity).has_value(), "whole space is allocated at once");
+  return passed;
+}
+
+//! Rejects invalid requests.
+bool invalidRequests()
+{
+  TlsfAllocator allocator(1024);
+  bool passed = true;
+
+  const auto throwsInvalid = [](auto&& call) {
+    try
+    {
+      call();
+    } catch (const std::invalid_argument&)
+    {
+      return true;
+    }
+    return false;
+  };
+
+  passed &= check(throwsInvalid([&]() { (void) allocator.allocate(0); }), "zero size throws");
+  passed &= check(throwsInvalid([&]() { (void) allocator.allocate(16, 3); }), "unaligned alignment throws");
+  passed &= check(!allocator.allocate(2048).has_value(), "oversized request fails");
+
+  const auto allocation = allocator.allocate(16);
+  passed &= check(!allocator.allocate(768, 512).has_value(), "alignment padding past the capacity fails");
+  passed &= check(allocator.allocate(512, 512).has_value(), "aligned request fits after the padding");
+  allocator.free(*allocation);
+  passed &= check(throwsInvalid([&]() { allocator.free(*allocation); }), "double free throws");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= churn();
+  passed &= exactFit();
+  passed &= invalidRequests();
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
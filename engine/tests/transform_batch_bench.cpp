@@ -0,0 +1,174 @@
+#include <arete/hcs/components/spatial.hpp>
+#include <arete/hcs/transform_batch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t TransformCount = 100'000;
+constexpr size_t RoundCount = 50;
+//! Bytes read and written by the kernel per transform, ten floats in and two matrices out.
+constexpr size_t BytesPerTransform = 10 * sizeof(float) + 2 * sizeof(glm::mat4);
+
+//! Keeps results observable so the computation is not optimized out.
+volatile float sink = 0;
+
+//! Transforms as structure of arrays and as spatial components.
+struct Transforms
+{
+  std::vector<float> arrays[10];
+  std::vector<arete::hcs::SpatialComponent> spatials;
+
+  [[nodiscard]] arete::hcs::TransformBatch batch() const
+  {
+    return {
+      arrays[0], arrays[1], arrays[2],
+      arrays[3], arrays[4], arrays[5], arrays[6],
+      arrays[7], arrays[8], arrays[9]};
+  }
+};
+
+Transforms randomTransforms(const size_t count)
+{
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+
+  Transforms transforms;
+  for (auto& array: transforms.arrays)
+    array.resize(count);
+  transforms.spatials.resize(count);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const glm::vec3 position(distribution(random), distribution(random), distribution(random));
+    const glm::quat rotation = glm::normalize(glm::quat(
+      distribution(random), distribution(random), distribution(random), distribution(random)));
+    const glm::vec3 scale(distribution(random), distribution(random), distribution(random));
+
+    const float values[10] {
+      position.x, position.y, position.z,
+      rotation.x, rotation.y, rotation.z, rotation.w,
+      scale.x, scale.y, scale.z};
+    for (size_t array = 0; array < 10; ++array)
+      transforms.arrays[array][i] = values[array];
+    transforms.spatials[i].position(position).rotation(rotation).scale(scale);
+  }
+  return transforms;
+}
+
+//! @returns Nanoseconds per transform of the callable.
+template<typename Callable>
+double measure(Callable&& callable)
+{
+  const auto start = Clock::now();
+  for (size_t round = 0; round < RoundCount; ++round)
+    callable();
+  const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  return elapsed / static_cast<double>(RoundCount * TransformCount);
+}
+
+//! @returns Largest difference of the matrices relative to their magnitude.
+float maxError(const std::vector<glm::mat4>& matrices, const std::vector<glm::mat4>& references)
+{
+  float error = 0;
+  for (size_t i = 0; i < matrices.size(); ++i)
+  {
+    for (int column = 0; column < 4; ++column)
+    {
+      for (int row = 0; row < 4; ++row)
+      {
+        const float reference = references[i][column][row];
+        const float difference = std::abs(matrices[i][column][row] - reference);
+        error = std::max(error, difference / std::max(1.0f, std::abs(reference)));
+      }
+    }
+  }
+  return error;
+}
+
+} // namespace
+
+int main()
+{
+  const Transforms transforms = randomTransforms(TransformCount);
+  glm::mat4 viewProjection(1.0f);
+  viewProjection[2][3] = -1.0f;
+  viewProjection[3][2] = -0.2f;
+
+  std::vector<glm::mat4> referenceWorlds(TransformCount);
+  std::vector<glm::mat4> referenceClips(TransformCount);
+  const double glmNs = measure([&]() {
+    for (size_t i = 0; i < TransformCount; ++i)
+    {
+      referenceWorlds[i] = transforms.spatials[i].localMatrix();
+      referenceClips[i] = viewProjection * referenceWorlds[i];
+    }
+    sink = referenceClips[TransformCount / 2][3][3];
+  });
+  std::printf("transforms=%zu glm per object=%.2f ns/transform\n", TransformCount, glmNs);
+
+  // Copy of the outputs moves as many bytes as the kernel without any arithmetic,
+  // the fastest a kernel bound by memory bandwidth can get.
+  std::vector<glm::mat4> copiedWorlds(TransformCount);
+  std::vector<glm::mat4> copiedClips(TransformCount);
+  const double copyNs = measure([&]() {
+    std::copy(referenceWorlds.begin(), referenceWorlds.end(), copiedWorlds.begin());
+    std::copy(referenceClips.begin(), referenceClips.end(), copiedClips.begin());
+    sink = copiedClips[TransformCount / 2][3][3];
+  });
+  std::printf(
+    "copy of the outputs=%.2f ns/transform bandwidth=%.1f GB/s speedup bound=%.2fx\n",
+    copyNs, static_cast<double>(BytesPerTransform) / copyNs, glmNs / copyNs);
+
+  const auto supported = arete::hcs::detectSimdLevel();
+  double bestNs = glmNs;
+  auto bestLevel = arete::hcs::SimdLevel::Scalar;
+  for (const auto level: {arete::hcs::SimdLevel::Scalar, arete::hcs::SimdLevel::Sse41, arete::hcs::SimdLevel::Avx2})
+  {
+    if (level > supported)
+      continue;
+
+    std::vector<glm::mat4> worlds(TransformCount);
+    std::vector<glm::mat4> clips(TransformCount);
+    const double kernelNs = measure([&]() {
+      arete::hcs::composeTransforms(transforms.batch(), viewProjection, worlds, clips, level);
+      sink = clips[TransformCount / 2][3][3];
+    });
+
+    std::printf(
+      "%s batch=%.2f ns/transform speedup=%.2fx bandwidth=%.1f GB/s max error world=%g clip=%g\n",
+      arete::hcs::simdLevelName(level),
+      kernelNs,
+      glmNs / kernelNs,
+      static_cast<double>(BytesPerTransform) / kernelNs,
+      maxError(worlds, referenceWorlds),
+      maxError(clips, referenceClips));
+
+    if (kernelNs < bestNs)
+    {
+      bestNs = kernelNs;
+      bestLevel = level;
+    }
+  }
+
+  // Speedup of a kernel bound by memory bandwidth is capped by the copy of its outputs,
+  // not by the width of its registers.
+  std::printf(
+    "%s speedup=%.2fx at %.0f%% of the copy bandwidth: every transform moves %zu bytes, "
+    "so the kernel is bound by memory bandwidth and its speedup over glm is capped at %.2fx\n",
+    arete::hcs::simdLevelName(bestLevel),
+    glmNs / bestNs,
+    100.0 * copyNs / bestNs,
+    BytesPerTransform,
+    glmNs / copyNs);
+
+  return 0;
+}
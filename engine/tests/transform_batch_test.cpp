@@ -0,0 +1,187 @@
+#include <arete/hcs/components/spatial.hpp>
+#include <arete/hcs/transform_batch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::SimdLevel;
+
+//! Largest error of the SIMD kernels relative to the scalar kernel, fused multiply-add rounds once less.
+constexpr float MaxRelativeError = 1.2e-6f;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Transforms as structure of arrays and as spatial components.
+struct Transforms
+{
+  std::vector<float> arrays[10];
+  std::vector<arete::hcs::SpatialComponent> spatials;
+
+  [[nodiscard]] arete::hcs::TransformBatch batch() const
+  {
+    return {
+      arrays[0], arrays[1], arrays[2],
+      arrays[3], arrays[4], arrays[5], arrays[6],
+      arrays[7], arrays[8], arrays[9]};
+  }
+};
+
+Transforms randomTransforms(const size_t count, std::mt19937& random)
+{
+  std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+
+  Transforms transforms;
+  for (auto& array: transforms.arrays)
+    array.resize(count);
+  transforms.spatials.resize(count);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const glm::vec3 position(distribution(random), distribution(random), distribution(random));
+    const glm::quat rotation = glm::normalize(glm::quat(
+      distribution(random), distribution(random), distribution(random), distribution(random)));
+    const glm::vec3 scale(distribution(random), distribution(random), distribution(random));
+
+    const float values[10] {
+      position.x, position.y, position.z,
+      rotation.x, rotation.y, rotation.z, rotation.w,
+      scale.x, scale.y, scale.z};
+    for (size_t array = 0; array < 10; ++array)
+      transforms.arrays[array][i] = values[array];
+    transforms.spatials[i].position(position).rotation(rotation).scale(scale);
+  }
+  return transforms;
+}
+
+//! @returns Largest difference of the matrices relative to their magnitude.
+float maxError(std::span<const glm::mat4> matrices, std::span<const glm::mat4> references)
+{
+  float error = 0;
+  for (size_t i = 0; i < matrices.size(); ++i)
+  {
+    for (int column = 0; column < 4; ++column)
+    {
+      for (int row = 0; row < 4; ++row)
+      {
+        const float reference = references[i][column][row];
+        const float difference = std::abs(matrices[i][column][row] - reference);
+        error = std::max(error, difference / std::max(1.0f, std::abs(reference)));
+      }
+    }
+  }
+  return error;
+}
+
+//! Composes the transforms with every supported instruction set and compares them with the scalar kernel.
+//! @param offset Matrices skipped at the beginning of the outputs, misaligning them for streaming stores.
+bool matchesScalar(const size_t count, const size_t offset, std::mt19937& random)
+{
+  const Transforms transforms = randomTransforms(count, random);
+  glm::mat4 viewProjection(1.0f);
+  viewProjection[2][3] = -1.0f;
+  viewProjection[3][2] = -0.2f;
+
+  std::vector<glm::mat4> referenceWorlds(count);
+  std::vector<glm::mat4> referenceClips(count);
+  arete::hcs::composeTransforms(
+    transforms.batch(), viewProjection, referenceWorlds, referenceClips, SimdLevel::Scalar);
+
+  // Scalar kernel matches the spatial component.
+  std::vector<glm::mat4> localMatrices(count);
+  for (size_t i = 0; i < count; ++i)
+    localMatrices[i] = transforms.spatials[i].localMatrix();
+  bool passed = check(
+    maxError(referenceWorlds, localMatrices) <= MaxRelativeError,
+    "scalar world matrices match the local matrices");
+
+  const auto supported = arete::hcs::detectSimdLevel();
+  for (const auto level: {SimdLevel::Sse41, SimdLevel::Avx2})
+  {
+    if (level > supported)
+      continue;
+
+    std::vector<glm::mat4> worldStorage(count + offset);
+    std::vector<glm::mat4> clipStorage(count + offset);
+    const auto worlds = std::span(worldStorage).subspan(offset);
+    const auto clips = std::span(clipStorage).subspan(offset);
+    arete::hcs::composeTransforms(transforms.batch(), viewProjection, worlds, clips, level);
+
+    const float worldError = maxError(worlds, referenceWorlds);
+    const float clipError = maxError(clips, referenceClips);
+    passed &= check(
+      worldError <= MaxRelativeError && clipError <= MaxRelativeError,
+      "SIMD matrices match the scalar ones");
+    if (worldError > MaxRelativeError || clipError > MaxRelativeError)
+    {
+      std::printf(
+        "%s with %zu transforms at offset %zu: error world=%g clip=%g\n",
+        arete::hcs::simdLevelName(level), count, offset, worldError, clipError);
+    }
+  }
+  return passed;
+}
+
+//! Rejects arrays of different sizes.
+bool mismatchedSizes()
+{
+  std::mt19937 random(1);
+  Transforms transforms = randomTransforms(8, random);
+  std::vector<glm::mat4> worlds(8);
+  std::vector<glm::mat4> clips(7);
+
+  const auto throwsInvalid = [](auto&& call) {
+    try
+    {
+      call();
+    } catch (const std::invalid_argument&)
+    {
+      return true;
+    }
+    return false;
+  };
+
+  bool passed = true;
+  passed &= check(
+    throwsInvalid([&]() { arete::hcs::composeTransforms(transforms.batch(), glm::mat4(1.0f), worlds, clips); }),
+    "outputs of different sizes throw");
+  clips.resize(8);
+  transforms.arrays[9].pop_back();
+  passed &= check(
+    throwsInvalid([&]() { arete::hcs::composeTransforms(transforms.batch(), glm::mat4(1.0f), worlds, clips); }),
+    "inputs of different sizes throw");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  std::mt19937 random(7);
+  bool passed = true;
+
+  // Counts below a batch, with tails of every length, aligned and misaligned outputs.
+  for (const size_t count: {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 1001, 100'003})
+  {
+    for (const size_t offset: {0, 1})
+      passed &= matchesScalar(count, offset, random);
+  }
+  passed &= mismatchedSizes();
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,76 @@
+#include <arete/hcs/transform_hierarchy.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using arete::hcs::TransformHandle;
+using arete::hcs::TransformHierarchy;
+
+constexpr size_t TransformCount = 100'000;
+constexpr size_t ChildCount = 4;
+constexpr size_t RoundCount = 20;
+
+//! Moves every n-th transform and updates the hierarchy.
+//! @returns Nanoseconds per update.
+template<typename Update>
+double benchMoving(
+  TransformHierarchy& hierarchy,
+  const std::vector<TransformHandle>& transforms,
+  const size_t stride,
+  Update&& update)
+{
+  double elapsed = 0;
+  for (size_t round = 0; round < RoundCount; ++round)
+  {
+    for (size_t i = round % stride; i < transforms.size(); i += stride)
+      hierarchy.modify(transforms[i]).translate(glm::vec3(0.001f, 0.0f, 0.0f));
+
+    const auto start = Clock::now();
+    update();
+    elapsed += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  }
+  return elapsed / RoundCount;
+}
+
+} // namespace
+
+int main()
+{
+  // Tree where every transform has up to four children.
+  TransformHierarchy hierarchy;
+  std::vector<TransformHandle> transforms;
+  transforms.reserve(TransformCount);
+  transforms.push_back(hierarchy.create());
+  for (size_t i = 1; i < TransformCount; ++i)
+    transforms.push_back(hierarchy.create({}, transforms[(i - 1) / ChildCount]));
+
+  const auto start = Clock::now();
+  hierarchy.update();
+  const double rebuildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  std::printf(
+    "transforms=%zu levels=%zu initial update with sort=%.2f ms\n",
+    hierarchy.size(), hierarchy.levelCount(), rebuildMs);
+
+  auto& jobs = arete::threading::JobSystem::shared();
+  for (const size_t stride: {1, 100, 10'000})
+  {
+    const double serialNs = benchMoving(hierarchy, transforms, stride, [&hierarchy]() {
+      hierarchy.update();
+    });
+    const size_t updated = hierarchy.updatedCount();
+    const double parallelNs = benchMoving(hierarchy, transforms, stride, [&hierarchy, &jobs]() {
+      hierarchy.update(jobs);
+    });
+
+    std::printf(
+      "moved every %zu: updated=%zu serial=%.3f ms parallel=%.3f ms (%.1f ns/updated)\n",
+      stride, updated, serialNs / 1e6, parallelNs / 1e6, serialNs / static_cast<double>(updated));
+  }
+
+  return 0;
+}
@@ -0,0 +1,281 @@
+#include <arete/hcs/transform_hierarchy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::SpatialComponent;
+using arete::hcs::TransformHandle;
+using arete::hcs::TransformHierarchy;
+
+constexpr TransformHandle NoTransform = TransformHierarchy::NoTransform;
+
+//! Expected state of a transform.
+struct TransformModel
+{
+  TransformHandle parent;
+  SpatialComponent local;
+};
+
+using Model = std::unordered_map<TransformHandle, TransformModel>;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! @returns World matrix composed recursively from the locals of the model.
+glm::mat4 naiveWorld(const Model& model, const TransformHandle transform)
+{
+  const auto& expected = model.at(transform);
+  if (expected.parent == NoTransform)
+    return expected.local.localMatrix();
+  return naiveWorld(model, expected.parent) * expected.local.localMatrix();
+}
+
+//! @returns True if the matrices are equal within a tolerance relative to their magnitude.
+bool nearlyEqual(const glm::mat4& a, const glm::mat4& b)
+{
+  for (int column = 0; column < 4; ++column)
+  {
+    for (int row = 0; row < 4; ++row)
+    {
+      const float tolerance = 1e-5f * std::max(1.0f, std::abs(b[column][row]));
+      if (std::abs(a[column][row] - b[column][row]) > tolerance)
+        return false;
+    }
+  }
+  return true;
+}
+
+//! @returns True if the transform is the ancestor or the transform itself.
+bool descendsFrom(const Model& model, TransformHandle transform, const TransformHandle ancestor)
+{
+  for (; transform != NoTransform; transform = model.at(transform).parent)
+  {
+    if (transform == ancestor)
+      return true;
+  }
+  return false;
+}
+
+//! @returns Count of the transform and its descendants.
+size_t subtreeSize(const Model& model, const TransformHandle root)
+{
+  return static_cast<size_t>(std::count_if(model.begin(), model.end(), [&](const auto& entry) {
+    return descendsFrom(model, entry.first, root);
+  }));
+}
+
+//! @returns Random local transform.
+SpatialComponent randomLocal(std::mt19937& random)
+{
+  std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+  std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+  std::uniform_real_distribution<float> scale(0.8f, 1.25f);
+
+  SpatialComponent local;
+  local.position(glm::vec3(position(random), position(random), position(random)));
+  local.rotation(glm::angleAxis(angle(random), glm::normalize(glm::vec3(0.3f, 1.0f, angle(random)))));
+  local.scale(glm::vec3(scale(random), scale(random), scale(random)));
+  return local;
+}
+
+//! Compares the hierarchy with the model.
+bool matchesModel(const TransformHierarchy& hierarchy, const Model& model)
+{
+  bool passed = true;
+  passed &= check(hierarchy.size() == model.size(), "hierarchy holds every live transform");
+
+  bool worldsMatch = true;
+  bool parentsMatch = true;
+  for (const auto& [transform, expected]: model)
+  {
+    worldsMatch &= nearlyEqual(hierarchy.world(transform), naiveWorld(model, transform));
+    parentsMatch &= hierarchy.parent(transform) == expected.parent;
+  }
+  passed &= check(worldsMatch, "world matrices match the recursive composition");
+  passed &= check(parentsMatch, "parents match");
+
+  // Parents precede their children, matrices are co-indexed with the handles.
+  const auto handles = hierarchy.handles();
+  const auto worlds = hierarchy.worldMatrices();
+  std::unordered_map<TransformHandle, size_t> order;
+  bool sorted = handles.size() == model.size() && worlds.size() == handles.size();
+  for (size_t i = 0; sorted && i < handles.size(); ++i)
+  {
+    const TransformHandle parent = hierarchy.parent(handles[i]);
+    sorted &= parent == NoTransform || order.contains(parent);
+    sorted &= &worlds[i] == &hierarchy.world(handles[i]);
+    order.emplace(handles[i], i);
+  }
+  passed &= check(sorted, "transforms are sorted parents first");
+  return passed;
+}
+
+//! Edits the hierarchy at random and compares it with the model after every update.
+bool randomEdits()
+{
+  TransformHierarchy hierarchy;
+  arete::threading::JobSystem jobs(4);
+  Model model;
+  std::vector<TransformHandle> live;
+  std::vector<TransformHandle> stale;
+  std::mt19937 random(3);
+
+  const auto randomLive = [&]() {
+    return live[random() % live.size()];
+  };
+  const auto create = [&](const TransformHandle parent) {
+    const auto local = randomLocal(random);
+    const TransformHandle transform = hierarchy.create(local, parent);
+    model.emplace(transform, TransformModel{parent, local});
+    live.push_back(transform);
+    return transform;
+  };
+
+  // Enough roots for the first level to be split across the job system.
+  for (size_t i = 0; i < 3 * TransformHierarchy::ParallelBatchSize; ++i)
+    create(i % 3 != 2 ? NoTransform : randomLive());
+
+  bool passed = true;
+  bool slotReused = false;
+  for (size_t round = 0; round < 200; ++round)
+  {
+    for (size_t edit = 0; edit < 50; ++edit)
+    {
+      if (live.empty())
+        create(NoTransform);
+
+      switch (random() % 6)
+      {
+        case 0:
+        {
+          const TransformHandle transform = create(random() % 4 == 0 ? NoTransform : randomLive());
+          slotReused |= std::any_of(stale.begin(), stale.end(), [transform](const TransformHandle handle) {
+            return TransformHierarchy::Handle::index(handle) == TransformHierarchy::Handle::index(transform);
+          });
+          break;
+        }
+        case 1:
+        {
+          // Destroys the subtree, rarely, so the hierarchy keeps growing.
+          if (random() % 4 != 0)
+            break;
+          const TransformHandle root = randomLive();
+          hierarchy.destroy(root);
+          std::vector<TransformHandle> destroyed;
+          for (const auto transform: live)
+          {
+            if (descendsFrom(model, transform, root))
+              destroyed.push_back(transform);
+          }
+          for (const auto transform: destroyed)
+            model.erase(transform);
+          std::erase_if(live, [&model](const TransformHandle transform) {
+            return !model.contains(transform);
+          });
+          stale.insert(stale.end(), destroyed.begin(), destroyed.end());
+          break;
+        }
+        case 2:
+        {
+          const TransformHandle transform = randomLive();
+          const TransformHandle parent = random() % 4 == 0 ? NoTransform : randomLive();
+          if (parent != NoTransform && descendsFrom(model, parent, transform))
+          {
+            bool thrown = false;
+            try
+            {
+              hierarchy.setParent(transform, parent);
+            } catch (const std::invalid_argument&)
+            {
+              thrown = true;
+            }
+            passed &= check(thrown, "attaching to a descendant throws");
+            break;
+          }
+          hierarchy.setParent(transform, parent);
+          model.at(transform).parent = parent;
+          break;
+        }
+        default:
+        {
+          const TransformHandle transform = randomLive();
+          const auto local = randomLocal(random);
+          hierarchy.modify(transform) = local;
+          model.at(transform).local = local;
+          break;
+        }
+      }
+    }
+
+    if (round % 2 == 0)
+      hierarchy.update(jobs);
+    else
+      hierarchy.update();
+    passed &= matchesModel(hierarchy, model);
+  }
+
+  // Modifying a transform recomputes its subtree only.
+  hierarchy.update();
+  passed &= check(hierarchy.updatedCount() == 0, "update without changes recomputes nothing");
+  for (size_t i = 0; i < 20; ++i)
+  {
+    const TransformHandle transform = randomLive();
+    hierarchy.modify(transform).translate(glm::vec3(1.0f, 0.0f, 0.0f));
+    model.at(transform).local.translate(glm::vec3(1.0f, 0.0f, 0.0f));
+    hierarchy.update();
+    passed &= check(hierarchy.updatedCount() == subtreeSize(model, transform), "update recomputes the dirty subtree");
+    passed &= check(hierarchy.updatedTransforms().front() == transform, "dirty transform is recomputed first");
+  }
+  passed &= matchesModel(hierarchy, model);
+
+  // Slots of the stale handles were reused by later transforms, the handles stay stale.
+  bool staleRejected = true;
+  for (const auto transform: stale)
+  {
+    staleRejected &= !hierarchy.contains(transform);
+    try
+    {
+      [[maybe_unused]] const auto& world = hierarchy.world(transform);
+      staleRejected = false;
+    } catch (const std::invalid_argument&)
+    {}
+    try
+    {
+      hierarchy.destroy(transform);
+      staleRejected = false;
+    } catch (const std::invalid_argument&)
+    {}
+  }
+  passed &= check(!stale.empty() && slotReused, "slots of destroyed transforms are reused");
+  passed &= check(staleRejected, "stale handles are rejected");
+
+  std::printf(
+    "random edits: %zu transforms in %zu levels, %zu stale handles\n",
+    hierarchy.size(), hierarchy.levelCount(), stale.size());
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= randomEdits();
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+#include <arete/threading/triple_buffer.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+
+//! Count of values published by the producer.
+constexpr uint64_t PublishCount = 200'000;
+
+//! Value spanning several words, so a torn read shows up as words of different sequences.
+struct Payload
+{
+  uint64_t sequence = 0;
+  std::array<uint64_t, 15> words {};
+};
+
+using Buffer = arete::threading::TripleBuffer<Payload>;
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! Writes the value of the sequence to the payload.
+void fill(Payload& payload, const uint64_t sequence)
+{
+  payload.sequence = sequence;
+  for (size_t word = 0; word < payload.words.size(); ++word)
+    payload.words[word] = sequence * payload.words.size() + word;
+}
+
+//! @returns True if every word of the payload belongs to its sequence.
+bool intact(const Payload& payload)
+{
+  bool matches = true;
+  for (size_t word = 0; word < payload.words.size(); ++word)
+    matches &= payload.words[word] == payload.sequence * payload.words.size() + word;
+  return matches;
+}
+
+//! Publishes and acquires on a single thread.
+bool singleThreaded()
+{
+  Payload initial;
+  fill(initial, 0);
+  Buffer buffer(initial);
+
+  bool passed = true;
+  passed &= check(!buffer.acquire(), "nothing is acquired before the first publish");
+  passed &= check(buffer.front().sequence == 0 && intact(buffer.front()), "front holds the initial value");
+
+  fill(buffer.back(), 1);
+  buffer.publish();
+  fill(buffer.back(), 2);
+  buffer.publish();
+  passed &= check(buffer.acquire(), "published value is acquired");
+  passed &= check(buffer.front().sequence == 2 && intact(buffer.front()), "latest published value is acquired");
+  passed &= check(!buffer.acquire(), "value is acquired only once");
+  passed &= check(buffer.front().sequence == 2, "front keeps the acquired value");
+  return passed;
+}
+
+//! Publishes increasing sequences from a producer thread while the consumer acquires them.
+//! @param blocking Consumer waits for every value instead of polling.
+bool producerConsumer(const bool blocking)
+{
+  Buffer buffer;
+  std::atomic<bool> finished {false};
+
+  std::thread producer([&buffer, &finished]() {
+    for (uint64_t sequence = 1; sequence <= PublishCount; ++sequence)
+    {
+      fill(buffer.back(), sequence);
+      buffer.publish();
+    }
+    finished.store(true, std::memory_order_release);
+  });
+
+  uint64_t previous = 0;
+  uint64_t acquired = 0;
+  bool monotonic = true;
+  bool untorn = true;
+  const auto consume = [&]() {
+    const auto& value = buffer.front();
+    monotonic &= value.sequence > previous;
+    untorn &= intact(value);
+    previous = value.sequence;
+    ++acquired;
+  };
+
+  if (blocking)
+  {
+    // The last value is always published as fresh, so waiting terminates once it is acquired.
+    // Stop at the first failure, a broken hand-over may never deliver the last value.
+    while (previous < PublishCount && monotonic && untorn)
+    {
+      buffer.wait();
+      if (buffer.acquire())
+        consume();
+    }
+  } else
+  {
+    while (!finished.load(std::memory_order_acquire))
+    {
+      if (buffer.acquire())
+        consume();
+    }
+    // Everything is published, the latest value is still pending unless it was acquired already.
+    if (buffer.acquire())
+      consume();
+  }
+  producer.join();
+
+  bool passed = true;
+  passed &= check(acquired > 0, "consumer acquires values");
+  passed &= check(monotonic, "acquired sequences never go backwards");
+  passed &= check(untorn, "acquired values are never torn");
+  passed &= check(previous == PublishCount, "latest published value is the one acquired");
+  passed &= check(!buffer.acquire(), "nothing is left to acquire");
+  return passed;
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= singleThreaded();
+  passed &= producerConsumer(false);
+  passed &= producerConsumer(true);
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,102 @@
+#include <arete/hcs/update.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ObjectCount = 100'000;
+constexpr size_t StepCount = 200;
+constexpr float DeltaTime = 1.0f / 60.0f;
+
+//! Mover updated in batches.
+struct BatchMover
+{
+  float position[3] {};
+  float velocity[3] {1.0f, 0.5f, 0.25f};
+
+  static void update(const std::span<BatchMover> movers, const float deltaTime)
+  {
+    for (auto& mover: movers)
+    {
+      for (int axis = 0; axis < 3; ++axis)
+        mover.position[axis] += mover.velocity[axis] * deltaTime;
+    }
+  }
+};
+
+//! Mover updated through the virtual tick.
+class VirtualMover
+  : public arete::ComponentTick
+{
+public:
+  void onTick(const float deltaTime) override
+  {
+    for (int axis = 0; axis < 3; ++axis)
+      position[axis] += velocity[axis] * deltaTime;
+  }
+
+  float position[3] {};
+  float velocity[3] {1.0f, 0.5f, 0.25f};
+};
+
+static_assert(arete::hcs::Ticks<BatchMover> && arete::hcs::BatchTickable<BatchMover>);
+static_assert(arete::hcs::Ticks<VirtualMover> && !arete::hcs::BatchTickable<VirtualMover>);
+static_assert(!arete::hcs::PhysTicks<BatchMover> && !arete::hcs::Draws<BatchMover>);
+
+template<class Mover>
+//! Measures ticking of the arena.
+//! @returns Nanoseconds per object.
+double benchArena()
+{
+  arete::hcs::Arena<uint32_t, Mover> arena;
+  arena.createObjects(ObjectCount);
+
+  const auto start = Clock::now();
+  for (size_t step = 0; step < StepCount; ++step)
+    arete::hcs::tickArena(arena, DeltaTime);
+  const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  std::printf("  (checksum %f)\n", arena.objects()[ObjectCount - 1].position[0]);
+  return elapsed / static_cast<double>(StepCount * ObjectCount);
+}
+
+//! Measures ticking of individually allocated components through the base class.
+//! @returns Nanoseconds per object.
+double benchHeap()
+{
+  std::vector<std::unique_ptr<arete::ComponentTick>> components;
+  components.reserve(ObjectCount);
+  for (size_t i = 0; i < ObjectCount; ++i)
+    components.push_back(std::make_unique<VirtualMover>());
+
+  const auto start = Clock::now();
+  for (size_t step = 0; step < StepCount; ++step)
+  {
+    for (const auto& component: components)
+      component->onTick(DeltaTime);
+  }
+  const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+  std::printf("  (checksum %f)\n", static_cast<VirtualMover&>(*components.back()).position[0]);
+  return elapsed / static_cast<double>(StepCount * ObjectCount);
+}
+
+} // namespace
+
+int main()
+{
+  const double batchNs = benchArena<BatchMover>();
+  const double virtualNs = benchArena<VirtualMover>();
+  const double heapNs = benchHeap();
+
+  std::printf(
+    "objects=%zu batched=%.3f ns/object virtual arena=%.3f ns/object virtual heap=%.3f ns/object\n",
+    ObjectCount, batchNs, virtualNs, heapNs);
+  return 0;
+}
@@ -0,0 +1,394 @@
+#include <arete/hcs/world.hpp>
+
+#include <cstdio>
+#include <iterator>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+using arete::hcs::ActorHandle;
+using arete::hcs::World;
+
+//! Component every actor is created with, identifies the actor.
+struct Identity
+{
+  uint32_t id = 0;
+};
+
+struct Position
+{
+  float x = 0.0f;
+  float y = 0.0f;
+  float z = 0.0f;
+};
+
+struct Velocity
+{
+  float x = 0.0f;
+};
+
+//! Component counting its live instances, so relocation and destruction leak nothing.
+struct Tracked
+{
+  static inline int64_t liveCount = 0;
+
+  explicit Tracked(std::string value = {})
+    : value(std::move(value))
+  {
+    ++liveCount;
+  }
+
+  Tracked(const Tracked& rhs)
+    : value(rhs.value)
+  {
+    ++liveCount;
+  }
+
+  Tracked(Tracked&& rhs) noexcept
+    : value(std::move(rhs.value))
+  {
+    ++liveCount;
+  }
+
+  Tracked& operator=(const Tracked& rhs) = default;
+  Tracked& operator=(Tracked&& rhs) noexcept = default;
+
+  ~Tracked()
+  {
+    --liveCount;
+  }
+
+  std::string value;
+};
+
+//! Component which throws when moved or copied from a component with the flag set.
+struct Exploding
+{
+  explicit Exploding(const bool explodes = false) noexcept
+    : explodes(explodes)
+  {}
+
+  Exploding(const Exploding& rhs)
+    : explodes(rhs.explodes)
+  {
+    if (explodes)
+      throw std::runtime_error("Exploding component.");
+  }
+
+  Exploding(Exploding&& rhs)
+    : Exploding(static_cast<const Exploding&>(rhs))
+  {}
+
+  Exploding& operator=(const Exploding& rhs) = default;
+  Exploding& operator=(Exploding&& rhs) noexcept = default;
+
+  bool explodes;
+};
+
+//! Expected state of an actor.
+struct ActorModel
+{
+  uint32_t id;
+  bool position;
+  bool velocity;
+  bool tracked;
+};
+
+//! Reports the failed check.
+bool check(const bool condition, const char* message)
+{
+  if (!condition)
+    std::printf("check failed: %s\n", message);
+  return condition;
+}
+
+//! @returns Name held by the tracked component of the actor.
+std::string nameOf(const uint32_t id)
+{
+  // Long enough to allocate, so a relocation which does not move the string is caught.
+  return "tracked actor with a long name " + std::to_string(id);
+}
+
+//! Compares the world with the model.
+bool matchesModel(World& world, const std::unordered_map<ActorHandle, ActorModel>& model)
+{
+  bool passed = true;
+  passed &= check(world.size() == model.size(), "world holds every live actor");
+
+  size_t positionCount = 0;
+  size_t movingCount = 0;
+  size_t trackedCount = 0;
+  bool componentsMatch = true;
+  for (const auto& [actor, expected]: model)
+  {
+    positionCount += expected.position;
+    movingCount += expected.position && expected.velocity;
+    trackedCount += expected.tracked;
+
+    const auto* identity = world.getComponent<Identity>(actor);
+    const auto* position = world.getComponent<Position>(actor);
+    const auto* velocity = world.getComponent<Velocity>(actor);
+    const auto* tracked = world.getComponent<Tracked>(actor);
+    componentsMatch &= world.contains(actor) && identity != nullptr && identity->id == expected.id;
+    componentsMatch &= (position != nullptr) == expected.position;
+    componentsMatch &= position == nullptr || position->x == static_cast<float>(expected.id);
+    componentsMatch &= (velocity != nullptr) == expected.velocity;
+    componentsMatch &= velocity == nullptr || velocity->x == -static_cast<float>(expected.id);
+    componentsMatch &= (tracked != nullptr) == expected.tracked;
+    componentsMatch &= tracked == nullptr || tracked->value == nameOf(expected.id);
+  }
+  passed &= check(componentsMatch, "actors keep their components across archetype moves");
+  passed &= check(world.query<Identity>().size() == model.size(), "query matches every actor");
+  passed &= check(world.query<Position>().size() == positionCount, "query matches actors with the component");
+  passed &= check(
+    world.query<const Position, const Velocity>().size() == movingCount,
+    "query matches actors with all of the components");
+  passed &= check(world.query<Tracked>().size() == trackedCount, "query matches actors with tracked component");
+  passed &= check(Tracked::liveCount == static_cast<int64_t>(trackedCount), "no tracked component leaks");
+
+  // Rows of the actors of a chunk hold the components of the actors.
+  bool rowsMatch = true;
+  world.query<const Identity, const Position>().forEachChunk(
+    [&](std::span<const ActorHandle> actors, std::span<const Identity> identities, std::span<const Position> positions) {
+      for (size_t row = 0; row < actors.size(); ++row)
+      {
+        const auto iterator = model.find(actors[row]);
+        rowsMatch &= iterator != model.end() && iterator->second.id == identities[row].id;
+        rowsMatch &= positions[row].x == static_cast<float>(identities[row].id);
+      }
+    });
+  passed &= check(rowsMatch, "rows of the chunks belong to their actors");
+  return passed;
+}
+
+//! Creates, destroys and modifies actors at random and compares the world with the model.
+bool randomEdits()
+{
+  World world;
+  std::unordered_map<ActorHandle, ActorModel> model;
+  std::vector<ActorHandle> live;
+  std::vector<ActorHandle> stale;
+  std::mt19937 random(5);
+
+  // Queries created before the archetypes they match are updated when the archetypes are created.
+  const auto earlyQuery = world.query<const Position, const Velocity>();
+  const auto earlyTrackedQuery = world.query<Tracked>();
+
+  bool passed = true;
+  uint32_t nextId = 0;
+  for (size_t round = 0; round < 50'000; ++round)
+  {
+    const uint32_t operation = random() % 8;
+    if (live.empty() || operation < 3)
+    {
+      const uint32_t id = nextId++;
+      const ActorHandle actor = random() % 2 == 0
+        ? world.createActor(Identity{id})
+        : world.createActor(Identity{id}, Position{static_cast<float>(id)});
+      model.emplace(actor, ActorModel{id, world.getComponent<Position>(actor) != nullptr, false, false});
+      live.push_back(actor);
+      continue;
+    }
+
+    const size_t index = random() % live.size();
+    const ActorHandle actor = live[index];
+    auto& expected = model.at(actor);
+    switch (operation)
+    {
+      case 3:
+        passed &= check(world.destroyActor(actor), "live actor is destroyed");
+        model.erase(actor);
+        live[index] = live.back();
+        live.pop_back();
+        stale.push_back(actor);
+        break;
+      case 4:
+        world.addComponent<Position>(actor, static_cast<float>(expected.id));
+        expected.position = true;
+        break;
+      case 5:
+        world.addComponent<Velocity>(actor, -static_cast<float>(expected.id));
+        expected.velocity = true;
+        break;
+      case 6:
+        world.addComponent<Tracked>(actor, nameOf(expected.id));
+        expected.tracked = true;
+        break;
+      default:
+        switch (random() % 3)
+        {
+          case 0:
+            passed &= check(world.removeComponent<Position>(actor) == expected.position, "position is removed");
+            expected.position = false;
+            break;
+          case 1:
+            passed &= check(world.removeComponent<Velocity>(actor) == expected.velocity, "velocity is removed");
+            expected.velocity = false;
+            break;
+          default:
+            passed &= check(world.removeComponent<Tracked>(actor) == expected.tracked, "tracked is removed");
+            expected.tracked = false;
+            break;
+        }
+        break;
+    }
+
+    if (round % 5'000 == 0)
+      passed &= matchesModel(world, model);
+  }
+  passed &= matchesModel(world, model);
+  passed &= check(
+    earlyQuery.size() == world.query<const Position, const Velocity>().size(),
+    "query created early matches the archetypes created later");
+  passed &= check(
+    earlyTrackedQuery.size() == world.query<Tracked>().size(),
+    "query created early matches actors with the component added later");
+
+  // Slots of the stale handles were reused by later actors, the handles stay stale.
+  bool staleRejected = true;
+  for (const auto actor: stale)
+  {
+    staleRejected &= !world.contains(actor);
+    staleRejected &= world.getComponent<Identity>(actor) == nullptr;
+    staleRejected &= !world.destroyActor(actor);
+    try
+    {
+      world.addComponent<Velocity>(actor);
+      staleRejected = false;
+    } catch (const std::invalid_argument&)
+    {}
+    try
+    {
+      [[maybe_unused]] const bool removed = world.removeComponent<Position>(actor);
+      staleRejected = false;
+    } catch (const std::invalid_argument&)
+    {}
+  }
+  passed &= check(!stale.empty() && staleRejected, "stale handles are rejected");
+  passed &= matchesModel(world, model);
+  std::printf(
+    "random edits: %zu live actors, %zu stale handles, %zu archetypes\n",
+    model.size(), stale.size(), world.archetypeCount());
+  return passed;
+}
+
+//! Destroys a world holding components.
+bool destroyWorld()
+{
+  {
+    World world;
+    for (uint32_t id = 0; id < 1000; ++id)
+    {
+      const auto actor = world.createActor(Identity{id}, Tracked(nameOf(id)));
+      if (id % 3 == 0)
+        world.addComponent<Position>(actor);
+    }
+  }
+  return check(Tracked::liveCount == 0, "destroyed world destroys its components");
+}
+
+//! Leaves the world unchanged when a component constructor throws.
+bool throwingComponents()
+{
+  const auto throwsRuntime = [](auto&& call) {
+    try
+    {
+      call();
+    } catch (const std::runtime_error&)
+    {
+      return true;
+    }
+    return false;
+  };
+
+  World world;
+  std::unordered_map<ActorHandle, ActorModel> model;
+  for (uint32_t id = 0; id < 100; ++id)
+  {
+    const auto actor = world.createActor(Identity{id}, Position{static_cast<float>(id)}, Tracked(nameOf(id)));
+    model.emplace(actor, ActorModel{id, true, false, true});
+  }
+
+  bool passed = true;
+  for (uint32_t id = 100; id < 200; ++id)
+  {
+    // Components before the throwing one are constructed, those must be destroyed again.
+    passed &= check(
+      throwsRuntime([&]() {
+        [[maybe_unused]] const auto actor = world.createActor(
+          Identity{id}, Position{static_cast<float>(id)}, Tracked(nameOf(id)), Exploding(true));
+      }),
+      "throwing component constructor propagates from createActor");
+
+    const ActorHandle actor = std::next(model.begin(), id % model.size())->first;
+    passed &= check(
+      throwsRuntime([&]() {
+        world.addComponent<Exploding>(actor, Exploding(true));
+      }),
+      "throwing component constructor propagates from addComponent");
+    passed &= check(world.getComponent<Exploding>(actor) == nullptr, "actor does not get the throwing component");
+  }
+  passed &= check(world.query<Exploding>().size() == 0, "rows of the throwing component are rolled back");
+  passed &= matchesModel(world, model);
+
+  // Rolled back rows and handles are reused, swap-and-pop relocates only constructed components.
+  std::vector<ActorHandle> exploding;
+  for (uint32_t id = 200; id < 300; ++id)
+  {
+    const auto actor = world.createActor(Identity{id}, Position{static_cast<float>(id)}, Tracked(nameOf(id)));
+    world.addComponent<Exploding>(actor);
+    model.emplace(actor, ActorModel{id, true, false, true});
+    exploding.push_back(actor);
+  }
+  for (auto iterator = model.begin(); iterator != model.end();)
+  {
+    if (iterator->second.id % 2 == 0)
+    {
+      passed &= check(world.destroyActor(iterator->first), "actor is destroyed after a rollback");
+      iterator = model.erase(iterator);
+    } else
+    {
+      ++iterator;
+    }
+  }
+  passed &= matchesModel(world, model);
+  passed &= check(world.query<Exploding>().size() == exploding.size() / 2, "actors with the component remain");
+  return passed;
+}
+
+//! Rejects component types specified more than once.
+bool duplicateComponents()
+{
+  World world;
+  try
+  {
+    [[maybe_unused]] const auto actor = world.createActor(Identity{1}, Identity{2});
+  } catch (const std::invalid_argument&)
+  {
+    return check(world.size() == 0, "rejected actor is not created");
+  }
+  return check(false, "duplicate component type throws");
+}
+
+} // namespace
+
+int main()
+{
+  bool passed = true;
+  passed &= randomEdits();
+  passed &= check(Tracked::liveCount == 0, "destroyed world destroys its components");
+  passed &= destroyWorld();
+  passed &= duplicateComponents();
+  passed &= throwingComponents();
+  passed &= check(Tracked::liveCount == 0, "rolled back components are destroyed");
+
+  std::printf(passed ? "passed\n" : "failed\n");
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}